@@ -84,10 +84,42 @@ bool BatchDrawList::AddVisual(const Body &visual)
 // Draw all the items in this list.
 void BatchDrawList::Draw() const
 {
+	// Sprites that have been packed into the same texture atlas page can all be
+	// drawn with a single command. Where each frame is within its texture can
+	// only be looked up here, in the thread that owns the textures.
+	map<uint32_t, vector<float>> batches;
+	for(const pair<const Sprite * const, vector<float>> &it : data)
+	{
+		// Skip sprites whose texture has been unloaded to save memory and has
+		// not been loaded again yet.
+		uint32_t texture = it.first->Texture(isHighDPI);
+		if(!texture)
+			continue;
+
+		vector<float> &batch = batches[texture];
+		const vector<float> &in = it.second;
+		for(size_t i = 0; i + 30 <= in.size(); i += 30)
+		{
+			// The frame is the same for all six vertices of a sprite.
+			Sprite::Region first;
+			Sprite::Region second;
+			float fade = it.first->Locate(in[i + 4], isHighDPI, first, second);
+			for(size_t j = i; j < i + 30; j += 5)
+			{
+				float s = in[j + 2];
+				float t = in[j + 3];
+				batch.insert(batch.end(), {in[j], in[j + 1],
+					first.rect[0] + s * first.rect[2], first.rect[1] + t * first.rect[3], first.layer,
+					second.rect[0] + s * second.rect[2], second.rect[1] + t * second.rect[3], second.layer,
+					fade});
+			}
+		}
+	}
+
 	BatchShader::Bind();
 
-	for(const pair<const Sprite * const, vector<float>> &it : data)
-		BatchShader::Add(it.first, isHighDPI, it.second);
+	for(const pair<const uint32_t, vector<float>> &it : batches)
+		BatchShader::Add(it.first, it.second);
 
 	BatchShader::Unbind();
 }
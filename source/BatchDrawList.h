@@ -27,7 +27,8 @@ class Sprite;
 
 
 // This class collects a set of OpenGL draw commands to issue and groups them by
-// sprite, so all instances of each sprite can be drawn with a single command.
+// texture, so all instances of each sprite, and of any other sprites that share
+// its texture atlas page, can be drawn with a single command.
 class BatchDrawList {
 public:
 	// Clear the list, also setting the global time step for animation.
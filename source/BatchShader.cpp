@@ -17,7 +17,6 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "Screen.h"
 #include "Shader.h"
-#include "Sprite.h"
 
 using namespace std;
 
@@ -25,10 +24,11 @@ namespace {
 	Shader shader;
 	// Uniforms:
 	GLint scaleI;
-	GLint frameCountI;
 	// Vertex data:
 	GLint vertI;
-	GLint texCoordI;
+	GLint firstI;
+	GLint secondI;
+	GLint fadeI;
 
 	GLuint vao;
 	GLuint vbo;
@@ -43,13 +43,19 @@ void BatchShader::Init()
 		"// vertex batch shader\n"
 		"uniform vec2 scale;\n"
 		"in vec2 vert;\n"
-		"in vec3 texCoord;\n"
+		"in vec3 first;\n"
+		"in vec3 second;\n"
+		"in float fade;\n"
 
-		"out vec3 fragTexCoord;\n"
+		"out vec3 fragFirst;\n"
+		"out vec3 fragSecond;\n"
+		"out float fragFade;\n"
 
 		"void main() {\n"
 		"  gl_Position = vec4(vert * scale, 0, 1);\n"
-		"  fragTexCoord = texCoord;\n"
+		"  fragFirst = first;\n"
+		"  fragSecond = second;\n"
+		"  fragFade = fade;\n"
 		"}\n";
 
 	static const char *fragmentCode =
@@ -59,28 +65,28 @@ void BatchShader::Init()
 		"precision mediump sampler2DArray;\n"
 #endif
 		"uniform sampler2DArray tex;\n"
-		"uniform float frameCount;\n"
 
-		"in vec3 fragTexCoord;\n"
+		// Coordinates within an atlas page need more precision than mediump.
+		"in highp vec3 fragFirst;\n"
+		"in highp vec3 fragSecond;\n"
+		"in float fragFade;\n"
 
 		"out vec4 finalColor;\n"
 
 		"void main() {\n"
-		"  float first = floor(fragTexCoord.z);\n"
-		"  float second = mod(ceil(fragTexCoord.z), frameCount);\n"
-		"  float fade = fragTexCoord.z - first;\n"
 		"  finalColor = mix(\n"
-		"    texture(tex, vec3(fragTexCoord.xy, first)),\n"
-		"    texture(tex, vec3(fragTexCoord.xy, second)), fade);\n"
+		"    texture(tex, fragFirst),\n"
+		"    texture(tex, fragSecond), fragFade);\n"
 		"}\n";
 
 	// Compile the shaders.
 	shader = Shader(vertexCode, fragmentCode);
 	// Get the indices of the uniforms and attributes.
 	scaleI = shader.Uniform("scale");
-	frameCountI = shader.Uniform("frameCount");
 	vertI = shader.Attrib("vert");
-	texCoordI = shader.Attrib("texCoord");
+	firstI = shader.Attrib("first");
+	secondI = shader.Attrib("second");
+	fadeI = shader.Attrib("fade");
 
 	// Make sure we're using texture 0.
 	glUseProgram(shader.Object());
@@ -94,14 +100,21 @@ void BatchShader::Init()
 	glGenBuffers(1, &vbo);
 	glBindBuffer(GL_ARRAY_BUFFER, vbo);
 
-	// In this VAO, enable the two vertex arrays and specify their byte offsets.
-	constexpr auto stride = 5 * sizeof(float);
+	// In this VAO, enable the four vertex arrays and specify their byte offsets.
+	constexpr auto stride = 9 * sizeof(float);
 	glEnableVertexAttribArray(vertI);
 	glVertexAttribPointer(vertI, 2, GL_FLOAT, GL_FALSE, stride, nullptr);
-	// The 3 texture fields (s, t, frame) come after the x,y pixel fields.
-	auto textureOffset = reinterpret_cast<const GLvoid *>(2 * sizeof(float));
-	glEnableVertexAttribArray(texCoordI);
-	glVertexAttribPointer(texCoordI, 3, GL_FLOAT, GL_FALSE, stride, textureOffset);
+	// The x,y pixel fields are followed by the texture coordinates (s, t, layer)
+	// of the two frames that are blended together, and then the blend factor.
+	auto firstOffset = reinterpret_cast<const GLvoid *>(2 * sizeof(float));
+	glEnableVertexAttribArray(firstI);
+	glVertexAttribPointer(firstI, 3, GL_FLOAT, GL_FALSE, stride, firstOffset);
+	auto secondOffset = reinterpret_cast<const GLvoid *>(5 * sizeof(float));
+	glEnableVertexAttribArray(secondI);
+	glVertexAttribPointer(secondI, 3, GL_FLOAT, GL_FALSE, stride, secondOffset);
+	auto fadeOffset = reinterpret_cast<const GLvoid *>(8 * sizeof(float));
+	glEnableVertexAttribArray(fadeI);
+	glVertexAttribPointer(fadeI, 1, GL_FLOAT, GL_FALSE, stride, fadeOffset);
 
 	// Unbind the buffer and the VAO, but leave the vertex attrib arrays enabled
 	// in the VAO so they will be used when it is bound.
@@ -125,22 +138,20 @@ void BatchShader::Bind()
 
 
 
-void BatchShader::Add(const Sprite *sprite, bool isHighDPI, const vector<float> &data)
+void BatchShader::Add(uint32_t texture, const vector<float> &data)
 {
 	// Do nothing if there are no sprites to draw.
-	if(data.empty())
+	if(data.empty() || !texture)
 		return;
 
 	// First, bind the proper texture.
-	glBindTexture(GL_TEXTURE_2D_ARRAY, sprite->Texture(isHighDPI));
-	// The shader also needs to know how many frames the texture has.
-	glUniform1f(frameCountI, sprite->Frames());
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
 
 	// Upload the vertex data.
 	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * data.size(), data.data(), GL_STREAM_DRAW);
 
 	// Draw all the vertices.
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, data.size() / 5);
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, data.size() / 9);
 }
 
 
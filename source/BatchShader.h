@@ -16,21 +16,21 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #ifndef BATCH_SHADER_H_
 #define BATCH_SHADER_H_
 
-class Sprite;
-
+#include <cstdint>
 #include <vector>
 
 
 
 // Class for drawing sprites in a batch. The input to each draw command is a
-// sprite, whether it should be drawn high DPI, and the vertex data.
+// texture and the vertex data for every sprite that is drawn from it, which
+// may be several different sprites if they share a texture atlas page.
 class BatchShader {
 public:
 	// Initialize the shaders.
 	static void Init();
 
 	static void Bind();
-	static void Add(const Sprite *sprite, bool isHighDPI, const std::vector<float> &data);
+	static void Add(uint32_t texture, const std::vector<float> &data);
 	static void Unbind();
 };
 
@@ -151,64 +151,6 @@ namespace {
 		return false;
 	}
 
-	// Converts the given vector of condition tokens (like "reputation: Republic",
-	// "random", or "4") into the integral values they have at runtime.
-	vector<int64_t> SubstituteValues(const vector<string> &side, const ConditionsStore &conditions,
-		const ConditionsStore &created)
-	{
-		auto result = vector<int64_t>();
-		result.reserve(side.size());
-		for(const string &str : side)
-		{
-			int64_t value = 0;
-			if(str == "random")
-				value = Random::Int(100);
-			else if(DataNode::IsNumber(str))
-				value = static_cast<int64_t>(DataNode::Value(str));
-			else
-			{
-				const auto temp = created.HasGet(str);
-				if(temp.first)
-					value = temp.second;
-				else
-				{
-					const auto perm = conditions.HasGet(str);
-					if(perm.first)
-						value = perm.second;
-				}
-			}
-			result.emplace_back(value);
-		}
-		return result;
-	}
-
-	bool UsedAll(const vector<bool> &status)
-	{
-		for(auto v : status)
-			if(!v)
-				return false;
-		return true;
-	}
-
-	// Finding the left operand's index if getLeft = true. The operand's index is the first non-empty, non-used index.
-	size_t FindOperandIndex(const vector<string> &tokens, const vector<int> &resultIndices,
-		const size_t &opIndex, bool getLeft)
-	{
-		// Start at the operator index (left), or just past it (right).
-		size_t index = opIndex + !getLeft;
-		if(getLeft)
-			while(tokens.at(index).empty() && index > 0)
-				--index;
-		else
-			while(tokens.at(index).empty() && index < tokens.size() - 2)
-				++index;
-		// Trace any used data to find the latest result.
-		while(resultIndices.at(index) > 0)
-			index = resultIndices.at(index);
-
-		return index;
-	}
-
 	void PrintConditionError(const vector<string> &side)
 	{
 		string message = "Error decomposing complex condition expression:\nFound:\t";
@@ -296,11 +238,15 @@ void ConditionSet::Add(const DataNode &node)
 			node.PrintTrace(UNRECOGNIZED);
 	}
 	else if(node.Size() == 1 && node.Token(0) == "never")
+	{
 		expressions.emplace_back("'", "!=", "0");
+		AddInputs(expressions.back().Inputs(), false);
+	}
 	else if(node.Size() == 1 && (node.Token(0) == "and" || node.Token(0) == "or"))
 	{
 		// The "and" and "or" keywords introduce a nested condition set.
 		children.emplace_back(node);
+		AddInputs(children.back().inputs, children.back().isRandom);
 		// If a child node has assignment operators, warn on load since
 		// these will be processed after all non-child expressions.
 		if(children.back().hasAssign)
@@ -380,6 +326,7 @@ bool ConditionSet::Add(const string &firstToken, const string &secondToken)
 		return false;
 
 	hasAssign |= !expressions.back().IsTestable();
+	AddInputs(expressions.back().Inputs(), expressions.back().IsRandom());
 	return true;
 }
 
@@ -395,6 +342,7 @@ bool ConditionSet::Add(const string &name, const string &op, const string &value
 
 	hasAssign |= !IsComparison(op);
 	expressions.emplace_back(name, op, value);
+	AddInputs(expressions.back().Inputs(), expressions.back().IsRandom());
 	return true;
 }
 
@@ -409,6 +357,7 @@ bool ConditionSet::Add(const vector<string> &lhs, const string &op, const vector
 
 	hasAssign |= !IsComparison(op);
 	expressions.emplace_back(lhs, op, rhs);
+	AddInputs(expressions.back().Inputs(), expressions.back().IsRandom());
 	return true;
 }
 
@@ -418,13 +367,35 @@ bool ConditionSet::Add(const vector<string> &lhs, const string &op, const vector
 // on a temporary condition map, if this set mixes comparisons and modifications.
 bool ConditionSet::Test(const ConditionsStore &conditions) const
 {
+	// If this set was tested against the same store before, and none of the
+	// conditions it depends on have changed since, the result is the same.
+	uint64_t storeId = 0;
+	uint64_t stamp = 0;
+	bool result = false;
+	bool isDerived = false;
+	bool isSameStore = !isRandom && cache.Load(storeId, stamp, result, isDerived)
+		&& storeId == conditions.Id();
+	if(isSameStore && !isDerived && !ChangedSince(stamp))
+		return result;
+
+	stamp = ConditionsStore::CurrentStamp();
 	// If this ConditionSet contains any expressions with operators that
 	// modify the condition map, then they must be applied before testing,
 	// to generate any temporary conditions needed.
-	ConditionsStore created;
+	TemporaryConditions created;
 	if(hasAssign)
 		TestApply(conditions, created);
-	return TestSet(conditions, created);
+	result = TestSet(conditions, created);
+
+	// Derived conditions can change without the store knowing, so a set that
+	// reads any of them has to be evaluated every time. Which conditions are
+	// derived only changes when the store's ID does.
+	if(!isRandom && !isSameStore)
+		isDerived = any_of(inputs.begin(), inputs.end(),
+			[&conditions](const ConditionsStore::Key &key) { return conditions.IsDerived(key); });
+	if(!isRandom && !(isSameStore && isDerived))
+		cache.Save(conditions.Id(), stamp, result, isDerived);
+	return result;
 }
 
 
@@ -432,10 +403,9 @@ bool ConditionSet::Test(const ConditionsStore &conditions) const
 // Modify the given set of conditions.
 void ConditionSet::Apply(ConditionsStore &conditions) const
 {
-	ConditionsStore unused;
 	for(const Expression &expression : expressions)
 		if(!expression.IsTestable())
-			expression.Apply(conditions, unused);
+			expression.Apply(conditions);
 
 	for(const ConditionSet &child : children)
 		child.Apply(conditions);
@@ -460,8 +430,30 @@ set<string> ConditionSet::RelevantConditions() const
 
 
 
+// Add the given conditions to the ones this set depends on.
+void ConditionSet::AddInputs(const vector<ConditionsStore::Key> &keys, bool isRandom)
+{
+	this->isRandom |= isRandom;
+	for(const ConditionsStore::Key &key : keys)
+		if(none_of(inputs.begin(), inputs.end(),
+				[&key](const ConditionsStore::Key &input) { return &input.Name() == &key.Name(); }))
+			inputs.push_back(key);
+}
+
+
+
+bool ConditionSet::ChangedSince(uint64_t stamp) const
+{
+	for(const ConditionsStore::Key &key : inputs)
+		if(key.LastChanged() > stamp)
+			return true;
+	return false;
+}
+
+
+
 // Check if this set is satisfied by either the created, temporary conditions, or the given conditions.
-bool ConditionSet::TestSet(const ConditionsStore &conditions, const ConditionsStore &created) const
+bool ConditionSet::TestSet(const ConditionsStore &conditions, const TemporaryConditions &created) const
 {
 	// Not all expressions may be testable: some may have been used to form the "created" condition map.
 	for(const Expression &expression : expressions)
@@ -489,7 +481,7 @@ bool ConditionSet::TestSet(const ConditionsStore &conditions, const ConditionsSt
 
 // Construct new, temporary conditions based on the assignment expressions in
 // this ConditionSet and the values in the player's conditions map.
-void ConditionSet::TestApply(const ConditionsStore &conditions, ConditionsStore &created) const
+void ConditionSet::TestApply(const ConditionsStore &conditions, TemporaryConditions &created) const
 {
 	for(const Expression &expression : expressions)
 		if(!expression.IsTestable())
@@ -501,9 +493,57 @@ void ConditionSet::TestApply(const ConditionsStore &conditions, ConditionsStore
 
 
 
+ConditionSet::ResultCache::ResultCache(const ResultCache &other)
+{
+}
+
+
+
+ConditionSet::ResultCache &ConditionSet::ResultCache::operator=(const ResultCache &other)
+{
+	return *this;
+}
+
+
+
+bool ConditionSet::ResultCache::Load(uint64_t &storeId, uint64_t &stamp, bool &result, bool &isDerived) const
+{
+	uint32_t before = sequence.load(memory_order_acquire);
+	if(before & 1)
+		return false;
+
+	storeId = this->storeId.load(memory_order_relaxed);
+	stamp = this->stamp.load(memory_order_relaxed);
+	uint32_t bits = flags.load(memory_order_relaxed);
+	atomic_thread_fence(memory_order_acquire);
+	if(sequence.load(memory_order_relaxed) != before)
+		return false;
+
+	result = bits & 1;
+	isDerived = bits & 2;
+	return true;
+}
+
+
+
+void ConditionSet::ResultCache::Save(uint64_t storeId, uint64_t stamp, bool result, bool isDerived)
+{
+	uint32_t before = sequence.load(memory_order_relaxed);
+	if((before & 1) || !sequence.compare_exchange_strong(before, before + 1, memory_order_relaxed))
+		return;
+	atomic_thread_fence(memory_order_release);
+
+	this->storeId.store(storeId, memory_order_relaxed);
+	this->stamp.store(stamp, memory_order_relaxed);
+	flags.store(result | (isDerived << 1), memory_order_relaxed);
+	sequence.store(before + 2, memory_order_release);
+}
+
+
+
 // Constructor for complex expressions.
 ConditionSet::Expression::Expression(const vector<string> &left, const string &op, const vector<string> &right)
-	: op(op), fun(Op(op)), left(left), right(right)
+	: op(op), fun(Op(op)), left(left), right(right), name(this->left.ToString())
 {
 }
 
@@ -511,7 +551,7 @@ ConditionSet::Expression::Expression(const vector<string> &left, const string &o
 
 // Constructor for simple expressions.
 ConditionSet::Expression::Expression(const string &left, const string &op, const string &right)
-	: op(op), fun(Op(op)), left(left), right(right)
+	: op(op), fun(Op(op)), left(left), right(right), name(this->left.ToString())
 {
 }
 
@@ -547,9 +587,9 @@ bool ConditionSet::Expression::IsEmpty() const
 
 // Returns everything to the left of the main assignment or comparison operator.
 // In an assignment expression, this should be only a single token.
-string ConditionSet::Expression::Name() const
+const string &ConditionSet::Expression::Name() const
 {
-	return left.ToString();
+	return name.Name();
 }
 
 
@@ -562,8 +602,25 @@ bool ConditionSet::Expression::IsTestable() const
 
 
 
+vector<ConditionsStore::Key> ConditionSet::Expression::Inputs() const
+{
+	vector<ConditionsStore::Key> result = left.Names();
+	result.insert(result.end(), right.Names().begin(), right.Names().end());
+	result.push_back(name);
+	return result;
+}
+
+
+
+bool ConditionSet::Expression::IsRandom() const
+{
+	return left.IsRandom() || right.IsRandom();
+}
+
+
+
 // Evaluate both the left- and right-hand sides of the expression, then compare the evaluated numeric values.
-bool ConditionSet::Expression::Test(const ConditionsStore &conditions, const ConditionsStore &created) const
+bool ConditionSet::Expression::Test(const ConditionsStore &conditions, const TemporaryConditions &created) const
 {
 	int64_t lhs = left.Evaluate(conditions, created);
 	int64_t rhs = right.Evaluate(conditions, created);
@@ -573,21 +630,28 @@ bool ConditionSet::Expression::Test(const ConditionsStore &conditions, const Con
 
 
 // Assign the computed value to the desired condition.
-void ConditionSet::Expression::Apply(ConditionsStore &conditions, ConditionsStore &created) const
+void ConditionSet::Expression::Apply(ConditionsStore &conditions) const
 {
-	auto &c = conditions[Name()];
-	int64_t value = right.Evaluate(conditions, created);
+	auto &c = conditions[name];
+	int64_t value = right.Evaluate(conditions, TemporaryConditions());
 	c = fun(c, value);
 }
 
 
 
-// Assign the computed value to the desired temporary condition.
-void ConditionSet::Expression::TestApply(const ConditionsStore &conditions, ConditionsStore &created) const
+// Assign the computed value to the desired temporary condition. A temporary
+// condition always starts out at zero, even if the player has a condition
+// with the same name.
+void ConditionSet::Expression::TestApply(const ConditionsStore &conditions, TemporaryConditions &created) const
 {
-	auto &c = created[Name()];
+	const string *interned = &name.Name();
+	auto it = find_if(created.begin(), created.end(),
+		[interned](const pair<const string *, int64_t> &entry) { return entry.first == interned; });
+	size_t index = it - created.begin();
+	if(it == created.end())
+		created.emplace_back(interned, 0);
 	int64_t value = right.Evaluate(conditions, created);
-	c = fun(c, value);
+	created[index].second = fun(created[index].second, value);
 }
 
 
@@ -599,7 +663,21 @@ ConditionSet::Expression::SubExpression::SubExpression(const vector<string> &sid
 		return;
 
 	ParseSide(side);
-	GenerateSequence();
+	// A side with several tokens but no operators (e.g. "has" "name" >= 9) has
+	// always evaluated to its last token.
+	if(!tokens.empty() && operators.empty())
+	{
+		AddOperand(tokens.back());
+		maxDepth = 1;
+	}
+	else if(!tokens.empty() && !Compile(side))
+	{
+		PrintConditionError(side);
+		tokens.clear();
+		operators.clear();
+		program.clear();
+		names.clear();
+	}
 }
 
 
@@ -609,9 +687,12 @@ ConditionSet::Expression::SubExpression::SubExpression(const vector<string> &sid
 ConditionSet::Expression::SubExpression::SubExpression(const string &side)
 {
 	tokens.emplace_back(side.empty() ? "'" : side);
+	AddOperand(tokens.back());
+	maxDepth = 1;
 }
 
 
+
 // Convert the tokens and operators back to a string, for use in logging.
 const string ConditionSet::Expression::SubExpression::ToString() const
 {
@@ -668,27 +749,55 @@ bool ConditionSet::Expression::SubExpression::IsEmpty() const
 
 
 
+const vector<ConditionsStore::Key> &ConditionSet::Expression::SubExpression::Names() const
+{
+	return names;
+}
+
+
+
+bool ConditionSet::Expression::SubExpression::IsRandom() const
+{
+	return any_of(program.begin(), program.end(),
+		[](const Instruction &instruction) { return instruction.type == Instruction::Type::RANDOM; });
+}
+
+
+
 // Evaluate the SubExpression using the given condition maps.
 int64_t ConditionSet::Expression::SubExpression::Evaluate(const ConditionsStore &conditions,
-	const ConditionsStore &created) const
+	const TemporaryConditions &created) const
 {
 	// Sanity check.
-	if(tokens.empty())
+	if(program.empty())
 		return 0;
-
-	// For SubExpressions with no Operations (i.e. simple conditions), tokens will consist
-	// of only the condition or numeric value to be returned as-is after substitution.
-	auto data = SubstituteValues(tokens, conditions, created);
-
-	if(!sequence.empty())
+	// Most sides are a single condition or number, with no operators.
+	if(program.size() == 1)
+		return Value(program.front(), conditions, created);
+
+	// Only unusually long expressions need more stack than this.
+	static const size_t FIXED_DEPTH = 16;
+	int64_t fixed[FIXED_DEPTH];
+	vector<int64_t> large;
+	int64_t *stack = fixed;
+	if(maxDepth > FIXED_DEPTH)
 	{
-		// Each Operation adds to the end of the data vector.
-		data.reserve(operatorCount + data.size());
-		for(const Operation &op : sequence)
-			data.emplace_back(op.fun(data[op.a], data[op.b]));
+		large.resize(maxDepth);
+		stack = large.data();
 	}
 
-	return data.back();
+	size_t size = 0;
+	for(const Instruction &instruction : program)
+	{
+		if(instruction.type == Instruction::Type::OPERATOR)
+		{
+			--size;
+			stack[size - 1] = instruction.fun(stack[size - 1], stack[size]);
+		}
+		else
+			stack[size++] = Value(instruction, conditions, created);
+	}
+	return stack[0];
 }
 
 
@@ -699,6 +808,8 @@ void ConditionSet::Expression::SubExpression::ParseSide(const vector<string> &si
 {
 	static const string EMPTY;
 	int parentheses = 0;
+	// The number of true (non-parentheses) operators.
+	int operatorCount = 0;
 	// Construct the tokens and operators vectors.
 	for(size_t i = 0; i < side.size(); ++i)
 	{
@@ -737,115 +848,106 @@ void ConditionSet::Expression::SubExpression::ParseSide(const vector<string> &si
 
 
 
-// Parse the token and operators vectors to make the sequence vector.
-void ConditionSet::Expression::SubExpression::GenerateSequence()
+// Convert the side into a postfix program using the shunting-yard algorithm. Operands
+// end up in the program in the same order as in the side, so any random values are
+// drawn in the order they are written.
+bool ConditionSet::Expression::SubExpression::Compile(const vector<string> &side)
 {
-	// Simple conditions have only a single token and no operators.
-	if(tokens.empty() || operators.empty())
-		return;
-	// Use a boolean vector to indicate when an operator has been used.
-	auto usedOps = vector<bool>(operators.size(), false);
-	// Read the operators vector just once by using a stack.
-	auto opStack = vector<size_t>();
-	// Store the data index for each Operation, for use by later Operations.
-	size_t destinationIndex = tokens.size();
-	auto dataDest = vector<int>(destinationIndex + operatorCount, -1);
-	size_t opIndex = 0;
-	while(!UsedAll(usedOps))
+	// Operators (and open parentheses) that are waiting for their right operand.
+	vector<const string *> waiting;
+	size_t depth = 0;
+	bool expectOperand = true;
+	auto emit = [this, &waiting, &depth]() -> bool
 	{
-		while(true)
-		{
-			// Stack ops until one of lower or equal precedence is found, then evaluate the higher one first.
-			if(opStack.empty() || operators.at(opIndex) == "("
-					|| (Precedence(operators.at(opIndex)) > Precedence(operators.at(opStack.back()))))
-			{
-				opStack.push_back(opIndex);
-				// Mark this operator as used and advance.
-				usedOps.at(opIndex++) = true;
-				break;
-			}
-
-			size_t workingIndex = opStack.back();
-			opStack.pop_back();
+		if(depth < 2)
+			return false;
+		program.push_back(Instruction{Instruction::Type::OPERATOR, 0, Op(*waiting.back())});
+		waiting.pop_back();
+		--depth;
+		return true;
+	};
 
-			// A left parentheses results in a no-op step.
-			if(operators.at(workingIndex) == "(")
-			{
-				if(operators.at(opIndex) != ")")
-				{
-					Logger::LogError("Did not find matched parentheses:");
-					PrintConditionError(ToStrings());
-					tokens.clear();
-					operators.clear();
-					sequence.clear();
-					return;
-				}
-				// "Use" the parentheses and advance operators.
-				usedOps.at(opIndex++) = true;
-				break;
-			}
-			else if(!AddOperation(dataDest, destinationIndex, workingIndex))
-				return;
-		}
-	}
-	// Handle remaining operators (which cannot be parentheses).
-	while(!opStack.empty())
+	for(const string &token : side)
 	{
-		size_t workingIndex = opStack.back();
-		opStack.pop_back();
-
-		if(operators.at(workingIndex) == "(" || operators.at(workingIndex) == ")")
+		if(token == "(")
 		{
-			Logger::LogError("Mismatched parentheses:" + ToString());
-			tokens.clear();
-			operators.clear();
-			sequence.clear();
-			return;
+			if(!expectOperand)
+				return false;
+			waiting.push_back(&token);
+		}
+		else if(token == ")")
+		{
+			if(expectOperand)
+				return false;
+			while(!waiting.empty() && *waiting.back() != "(")
+				if(!emit())
+					return false;
+			if(waiting.empty())
+				return false;
+			waiting.pop_back();
+		}
+		else if(IsSimple(token))
+		{
+			if(expectOperand)
+				return false;
+			// Operators of equal precedence are evaluated left to right.
+			while(!waiting.empty() && *waiting.back() != "("
+					&& Precedence(*waiting.back()) >= Precedence(token))
+				if(!emit())
+					return false;
+			waiting.push_back(&token);
+			expectOperand = true;
+		}
+		else
+		{
+			if(!expectOperand)
+				return false;
+			AddOperand(token);
+			maxDepth = max(maxDepth, ++depth);
+			expectOperand = false;
 		}
-		else if(!AddOperation(dataDest, destinationIndex, workingIndex))
-			return;
 	}
-	// All operators and tokens should now have been used.
+	if(expectOperand)
+		return false;
+	while(!waiting.empty())
+		if(*waiting.back() == "(" || !emit())
+			return false;
+
+	return depth == 1;
 }
 
 
 
-// Use a valid working index and data pointer vector to create an evaluable Operation.
-bool ConditionSet::Expression::SubExpression::AddOperation(vector<int> &data, size_t &index, const size_t &opIndex)
+// Add an instruction that pushes the value of the given token onto the stack.
+void ConditionSet::Expression::SubExpression::AddOperand(const string &token)
 {
-	// Obtain the operand indices. The operator is never a parentheses. The
-	// operator index never exceeds the size of the tokens vector.
-	size_t leftIndex = FindOperandIndex(tokens, data, opIndex, true);
-	size_t rightIndex = FindOperandIndex(tokens, data, opIndex, false);
-
-	// Bail out if the pointed token is in-bounds and empty.
-	if((leftIndex < tokens.size() && tokens.at(leftIndex).empty())
-			|| (rightIndex < tokens.size() && tokens.at(rightIndex).empty()))
+	if(token == "random")
+		program.push_back(Instruction{Instruction::Type::RANDOM, 0, nullptr});
+	else if(DataNode::IsNumber(token))
+		program.push_back(Instruction{Instruction::Type::NUMBER,
+			static_cast<int64_t>(DataNode::Value(token)), nullptr});
+	else
 	{
-		Logger::LogError("Unable to obtain valid operand for function \"" + operators.at(opIndex) + "\" with tokens:");
-		PrintConditionError(tokens);
-		tokens.clear();
-		operators.clear();
-		sequence.clear();
-		return false;
+		program.push_back(Instruction{Instruction::Type::CONDITION, static_cast<int64_t>(names.size()), nullptr});
+		names.emplace_back(token);
 	}
-
-	// Record use of an operand by writing where its latest value is found.
-	data.at(leftIndex) = index;
-	data.at(rightIndex) = index;
-	// Create the Operation.
-	sequence.emplace_back(operators.at(opIndex), leftIndex, rightIndex);
-	// Update the pointed index for the next operation.
-	++index;
-
-	return true;
 }
 
 
 
-// Constructor for an Operation, indicating the binary function and the
-// indices of its operands within the evaluation-time data vector.
-ConditionSet::Expression::SubExpression::Operation::Operation(const string &op, size_t &a, size_t &b)
-	: fun(Op(op)), a(a), b(b)
+// Temporary conditions take precedence over the given ones. Conditions that
+// do not exist have a value of zero.
+int64_t ConditionSet::Expression::SubExpression::Value(const Instruction &instruction,
+	const ConditionsStore &conditions, const TemporaryConditions &created) const
 {
+	if(instruction.type == Instruction::Type::NUMBER)
+		return instruction.value;
+	if(instruction.type == Instruction::Type::RANDOM)
+		return Random::Int(100);
+
+	const ConditionsStore::Key &key = names[instruction.value];
+	for(const auto &entry : created)
+		if(entry.first == &key.Name())
+			return entry.second;
+	return conditions.HasGet(key).second;
 }
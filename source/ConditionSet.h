@@ -16,12 +16,16 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #ifndef CONDITION_SET_H_
 #define CONDITION_SET_H_
 
+#include "ConditionsStore.h"
+
+#include <atomic>
+#include <cstdint>
 #include <map>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
-class ConditionsStore;
 class DataNode;
 class DataWriter;
 
@@ -68,10 +72,20 @@ public:
 
 
 private:
+	// Temporary conditions created while testing a set that contains assignments.
+	// Each entry points to the interned name of the expression that created it.
+	// There are rarely more than a few, so a vector is faster than any kind of map.
+	using TemporaryConditions = std::vector<std::pair<const std::string *, int64_t>>;
+
 	// Compare this set's expressions and the union of created and supplied conditions.
-	bool TestSet(const ConditionsStore &conditions, const ConditionsStore &created) const;
+	bool TestSet(const ConditionsStore &conditions, const TemporaryConditions &created) const;
 	// Evaluate this set's assignment expressions and store the result in "created" (for use by TestSet).
-	void TestApply(const ConditionsStore &conditions, ConditionsStore &created) const;
+	void TestApply(const ConditionsStore &conditions, TemporaryConditions &created) const;
+
+	// Remember which conditions the given expression or nested set depends on.
+	void AddInputs(const std::vector<ConditionsStore::Key> &keys, bool isRandom);
+	// Check if any of the conditions this set depends on changed after the given stamp.
+	bool ChangedSince(uint64_t stamp) const;
 
 
 private:
@@ -90,21 +104,25 @@ private:
 		bool IsEmpty() const;
 
 		// Returns the left side of this Expression.
-		std::string Name() const;
+		const std::string &Name() const;
 		// True if this Expression performs a comparison and false if it performs an assignment.
 		bool IsTestable() const;
+		// Get all the conditions this expression reads or modifies.
+		std::vector<ConditionsStore::Key> Inputs() const;
+		// Check if this expression uses random values.
+		bool IsRandom() const;
 
 		// Functions to use this expression:
-		bool Test(const ConditionsStore &conditions, const ConditionsStore &created) const;
-		void Apply(ConditionsStore &conditions, ConditionsStore &created) const;
-		void TestApply(const ConditionsStore &conditions, ConditionsStore &created) const;
+		bool Test(const ConditionsStore &conditions, const TemporaryConditions &created) const;
+		void Apply(ConditionsStore &conditions) const;
+		void TestApply(const ConditionsStore &conditions, TemporaryConditions &created) const;
 
 
 	private:
 		// A SubExpression results from applying operator-precedence parsing to one side of
 		// an Expression. The operators and tokens needed to recreate the given side are
-		// stored, and can be interleaved to restore the original string. Based on them, a
-		// sequence of "Operations" is created for runtime evaluation.
+		// stored, and can be interleaved to restore the original string. For evaluation,
+		// the side is compiled once into a postfix program that runs on a small stack.
 		class SubExpression {
 		public:
 			SubExpression(const std::vector<std::string> &side);
@@ -116,38 +134,48 @@ private:
 			const std::vector<std::string> ToStrings() const;
 
 			bool IsEmpty() const;
+			// Get the conditions this side reads.
+			const std::vector<ConditionsStore::Key> &Names() const;
+			bool IsRandom() const;
 
-			// Substitute numbers for any string values and then compute the result.
-			int64_t Evaluate(const ConditionsStore &conditions, const ConditionsStore &created) const;
+			// Run the compiled program, looking up any conditions in the given maps.
+			int64_t Evaluate(const ConditionsStore &conditions, const TemporaryConditions &created) const;
 
 
 		private:
 			void ParseSide(const std::vector<std::string> &side);
-			void GenerateSequence();
-			bool AddOperation(std::vector<int> &data, size_t &index, const size_t &opIndex);
+			// Convert the given side into a postfix program. Returns false if it is malformed.
+			bool Compile(const std::vector<std::string> &side);
+			void AddOperand(const std::string &token);
 
 
 		private:
-			// An Operation has a pointer to its binary function, and the data indices for
-			// its operands. The result is always placed on the back of the data vector.
-			class Operation {
+			// A single step of the program: either push a value onto the stack,
+			// or replace the top two values with the result of a binary function.
+			class Instruction {
 			public:
-				explicit Operation(const std::string &op, size_t &a, size_t &b);
+				enum class Type : uint8_t {NUMBER, RANDOM, CONDITION, OPERATOR};
 
+				Type type;
+				// The literal value, or the index of the condition's name.
+				int64_t value;
 				int64_t (*fun)(int64_t, int64_t);
-				size_t a;
-				size_t b;
 			};
 
+			// Get the value a number, "random", or condition instruction pushes onto the stack.
+			int64_t Value(const Instruction &instruction, const ConditionsStore &conditions,
+				const TemporaryConditions &created) const;
+
 
 		private:
-			// Iteration of the sequence vector yields the result.
-			std::vector<Operation> sequence;
-			// The tokens vector converts into a data vector of numeric values during evaluation.
+			// The tokens and operators are only kept to recreate the original string.
 			std::vector<std::string> tokens;
 			std::vector<std::string> operators;
-			// The number of true (non-parentheses) operators.
-			int operatorCount = 0;
+			// The compiled program, and the names of the conditions it reads.
+			std::vector<Instruction> program;
+			std::vector<ConditionsStore::Key> names;
+			// The largest number of values the program needs on the stack at once.
+			size_t maxDepth = 0;
 		};
 
 
@@ -161,6 +189,8 @@ private:
 		// SubExpressions contain one or more tokens and any number of simple operators.
 		SubExpression left;
 		SubExpression right;
+		// The left side as a string, i.e. the condition an assignment modifies.
+		ConditionsStore::Key name;
 	};
 
 
@@ -176,6 +206,39 @@ private:
 	std::vector<Expression> expressions;
 	// Nested sets of conditions to be tested.
 	std::vector<ConditionSet> children;
+
+	// The conditions that this set and its children depend on, and whether
+	// the result of testing it is random, in which case it is never cached.
+	std::vector<ConditionsStore::Key> inputs;
+	bool isRandom = false;
+
+
+private:
+	// The result of the last test of this set, the store it was tested against,
+	// and the stamp of the last change to any condition from before the test.
+	// Several threads may test the same set at once, so this is guarded like a
+	// sequence lock: a cache that is being written to counts as a miss, and if
+	// another thread is already writing it, the new result is simply not saved.
+	class ResultCache {
+	public:
+		ResultCache() = default;
+		// Copies of a set do not share the cached result.
+		ResultCache(const ResultCache &other);
+		ResultCache &operator=(const ResultCache &other);
+
+		// Get the cached result. Returns false if there is none, or it is being written.
+		bool Load(uint64_t &storeId, uint64_t &stamp, bool &result, bool &isDerived) const;
+		void Save(uint64_t storeId, uint64_t stamp, bool result, bool isDerived);
+
+	private:
+		std::atomic<uint32_t> sequence{0};
+		std::atomic<uint64_t> storeId{0};
+		std::atomic<uint64_t> stamp{0};
+		// Bit 0 is the result, bit 1 whether the set depends on derived conditions.
+		std::atomic<uint32_t> flags{0};
+	};
+
+	mutable ResultCache cache;
 };
 
 
@@ -19,10 +19,86 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "DataWriter.h"
 #include "Logger.h"
 
+#include <algorithm>
+#include <mutex>
+#include <tuple>
 #include <utility>
 
 using namespace std;
 
+namespace {
+	mutex internMutex;
+	atomic<uint64_t> lastStamp{0};
+}
+
+
+
+// Get the interned copy of the given name, adding it if necessary.
+const ConditionsStore::InternedName *ConditionsStore::Intern(const string &name)
+{
+	lock_guard<mutex> lock(internMutex);
+	auto it = InternedNames().emplace(piecewise_construct, forward_as_tuple(name), forward_as_tuple()).first;
+	it->second.name = &it->first;
+	return &it->second;
+}
+
+
+
+// Get the interned copy of the given name, without interning it.
+const ConditionsStore::InternedName *ConditionsStore::FindInterned(const string &name)
+{
+	lock_guard<mutex> lock(internMutex);
+	auto it = InternedNames().find(name);
+	return (it == InternedNames().end() ? nullptr : &it->second);
+}
+
+
+
+// Every condition name that has ever been interned. The nodes of an unordered
+// map never move, so pointers into it stay valid.
+unordered_map<string, ConditionsStore::InternedName> &ConditionsStore::InternedNames()
+{
+	static unordered_map<string, InternedName> names;
+	return names;
+}
+
+
+
+bool ConditionsStore::NameOrder::operator()(const InternedName *a, const InternedName *b) const
+{
+	return *a->name < *b->name;
+}
+
+
+
+ConditionsStore::Key::Key()
+{
+	// The empty name is only looked up once, so creating empty keys never locks.
+	static const InternedName *const EMPTY = Intern(string());
+	interned = EMPTY;
+}
+
+
+
+ConditionsStore::Key::Key(const string &name)
+	: interned(Intern(name))
+{
+}
+
+
+
+const string &ConditionsStore::Key::Name() const
+{
+	return *interned->name;
+}
+
+
+
+uint64_t ConditionsStore::Key::LastChanged() const
+{
+	return interned->changed.load();
+}
+
 
 
 // Default constructor
@@ -75,7 +151,10 @@ ConditionsStore::ConditionEntry::operator int64_t() const
 ConditionsStore::ConditionEntry &ConditionsStore::ConditionEntry::operator=(int64_t val)
 {
 	if(!provider)
+	{
 		value = val;
+		MarkChanged();
+	}
 	else
 	{
 		const string &key = fullKey.empty() ? provider->name : fullKey;
@@ -89,7 +168,10 @@ ConditionsStore::ConditionEntry &ConditionsStore::ConditionEntry::operator=(int6
 ConditionsStore::ConditionEntry &ConditionsStore::ConditionEntry::operator++()
 {
 	if(!provider)
+	{
 		++value;
+		MarkChanged();
+	}
 	else
 	{
 		const string &key = fullKey.empty() ? provider->name : fullKey;
@@ -103,7 +185,10 @@ ConditionsStore::ConditionEntry &ConditionsStore::ConditionEntry::operator++()
 ConditionsStore::ConditionEntry &ConditionsStore::ConditionEntry::operator--()
 {
 	if(!provider)
+	{
 		--value;
+		MarkChanged();
+	}
 	else
 	{
 		const string &key = fullKey.empty() ? provider->name : fullKey;
@@ -117,7 +202,10 @@ ConditionsStore::ConditionEntry &ConditionsStore::ConditionEntry::operator--()
 ConditionsStore::ConditionEntry &ConditionsStore::ConditionEntry::operator+=(int64_t val)
 {
 	if(!provider)
+	{
 		value += val;
+		MarkChanged();
+	}
 	else
 	{
 		const string &key = fullKey.empty() ? provider->name : fullKey;
@@ -131,7 +219,10 @@ ConditionsStore::ConditionEntry &ConditionsStore::ConditionEntry::operator+=(int
 ConditionsStore::ConditionEntry &ConditionsStore::ConditionEntry::operator-=(int64_t val)
 {
 	if(!provider)
+	{
 		value -= val;
+		MarkChanged();
+	}
 	else
 	{
 		const string &key = fullKey.empty() ? provider->name : fullKey;
@@ -142,8 +233,16 @@ ConditionsStore::ConditionEntry &ConditionsStore::ConditionEntry::operator-=(int
 
 
 
-ConditionsStore::PrimariesIterator::PrimariesIterator(CondMapItType it, CondMapItType endIt)
-	: condMapIt(it), condMapEnd(endIt)
+void ConditionsStore::ConditionEntry::MarkChanged()
+{
+	if(key)
+		key->changed.store(NextStamp());
+}
+
+
+
+ConditionsStore::PrimariesIterator::PrimariesIterator(const ConditionsStore &store, CondMapItType it)
+	: store(&store), condMapIt(it)
 {
 	MoveToValueCondition();
 }
@@ -202,13 +301,14 @@ bool ConditionsStore::PrimariesIterator::operator!=(const ConditionsStore::Prima
 // to a primary (value) condition or to the end-iterator value.
 void ConditionsStore::PrimariesIterator::MoveToValueCondition()
 {
-	while((condMapIt != condMapEnd) && (condMapIt->second).provider)
+	const auto condMapEnd = store->names.end();
+	while((condMapIt != condMapEnd) && store->storage.at(*condMapIt).provider)
 		condMapIt++;
 
 	// We have a valid value when we are not at the end, and callers should
 	// not try to dereference the value when we actually are at the end.
 	if(condMapIt != condMapEnd)
-		itVal = make_pair(condMapIt->first, (condMapIt->second).value);
+		itVal = make_pair(*(*condMapIt)->name, store->storage.at(*condMapIt).value);
 }
 
 
@@ -274,7 +374,7 @@ void ConditionsStore::Save(DataWriter &out) const
 // derived from other data-structures (derived conditions).
 int64_t ConditionsStore::Get(const string &name) const
 {
-	const ConditionEntry *ce = GetEntry(name);
+	const ConditionEntry *ce = GetEntry(FindInterned(name), name);
 	if(!ce)
 		return 0;
 
@@ -288,7 +388,7 @@ int64_t ConditionsStore::Get(const string &name) const
 
 bool ConditionsStore::Has(const string &name) const
 {
-	const ConditionEntry *ce = GetEntry(name);
+	const ConditionEntry *ce = GetEntry(FindInterned(name), name);
 	if(!ce)
 		return false;
 
@@ -304,7 +404,31 @@ bool ConditionsStore::Has(const string &name) const
 // and an int64_t which contains the value if the condition was set.
 pair<bool, int64_t> ConditionsStore::HasGet(const string &name) const
 {
-	const ConditionEntry *ce = GetEntry(name);
+	return HasGet(FindInterned(name), name);
+}
+
+
+
+// Same as above, but for a name that has already been interned, which
+// saves looking up the interned copy of the name.
+pair<bool, int64_t> ConditionsStore::HasGet(Key key) const
+{
+	return HasGet(key.interned, key.Name());
+}
+
+
+
+bool ConditionsStore::IsDerived(Key key) const
+{
+	const ConditionEntry *ce = GetEntry(key.interned, key.Name());
+	return ce && ce->provider;
+}
+
+
+
+pair<bool, int64_t> ConditionsStore::HasGet(const InternedName *key, const string &name) const
+{
+	const ConditionEntry *ce = GetEntry(key, name);
 	if(!ce)
 		return make_pair(false, 0);
 
@@ -336,15 +460,17 @@ bool ConditionsStore::Add(const string &name, int64_t value)
 // a set on the provider.
 bool ConditionsStore::Set(const string &name, int64_t value)
 {
-	ConditionEntry *ce = GetEntry(name);
+	const InternedName *key = FindInterned(name);
+	ConditionEntry *ce = GetEntry(key, name);
 	if(!ce)
 	{
-		(storage[name]).value = value;
+		AddEntry(key ? key : Intern(name)).value = value;
 		return true;
 	}
 	if(!ce->provider)
 	{
 		ce->value = value;
+		ce->MarkChanged();
 		return true;
 	}
 	return ce->provider->setFunction(name, value);
@@ -356,13 +482,17 @@ bool ConditionsStore::Set(const string &name, int64_t value)
 // an erase on the provider.
 bool ConditionsStore::Erase(const string &name)
 {
-	ConditionEntry *ce = GetEntry(name);
+	const InternedName *key = FindInterned(name);
+	ConditionEntry *ce = GetEntry(key, name);
 	if(!ce)
 		return true;
 
 	if(!(ce->provider))
 	{
-		storage.erase(name);
+		// A primary condition is always an exact match, so the key exists.
+		ce->MarkChanged();
+		storage.erase(key);
+		names.erase(key);
 		return true;
 	}
 	return ce->provider->eraseFunction(name);
@@ -371,21 +501,29 @@ bool ConditionsStore::Erase(const string &name)
 
 
 ConditionsStore::ConditionEntry &ConditionsStore::operator[](const string &name)
+{
+	return (*this)[Key(name)];
+}
+
+
+
+ConditionsStore::ConditionEntry &ConditionsStore::operator[](Key key)
 {
 	// Search for an exact match and return it if it exists.
-	auto it = storage.find(name);
+	auto it = storage.find(key.interned);
 	if(it != storage.end())
 		return it->second;
 
 	// Check for a prefix provider.
-	ConditionEntry *ceprov = GetEntry(name);
+	const string &name = key.Name();
+	ConditionEntry *ceprov = GetEntry(nullptr, name);
 	// If no prefix provider is found, then just create a new value entry.
 	if(ceprov == nullptr)
-		return storage[name];
+		return AddEntry(key.interned);
 
 	// Found a matching prefixed entry provider, but no exact match for the entry itself,
 	// let's create the exact match based on the prefix provider.
-	ConditionEntry &ce = storage[name];
+	ConditionEntry &ce = AddEntry(key.interned);
 	ce.provider = ceprov->provider;
 	ce.fullKey = name;
 	return ce;
@@ -395,21 +533,23 @@ ConditionsStore::ConditionEntry &ConditionsStore::operator[](const string &name)
 
 ConditionsStore::PrimariesIterator ConditionsStore::PrimariesBegin() const
 {
-	return PrimariesIterator(storage.begin(), storage.end());
+	return PrimariesIterator(*this, names.begin());
 }
 
 
 
 ConditionsStore::PrimariesIterator ConditionsStore::PrimariesEnd() const
 {
-	return PrimariesIterator(storage.end(), storage.end());
+	return PrimariesIterator(*this, names.end());
 }
 
 
 
 ConditionsStore::PrimariesIterator ConditionsStore::PrimariesLowerBound(const string &key) const
 {
-	return PrimariesIterator(storage.lower_bound(key), storage.end());
+	InternedName bound;
+	bound.name = &key;
+	return PrimariesIterator(*this, names.lower_bound(&bound));
 }
 
 
@@ -426,18 +566,22 @@ ConditionsStore::DerivedProvider &ConditionsStore::GetProviderPrefixed(const str
 		Logger::LogError("Error: Rewriting named provider \"" + prefix + "\" to prefixed provider.");
 		provider->isPrefixProvider = true;
 	}
+	// Any condition may now be derived that was not before.
+	id.value = NextStamp();
 	if(VerifyProviderLocation(prefix, provider))
 	{
-		storage[prefix].provider = provider;
+		const InternedName *key = Intern(prefix);
+		AddEntry(key).provider = provider;
+		AddPrefix(key);
 		// Check if any matching later entries within the prefixed range use the same provider.
-		auto checkIt = storage.find(prefix);
-		while(checkIt != storage.end() && (0 == checkIt->first.compare(0, prefix.length(), prefix)))
+		auto checkIt = names.find(key);
+		while(checkIt != names.end() && (0 == (*checkIt)->name->compare(0, prefix.length(), prefix)))
 		{
-			ConditionEntry &ce = checkIt->second;
+			ConditionEntry &ce = storage.at(*checkIt);
 			if(ce.provider != provider)
 			{
 				ce.provider = provider;
-				ce.fullKey = checkIt->first;
+				ce.fullKey = *(*checkIt)->name;
 				throw runtime_error("Replacing condition entries matching prefixed provider \""
 						+ prefix + "\".");
 			}
@@ -456,10 +600,11 @@ ConditionsStore::DerivedProvider &ConditionsStore::GetProviderNamed(const string
 		std::forward_as_tuple(name),
 		std::forward_as_tuple(name, false));
 	DerivedProvider *provider = &(it.first->second);
+	id.value = NextStamp();
 	if(provider->isPrefixProvider)
 		Logger::LogError("Error: Retrieving prefixed provider \"" + name + "\" as named provider.");
 	else if(VerifyProviderLocation(name, provider))
-		storage[name].provider = provider;
+		AddEntry(Intern(name)).provider = provider;
 	return *provider;
 }
 
@@ -469,38 +614,58 @@ ConditionsStore::DerivedProvider &ConditionsStore::GetProviderNamed(const string
 void ConditionsStore::Clear()
 {
 	storage.clear();
+	names.clear();
 	providers.clear();
+	prefixes.clear();
+	id.value = NextStamp();
+}
+
+
+
+uint64_t ConditionsStore::CurrentStamp()
+{
+	return lastStamp.load();
+}
+
+
+
+uint64_t ConditionsStore::Id() const
+{
+	return id.value;
 }
 
 
 
-ConditionsStore::ConditionEntry *ConditionsStore::GetEntry(const string &name)
+ConditionsStore::ConditionEntry *ConditionsStore::GetEntry(const InternedName *key, const string &name)
 {
 	// Avoid code-duplication between const and non-const function.
-	return const_cast<ConditionsStore::ConditionEntry *>(const_cast<const ConditionsStore *>(this)->GetEntry(name));
+	return const_cast<ConditionsStore::ConditionEntry *>(
+		const_cast<const ConditionsStore *>(this)->GetEntry(key, name));
 }
 
 
 
-const ConditionsStore::ConditionEntry *ConditionsStore::GetEntry(const string &name) const
+const ConditionsStore::ConditionEntry *ConditionsStore::GetEntry(const InternedName *key, const string &name) const
 {
 	if(storage.empty())
 		return nullptr;
 
-	// Perform a single search for values, named providers, and prefixed providers.
-	auto it = storage.upper_bound(name);
-	if(it == storage.begin())
-		return nullptr;
-
-	--it;
-	// The entry is matching if we have an exact string match.
-	if(!name.compare(it->first))
-		return &(it->second);
+	// The entry is matching if we have an exact match.
+	if(key)
+	{
+		auto it = storage.find(key);
+		if(it != storage.end())
+			return &(it->second);
+	}
 
-	// The entry is also matching when we have a prefix entry and the prefix part in the provider matches.
-	DerivedProvider *provider = it->second.provider;
-	if(provider && provider->isPrefixProvider && !name.compare(0, provider->name.length(), provider->name))
-		return &(it->second);
+	// The entry is also matching when the name starts with the prefix of a prefixed provider.
+	const InternedName *prefix = FindPrefix(name);
+	if(prefix)
+	{
+		auto it = storage.find(prefix);
+		if(it != storage.end())
+			return &(it->second);
+	}
 
 	// And otherwise we don't have a match.
 	return nullptr;
@@ -508,29 +673,139 @@ const ConditionsStore::ConditionEntry *ConditionsStore::GetEntry(const string &n
 
 
 
+ConditionsStore::ConditionEntry &ConditionsStore::AddEntry(const InternedName *key)
+{
+	auto it = storage.find(key);
+	if(it != storage.end())
+		return it->second;
+
+	names.insert(key);
+	ConditionEntry &ce = storage[key];
+	ce.key = key;
+	ce.MarkChanged();
+	return ce;
+}
+
+
+
 // Helper function to check if we can safely add a provider with the given name.
 bool ConditionsStore::VerifyProviderLocation(const string &name, DerivedProvider *provider) const
 {
-	auto it = storage.upper_bound(name);
-	if(it == storage.begin())
+	const ConditionEntry *ce = GetEntry(FindInterned(name), name);
+	if(!ce)
 		return true;
 
-	--it;
-	const ConditionEntry &ce = it->second;
-
 	// If we find the provider we are trying to add, then it apparently
 	// was safe to add the entry since it was already added before.
-	if(ce.provider == provider)
+	if(ce->provider == provider)
 		return true;
 
-	if(!ce.provider && it->first == name)
+	if(!ce->provider)
 	{
 		Logger::LogError("Error: overwriting primary condition \"" + name + "\" with derived provider.");
 		return true;
 	}
 
-	if(ce.provider && ce.provider->isPrefixProvider && 0 == name.compare(0, ce.provider->name.length(), ce.provider->name))
+	if(ce->provider->isPrefixProvider && 0 == name.compare(0, ce->provider->name.length(), ce->provider->name))
 		throw runtime_error("Error: not adding provider for \"" + name + "\""
-				", because it is within range of prefixed derived provider \"" + ce.provider->name + "\".");
+				", because it is within range of prefixed derived provider \"" + ce->provider->name + "\".");
 	return true;
 }
+
+
+
+// Walk the trie of provider prefixes along the given name. Names are matched
+// one character at a time, so this never has to look at more characters than
+// the longest prefix has.
+const ConditionsStore::InternedName *ConditionsStore::FindPrefix(const string &name) const
+{
+	if(prefixes.empty())
+		return nullptr;
+
+	uint32_t node = 0;
+	for(char c : name)
+	{
+		if(prefixes[node].prefix)
+			return prefixes[node].prefix;
+
+		const auto &next = prefixes[node].next;
+		auto it = find_if(next.begin(), next.end(),
+			[c](const pair<char, uint32_t> &edge) { return edge.first == c; });
+		if(it == next.end())
+			return nullptr;
+		node = it->second;
+	}
+	return prefixes[node].prefix;
+}
+
+
+
+void ConditionsStore::AddPrefix(const InternedName *prefix)
+{
+	if(prefixes.empty())
+		prefixes.emplace_back();
+
+	uint32_t node = 0;
+	for(char c : *prefix->name)
+	{
+		const auto &next = prefixes[node].next;
+		auto it = find_if(next.begin(), next.end(),
+			[c](const pair<char, uint32_t> &edge) { return edge.first == c; });
+		if(it != next.end())
+			node = it->second;
+		else
+		{
+			uint32_t added = prefixes.size();
+			prefixes[node].next.emplace_back(c, added);
+			prefixes.emplace_back();
+			node = added;
+		}
+	}
+	prefixes[node].prefix = prefix;
+}
+
+
+
+ConditionsStore::StoreId::StoreId()
+	: value(NextStamp())
+{
+}
+
+
+
+ConditionsStore::StoreId::StoreId(const StoreId &other)
+	: value(NextStamp())
+{
+}
+
+
+
+ConditionsStore::StoreId::StoreId(StoreId &&other)
+	: value(other.value)
+{
+	other.value = NextStamp();
+}
+
+
+
+ConditionsStore::StoreId &ConditionsStore::StoreId::operator=(const StoreId &other)
+{
+	value = NextStamp();
+	return *this;
+}
+
+
+
+ConditionsStore::StoreId &ConditionsStore::StoreId::operator=(StoreId &&other)
+{
+	value = other.value;
+	other.value = NextStamp();
+	return *this;
+}
+
+
+
+uint64_t ConditionsStore::NextStamp()
+{
+	return ++lastStamp;
+}
@@ -16,10 +16,16 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #ifndef CONDITIONS_STORE_H_
 #define CONDITIONS_STORE_H_
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <initializer_list>
 #include <map>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 class DataNode;
 class DataWriter;
@@ -37,7 +43,46 @@ class DataWriter;
 // data types than int64_t (for example double, float or even complex
 // formulae).
 class ConditionsStore {
+private:
+	// An entry in the program-wide table of interned condition names.
+	class InternedName {
+	public:
+		const std::string *name = nullptr;
+		// The stamp of the last change to a condition with this name, in any store.
+		mutable std::atomic<uint64_t> changed{0};
+	};
+
+	// Sort interned names alphabetically, so the primary conditions can be
+	// iterated in the same order that they are saved in.
+	class NameOrder {
+	public:
+		bool operator()(const InternedName *a, const InternedName *b) const;
+	};
+
+
 public:
+	// A condition name that has been interned: every distinct name is stored only
+	// once for the whole program, so a key can be hashed and compared by its address
+	// instead of by its characters. Interning a name is thread-safe, and the key
+	// stays valid until the program exits.
+	class Key {
+		friend ConditionsStore;
+
+	public:
+		// A key for the empty name, e.g. for an object that has not been named yet.
+		Key();
+		explicit Key(const std::string &name);
+
+		const std::string &Name() const;
+		// Get the stamp of the last time a condition with this name was changed
+		// in any store, or zero if it never was.
+		uint64_t LastChanged() const;
+
+	private:
+		const InternedName *interned;
+	};
+
+
 	// Forward declaration, needed to make ConditionEntry a friend of the
 	// DerivedProvider.
 	class ConditionEntry;
@@ -90,9 +135,14 @@ public:
 		ConditionEntry &operator+=(int64_t val);
 		ConditionEntry &operator-=(int64_t val);
 
+	private:
+		// Record that the value of this (primary) condition has changed.
+		void MarkChanged();
+
 	private:
 		int64_t value = 0;
 		DerivedProvider *provider = nullptr;
+		const InternedName *key = nullptr;
 		// The full keyname for condition we want to access. This full keyname is required
 		// when accessing prefixed providers, because such providers will only know the prefix
 		// part of the key.
@@ -104,10 +154,10 @@ public:
 	// This can be used when saving primary conditions to savegames and/or
 	// for displaying some data based on primary conditions.
 	class PrimariesIterator {
-		using CondMapItType = std::map<std::string, ConditionEntry>::const_iterator;
+		using CondMapItType = std::set<const InternedName *, NameOrder>::const_iterator;
 
 	public:
-		PrimariesIterator(CondMapItType it, CondMapItType endIt);
+		PrimariesIterator(const ConditionsStore &store, CondMapItType it);
 
 		// Iterator traits
 		using iterator_category = std::input_iterator_tag;
@@ -138,8 +188,8 @@ public:
 		// case there is no original pair-object to point to, so we generate a
 		// virtual object on the fly while iterating.
 		std::pair<std::string, int64_t> itVal;
+		const ConditionsStore *store;
 		CondMapItType condMapIt;
-		CondMapItType condMapEnd;
 	};
 
 
@@ -160,6 +210,10 @@ public:
 	int64_t Get(const std::string &name) const;
 	bool Has(const std::string &name) const;
 	std::pair<bool, int64_t> HasGet(const std::string &name) const;
+	std::pair<bool, int64_t> HasGet(Key key) const;
+	// Check if the given condition comes from a derived provider, which means
+	// it can change without this store knowing about it.
+	bool IsDerived(Key key) const;
 
 	// Add a value to a condition, set a value for a condition or erase a
 	// condition completely. Returns true on success, false on failure.
@@ -169,6 +223,7 @@ public:
 
 	// Direct access to a specific condition (using the ConditionEntry as proxy).
 	ConditionEntry &operator[](const std::string &name);
+	ConditionEntry &operator[](Key key);
 
 	// Direct (read-only) access to the stored primary conditions.
 	PrimariesIterator PrimariesBegin() const;
@@ -182,21 +237,69 @@ public:
 	// Helper to completely remove all data and linked condition-providers from the store.
 	void Clear();
 
+	// Every change to a primary condition is given a stamp from a program-wide
+	// counter, so that anything computed from the conditions can tell whether
+	// they have changed since. Get the most recent stamp handed out.
+	static uint64_t CurrentStamp();
+	// Get a number that identifies this store and its current providers. It
+	// changes whenever a provider is added or the store is cleared.
+	uint64_t Id() const;
+
 
 private:
 	// Retrieve a condition entry based on a condition name, the entry doesn't
 	// get created if it doesn't exist yet (the Set function will handle
-	// creation if required).
-	ConditionEntry *GetEntry(const std::string &name);
-	const ConditionEntry *GetEntry(const std::string &name) const;
+	// creation if required). The key is null if the name was never interned.
+	ConditionEntry *GetEntry(const InternedName *key, const std::string &name);
+	const ConditionEntry *GetEntry(const InternedName *key, const std::string &name) const;
+	// Get the entry for the given interned name, creating it if necessary.
+	ConditionEntry &AddEntry(const InternedName *key);
 	bool VerifyProviderLocation(const std::string &name, DerivedProvider *provider) const;
+	std::pair<bool, int64_t> HasGet(const InternedName *key, const std::string &name) const;
+	// Find the prefix of the prefixed provider the given name falls under, if any.
+	const InternedName *FindPrefix(const std::string &name) const;
+	void AddPrefix(const InternedName *prefix);
 
+	static const InternedName *Intern(const std::string &name);
+	static const InternedName *FindInterned(const std::string &name);
+	static std::unordered_map<std::string, InternedName> &InternedNames();
+	static uint64_t NextStamp();
 
 
 private:
-	// Storage for both the primary conditions as well as the providers.
-	std::map<std::string, ConditionEntry> storage;
+	// A node in the trie of provider prefixes. The root is the first node.
+	class PrefixNode {
+	public:
+		// The nodes that follow this one, and the character leading to each.
+		std::vector<std::pair<char, uint32_t>> next;
+		// The prefix that ends at this node, if any.
+		const InternedName *prefix = nullptr;
+	};
+
+	// The ID of a store. A copy of a store may diverge from the original without
+	// either one's conditions being marked as changed, so each copy gets a new ID.
+	// A store that is moved from is emptied, so it gets a new ID as well.
+	class StoreId {
+	public:
+		StoreId();
+		StoreId(const StoreId &other);
+		StoreId(StoreId &&other);
+		StoreId &operator=(const StoreId &other);
+		StoreId &operator=(StoreId &&other);
+
+		uint64_t value;
+	};
+
+
+private:
+	// Storage for both the primary conditions as well as the providers, keyed
+	// by the interned names. The names are also kept in order, for iteration.
+	std::unordered_map<const InternedName *, ConditionEntry> storage;
+	std::set<const InternedName *, NameOrder> names;
 	std::map<std::string, DerivedProvider> providers;
+	std::vector<PrefixNode> prefixes;
+
+	StoreId id;
 };
 
 
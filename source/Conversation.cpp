@@ -104,7 +104,10 @@ void Conversation::Load(const DataNode &node, const string &missionName)
 	if(node.Token(0) != "conversation")
 		return;
 
-	// Free any previously loaded data.
+	// Free any previously loaded data, including any definition that is still
+	// waiting to be parsed.
+	if(lazyDefinition.IsPending())
+		lazyDefinition.Clear();
 	nodes.clear();
 
 	for(const DataNode &child : node)
@@ -237,9 +240,23 @@ void Conversation::Load(const DataNode &node, const string &missionName)
 
 
 
+// Remember the given node, and only parse it the first time this conversation is used.
+void Conversation::LoadLazily(const DataNode &node)
+{
+	if(node.Token(0) != "conversation")
+		return;
+
+	// Each definition replaces any previous one, so only the last must be kept.
+	lazyDefinition.Clear();
+	lazyDefinition.Add(node);
+}
+
+
+
 // Write a conversation to file.
 void Conversation::Save(DataWriter &out) const
 {
+	EnsureLoaded();
 	out.Write("conversation");
 	out.BeginChild();
 	{
@@ -322,14 +339,25 @@ void Conversation::Save(DataWriter &out) const
 // Check if this conversation contains any data.
 bool Conversation::IsEmpty() const noexcept
 {
+	EnsureLoaded();
 	return nodes.empty();
 }
 
 
 
+// Check if this conversation has been given a definition, without parsing
+// that definition if it was loaded lazily.
+bool Conversation::IsDefined() const noexcept
+{
+	return lazyDefinition.IsPending() || !nodes.empty();
+}
+
+
+
 // Check if this conversation contains a name prompt, and thus can be used as an "intro" conversation.
 bool Conversation::IsValidIntro() const noexcept
 {
+	EnsureLoaded();
 	return any_of(nodes.begin(), nodes.end(), [](const Node &node) noexcept -> bool {
 		return node.isChoice && node.elements.empty();
 	});
@@ -340,6 +368,7 @@ bool Conversation::IsValidIntro() const noexcept
 // Check if the actions in this conversation are valid.
 string Conversation::Validate() const
 {
+	EnsureLoaded();
 	for(const Node &node : nodes)
 	{
 		if(!node.actions.IsEmpty())
@@ -358,6 +387,7 @@ string Conversation::Validate() const
 // potential actions.
 Conversation Conversation::Instantiate(map<string, string> &subs, int jumps, int payload) const
 {
+	EnsureLoaded();
 	Conversation result = *this;
 	for(Node &node : result.nodes)
 	{
@@ -533,6 +563,7 @@ bool Conversation::ShouldDisplayNode(const ConditionsStore &vars, int node, int
 // Conversation.
 bool Conversation::NodeIsValid(int node) const
 {
+	EnsureLoaded();
 	if(node < 0)
 		return false;
 	return static_cast<unsigned>(node) < nodes.size();
@@ -554,6 +585,18 @@ bool Conversation::ElementIsValid(int node, int element) const
 
 
 
+// Parse the definition of this conversation, if that was deferred.
+void Conversation::EnsureLoaded() const
+{
+	// Conversations are never created as const objects, so they can be modified here.
+	lazyDefinition.Resolve([this](const DataNode &node) -> void
+		{
+			const_cast<Conversation *>(this)->Load(node);
+		});
+}
+
+
+
 // Parse the children of the given node to see if then contain any "gotos," or
 // "to shows." If so, link them up properly. Return true if gotos or
 // conditions were found.
@@ -19,6 +19,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "ConditionSet.h"
 #include "ConditionsStore.h"
 #include "GameAction.h"
+#include "LazyDefinition.h"
 
 #include <map>
 #include <string>
@@ -117,9 +118,14 @@ public:
 	Conversation(const DataNode &node, const std::string &missionName = "");
 	// Read or write to files.
 	void Load(const DataNode &node, const std::string &missionName = "");
+	// Remember the given node, and only parse it the first time this conversation is used.
+	void LoadLazily(const DataNode &node);
 	void Save(DataWriter &out) const;
 	// Check if any data is loaded in this conversation object.
 	bool IsEmpty() const noexcept;
+	// Check if this conversation has been given a definition, without parsing
+	// that definition if it was loaded lazily.
+	bool IsDefined() const noexcept;
 	// Check if this conversation includes a name prompt.
 	bool IsValidIntro() const noexcept;
 	// Check if the actions in this conversation are valid.
@@ -171,6 +177,8 @@ public:
 
 
 private:
+	// Parse the definition of this conversation, if that was deferred.
+	void EnsureLoaded() const;
 	// Parse the children of the given node to see if they contain any "gotos"
 	// or "conditions." If so, link them up properly. Return true if gotos or
 	// conditions were found.
@@ -195,6 +203,8 @@ private:
 	std::multimap<std::string, std::pair<int, int>> unresolved;
 	// The actual conversation data:
 	std::vector<Node> nodes;
+	// The definition of this conversation, if it has not been parsed yet.
+	LazyDefinition lazyDefinition;
 };
 
 
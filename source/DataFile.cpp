@@ -16,6 +16,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "DataFile.h"
 
 #include "Files.h"
+#include "Gzip.h"
 #include "text/Utf8.h"
 
 using namespace std;
@@ -42,6 +43,8 @@ DataFile::DataFile(istream &in)
 void DataFile::Load(const string &path)
 {
 	string data = Files::Read(path);
+	if(Gzip::IsCompressed(data))
+		data = Gzip::Decompress(data);
 	if(data.empty())
 		return;
 
@@ -18,8 +18,35 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "DataNode.h"
 #include "Files.h"
 
+#include <cmath>
+#include <cstring>
+
 using namespace std;
 
+namespace {
+	// Output is written to the file whenever this much of it has been buffered.
+	const size_t BUFFER_SIZE = 1 << 16;
+
+	// Flags for characters that affect how a token must be quoted.
+	const unsigned char NEEDS_QUOTES = 1;
+	const unsigned char IS_QUOTE = 2;
+
+	// Look up which of those flags apply to each possible character. Whitespace
+	// and control characters mean a token must be quoted; bytes of multi-byte
+	// UTF-8 characters never do.
+	struct QuotingTable {
+		QuotingTable()
+		{
+			for(int c = 0; c <= ' '; ++c)
+				flags[c] = NEEDS_QUOTES;
+			flags[static_cast<unsigned char>('"')] = IS_QUOTE;
+		}
+
+		unsigned char flags[256] = {};
+	};
+	const QuotingTable QUOTING;
+}
+
 
 
 // This string constant is just used for remembering what string needs to be
@@ -28,11 +55,18 @@ const string DataWriter::space = " ";
 
 
 
-// Constructor, specifying the file to save.
+// Constructor, specifying the file to save. The output goes to a temporary
+// file, which only replaces the given one once everything has been written.
 DataWriter::DataWriter(const string &path)
 	: DataWriter()
 {
+	buffer.reserve(BUFFER_SIZE);
 	this->path = path;
+	file = File(path + ".tmp", true);
+	// The output is already buffered here, so there is no point in copying it
+	// into another buffer before it reaches the file.
+	if(file)
+		setvbuf(file, nullptr, _IONBF, 0);
 }
 
 
@@ -41,24 +75,49 @@ DataWriter::DataWriter(const string &path)
 DataWriter::DataWriter()
 	: before(&indent)
 {
-	out.precision(8);
 }
 
 
 
-// Destructor, which saves the file all in one block.
+// Destructor, which writes whatever is left of the file and then moves it into
+// place, so that a failure partway through never truncates the existing file.
 DataWriter::~DataWriter()
 {
-	if(!path.empty())
-		SaveToPath(path);
+	if(!file)
+		return;
+
+	Flush();
+	bool failed = ferror(file);
+	file = File();
+	if(failed)
+		Files::Delete(path + ".tmp");
+	else
+		Files::Move(path + ".tmp", path);
 }
 
 
 
-// Save the contents to a file.
+// Save the contents of an in-memory DataWriter to a file.
 void DataWriter::SaveToPath(const std::string &filepath)
 {
-	Files::Write(filepath, out.str());
+	Files::Write(filepath, buffer);
+}
+
+
+
+// Get the contents of an in-memory DataWriter, e.g. to save them later.
+string DataWriter::SaveToString() const &
+{
+	return buffer;
+}
+
+
+
+// Take the contents out of an in-memory DataWriter that is no longer needed,
+// without copying them.
+string DataWriter::SaveToString() &&
+{
+	return std::move(buffer);
 }
 
 
@@ -88,7 +147,7 @@ void DataWriter::Write(const DataNode &node)
 // Begin a new line of the file.
 void DataWriter::Write()
 {
-	out << '\n';
+	buffer += '\n';
 	before = &indent;
 }
 
@@ -113,31 +172,72 @@ void DataWriter::EndChild()
 // Write a comment line, at the current indentation level.
 void DataWriter::WriteComment(const string &str)
 {
-	out << indent << "# " << str << '\n';
+	Append(indent);
+	Append("# ", 2);
+	Append(str);
+	Append("\n", 1);
 }
 
 
 
 // Write a token, given as a character string.
 void DataWriter::WriteToken(const char *a)
+{
+	WriteString(a, strlen(a));
+}
+
+
+
+// Write a token, given as a string object.
+void DataWriter::WriteToken(const string &a)
+{
+	WriteString(a.data(), a.length());
+}
+
+
+
+// Add the given characters to the output, writing it to the file if enough of
+// it has been buffered.
+void DataWriter::Append(const char *data, size_t length)
+{
+	buffer.append(data, length);
+	if(buffer.length() >= BUFFER_SIZE && file)
+		Flush();
+}
+
+
+
+void DataWriter::Append(const string &data)
+{
+	Append(data.data(), data.length());
+}
+
+
+
+// Write a token that may need to be quoted.
+void DataWriter::WriteString(const char *a, size_t length)
 {
 	// Figure out what kind of quotation marks need to be used for this string.
-	bool needsQuoting = !*a || *a == '#';
-	bool hasQuote = false;
-	for(const char *it = a; *it; ++it)
-	{
-		needsQuoting |= (*it <= ' ' && *it >= 0);
-		hasQuote |= (*it == '"');
-	}
+	unsigned char flags = (!length || *a == '#') ? NEEDS_QUOTES : 0;
+	for(const char *it = a, *end = a + length; it != end; ++it)
+		flags |= QUOTING.flags[static_cast<unsigned char>(*it)];
 
 	// Write the token, enclosed in quotes if necessary.
-	out << *before;
-	if(needsQuoting && hasQuote)
-		out << '`' << a << '`';
-	else if(needsQuoting)
-		out << '"' << a << '"';
+	Append(*before);
+	if(flags == (NEEDS_QUOTES | IS_QUOTE))
+	{
+		Append("`", 1);
+		Append(a, length);
+		Append("`", 1);
+	}
+	else if(flags & NEEDS_QUOTES)
+	{
+		Append("\"", 1);
+		Append(a, length);
+		Append("\"", 1);
+	}
 	else
-		out << a;
+		Append(a, length);
 
 	// The next token written will not be the first one on this line, so it only
 	// needs to have a single space before it.
@@ -146,8 +246,59 @@ void DataWriter::WriteToken(const char *a)
 
 
 
-// Write a token, given as a string object.
-void DataWriter::WriteToken(const string &a)
+// Write a floating point number. Whole numbers that fit in the precision are
+// by far the most common, and are written without any general formatting.
+void DataWriter::WriteNumber(double a)
 {
-	WriteToken(a.c_str());
+	if(a == trunc(a) && fabs(a) < 1e8 && !(a == 0. && signbit(a)))
+	{
+		WriteNumber(static_cast<long long>(a));
+		return;
+	}
+
+	char text[32];
+	int length = snprintf(text, sizeof(text), "%.8g", a);
+	Append(text, length);
+}
+
+
+
+// Write a signed integer.
+void DataWriter::WriteNumber(long long a)
+{
+	if(a < 0)
+	{
+		Append("-", 1);
+		// Negate in unsigned arithmetic so that the smallest value is handled too.
+		WriteNumber(0ull - static_cast<unsigned long long>(a));
+	}
+	else
+		WriteNumber(static_cast<unsigned long long>(a));
+}
+
+
+
+// Write an unsigned integer, one digit at a time.
+void DataWriter::WriteNumber(unsigned long long a)
+{
+	char text[24];
+	char *end = text + sizeof(text);
+	char *it = end;
+	do {
+		*--it = static_cast<char>('0' + a % 10);
+		a /= 10;
+	} while(a);
+	Append(it, end - it);
+}
+
+
+
+// Write the buffered output to the file. An in-memory DataWriter keeps it.
+void DataWriter::Flush()
+{
+	if(!file)
+		return;
+
+	Files::Write(file, buffer);
+	buffer.clear();
 }
@@ -16,10 +16,12 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #ifndef DATA_WRITER_H_
 #define DATA_WRITER_H_
 
+#include "File.h"
+
 #include <algorithm>
 #include <map>
-#include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 class DataNode;
@@ -33,7 +35,8 @@ class DataNode;
 // automatically adds quotation marks around strings if they contain whitespace.
 class DataWriter {
 public:
-	// Constructor, specifying the file to write.
+	// Constructor, specifying the file to write. The output goes to a temporary
+	// file, which only replaces the given one once everything has been written.
 	explicit DataWriter(const std::string &path);
 	// Constructor for a DataWriter that will not save its contents automatically
 	DataWriter();
@@ -41,12 +44,17 @@ public:
 	DataWriter(DataWriter &&) = delete;
 	DataWriter &operator=(const DataWriter &) = delete;
 	DataWriter operator=(DataWriter &&) = delete;
-	// The file is not actually saved until the destructor is called. This makes
-	// it possible to write the whole file in a single chunk.
+	// Anything that has not been written to the file yet is written when the
+	// DataWriter is destroyed, and then the file is moved into place.
 	~DataWriter();
 
-	// Save the contents to a file.
+	// Save the contents of an in-memory DataWriter to a file.
 	void SaveToPath(const std::string &path);
+	// Get the contents of an in-memory DataWriter, e.g. to save them later.
+	std::string SaveToString() const &;
+	// Take the contents out of an in-memory DataWriter that is no longer needed,
+	// without copying them.
+	std::string SaveToString() &&;
 
 	// The Write() function can take any number of arguments. Each argument is
 	// converted to a token. Arguments may be strings or numeric values.
@@ -77,7 +85,23 @@ public:
 
 
 private:
-	// Save path (in UTF-8). Empty string for in-memory DataWriter.
+	// Add the given characters to the output.
+	void Append(const char *data, size_t length);
+	void Append(const std::string &data);
+	// Write a token that may need to be quoted.
+	void WriteString(const char *a, size_t length);
+	// Write a number the same way a stream with a precision of 8 would.
+	void WriteNumber(double a);
+	void WriteNumber(long long a);
+	void WriteNumber(unsigned long long a);
+	// Write the buffered output to the file.
+	void Flush();
+
+
+private:
+	// The file being written. This is not open for an in-memory DataWriter.
+	File file;
+	// The path the file will be moved to once it has been written.
 	std::string path;
 	// Current indentation level.
 	std::string indent;
@@ -87,8 +111,9 @@ private:
 	// Remember which string should be written before the next token. This is
 	// "indent" for the first token in a line and "space" for subsequent tokens.
 	const std::string *before;
-	// Compose the output in memory before writing it to file.
-	std::ostringstream out;
+	// Output that has not been written to the file yet. For an in-memory
+	// DataWriter, this is everything that has been written.
+	std::string buffer;
 };
 
 
@@ -111,7 +136,12 @@ void DataWriter::WriteToken(const A &a)
 	static_assert(std::is_arithmetic<A>::value,
 		"DataWriter cannot output anything but strings and arithmetic types.");
 
-	out << *before << a;
+	// Format every type with the widest function of the same kind.
+	using Number = typename std::conditional<std::is_floating_point<A>::value, double,
+		typename std::conditional<std::is_signed<A>::value, long long, unsigned long long>::type>::type;
+
+	Append(*before);
+	WriteNumber(static_cast<Number>(a));
 	before = &space;
 }
 
@@ -15,6 +15,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "DistanceMap.h"
 
+#include "GameData.h"
 #include "Planet.h"
 #include "PlayerInfo.h"
 #include "Ship.h"
@@ -23,8 +24,83 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "System.h"
 #include "Wormhole.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <list>
+#include <map>
+#include <mutex>
+#include <tuple>
+
 using namespace std;
 
+namespace {
+	// The number of children of each node in the heap of edges to explore.
+	const size_t HEAP_ARITY = 4;
+
+	// Recently calculated maps, with the most recently used one first. Missions
+	// and conditions often ask for the same map many times in a row, e.g. when
+	// deciding which missions to offer on a planet.
+	const size_t CACHE_SIZE = 64;
+	using CacheKey = tuple<const System *, int, int>;
+	list<pair<CacheKey, shared_ptr<const DistanceMap>>> cache;
+	map<CacheKey, decltype(cache)::iterator> cacheIndex;
+	// This is incremented every time the cache is cleared, so that maps that
+	// were being calculated at that time are not added to it.
+	unsigned cacheEpoch = 0;
+	mutex cacheMutex;
+
+	// Facts about the whole galaxy that bound how quickly a ship can travel
+	// between two systems. Like the cached maps, these only change along with
+	// the links between systems.
+	struct GalaxyBounds {
+		// The longest hyperspace link, or the longest jump range of a system.
+		double maxJumpDistance = 0.;
+		// How far each system is from the nearest system that a wormhole leads
+		// into or out of, indexed by System::Index().
+		shared_ptr<vector<double>> wormholeDistance;
+	};
+	shared_ptr<const GalaxyBounds> galaxyBounds;
+
+	shared_ptr<const GalaxyBounds> GetGalaxyBounds()
+	{
+		lock_guard<mutex> lock(cacheMutex);
+		if(galaxyBounds)
+			return galaxyBounds;
+
+		auto bounds = make_shared<GalaxyBounds>();
+		vector<Point> wormholeEnds;
+		for(const auto &it : GameData::Systems())
+		{
+			const System &system = it.second;
+			if(!system.IsValid())
+				continue;
+			bounds->maxJumpDistance = max(bounds->maxJumpDistance, system.JumpRange());
+			for(const System *link : system.AllLinks())
+				bounds->maxJumpDistance = max(bounds->maxJumpDistance, system.Position().Distance(link->Position()));
+			for(const StellarObject &object : system.Objects())
+				if(object.HasValidPlanet() && object.GetPlanet()->IsWormhole())
+				{
+					const Wormhole &wormhole = *object.GetPlanet()->GetWormhole();
+					wormholeEnds.push_back(system.Position());
+					wormholeEnds.push_back(wormhole.WormholeSource(system).Position());
+					wormholeEnds.push_back(wormhole.WormholeDestination(system).Position());
+				}
+		}
+
+		bounds->wormholeDistance = make_shared<vector<double>>(System::IndexCount(),
+			numeric_limits<double>::infinity());
+		for(const auto &it : GameData::Systems())
+		{
+			double &distance = (*bounds->wormholeDistance)[it.second.Index()];
+			for(const Point &end : wormholeEnds)
+				distance = min(distance, it.second.Position().Distance(end));
+		}
+		galaxyBounds = bounds;
+		return galaxyBounds;
+	}
+}
+
 
 
 // Find paths to the given system. If the given maximum count is above zero,
@@ -78,10 +154,64 @@ DistanceMap::DistanceMap(const Ship &ship, const System *destination)
 
 
 
+// Get a map of paths to the given system, like the first constructor, but
+// reuse a recently calculated map with the same arguments if there is one.
+shared_ptr<const DistanceMap> DistanceMap::Cached(const System *center, int maxCount, int maxDistance)
+{
+	CacheKey key(center, maxCount, maxDistance);
+	unsigned epoch;
+	{
+		lock_guard<mutex> lock(cacheMutex);
+		epoch = cacheEpoch;
+		auto it = cacheIndex.find(key);
+		if(it != cacheIndex.end())
+		{
+			cache.splice(cache.begin(), cache, it->second);
+			return it->second->second;
+		}
+	}
+
+	// Calculate the map without holding the lock, so that other threads can
+	// still use the cache in the meantime.
+	shared_ptr<const DistanceMap> result = make_shared<DistanceMap>(center, maxCount, maxDistance);
+
+	lock_guard<mutex> lock(cacheMutex);
+	if(epoch != cacheEpoch)
+		return result;
+	// Another thread may have calculated the same map in the meantime.
+	auto it = cacheIndex.find(key);
+	if(it != cacheIndex.end())
+		return it->second->second;
+
+	cache.emplace_front(key, result);
+	cacheIndex[key] = cache.begin();
+	if(cache.size() > CACHE_SIZE)
+	{
+		cacheIndex.erase(cache.back().first);
+		cache.pop_back();
+	}
+	return result;
+}
+
+
+
+// Forget all cached maps. This must be done whenever links between systems
+// may have changed.
+void DistanceMap::ClearCache()
+{
+	lock_guard<mutex> lock(cacheMutex);
+	++cacheEpoch;
+	cacheIndex.clear();
+	cache.clear();
+	galaxyBounds.reset();
+}
+
+
+
 // Find out if the given system is reachable.
 bool DistanceMap::HasRoute(const System *system) const
 {
-	return route.count(system);
+	return Find(system);
 }
 
 
@@ -89,8 +219,8 @@ bool DistanceMap::HasRoute(const System *system) const
 // Find out how many days away the given system is.
 int DistanceMap::Days(const System *system) const
 {
-	auto it = route.find(system);
-	return (it == route.end() ? -1 : it->second.days);
+	const Edge *edge = Find(system);
+	return (edge ? edge->days : -1);
 }
 
 
@@ -98,8 +228,8 @@ int DistanceMap::Days(const System *system) const
 // Starting in the given system, what is the next system along the route?
 const System *DistanceMap::Route(const System *system) const
 {
-	auto it = route.find(system);
-	return (it == route.end() ? nullptr : it->second.next);
+	const Edge *edge = Find(system);
+	return (edge ? edge->next : nullptr);
 }
 
 
@@ -107,10 +237,7 @@ const System *DistanceMap::Route(const System *system) const
 // Get a set containing all the systems.
 set<const System *> DistanceMap::Systems() const
 {
-	set<const System *> systems;
-	for(const auto &it : route)
-		systems.insert(it.first);
-	return systems;
+	return set<const System *>(reached.begin(), reached.end());
 }
 
 
@@ -125,11 +252,11 @@ const System *DistanceMap::End() const
 
 int DistanceMap::RequiredFuel(const System *system1, const System *system2) const
 {
-	auto it1 = route.find(system1);
-	auto it2 = route.find(system2);
-	if(it1 == route.end() || it2 == route.end())
+	const Edge *edge1 = Find(system1);
+	const Edge *edge2 = Find(system2);
+	if(!edge1 || !edge2)
 		return -1;
-	return abs(it1->second.fuel - it2->second.fuel);
+	return abs(edge1->fuel - edge2->fuel);
 }
 
 
@@ -146,11 +273,11 @@ DistanceMap::Edge::Edge(const System *system)
 // is lower priority than the given item.
 bool DistanceMap::Edge::operator<(const Edge &other) const
 {
-	if(fuel != other.fuel)
-		return (fuel > other.fuel);
+	if(fuel + minFuel != other.fuel + other.minFuel)
+		return (fuel + minFuel > other.fuel + other.minFuel);
 
-	if(days != other.days)
-		return (days > other.days);
+	if(days + minDays != other.days + other.minDays)
+		return (days + minDays > other.days + other.minDays);
 
 	return (danger > other.danger);
 }
@@ -165,7 +292,10 @@ void DistanceMap::Init(const Ship *ship)
 	if(!center)
 		return;
 
-	route[center] = Edge();
+	// The center system is the starting point of every route.
+	route.resize(System::IndexCount());
+	isReached.resize(route.size());
+	Add(*center, Edge());
 	if(!maxDistance)
 		return;
 
@@ -186,7 +316,7 @@ void DistanceMap::Init(const Ship *ship)
 		if(!jumpFuel && !hyperspaceFuel)
 		{
 			bool hasWormhole = false;
-			for(const StellarObject &object : ship->GetSystem()->Objects())
+			for(const StellarObject &object : source->Objects())
 				if(object.HasSprite() && object.HasValidPlanet() && object.GetPlanet()->IsWormhole())
 				{
 					hasWormhole = true;
@@ -196,20 +326,26 @@ void DistanceMap::Init(const Ship *ship)
 			if(!hasWormhole)
 				return;
 		}
+		if(source)
+			InitEstimate();
 	}
 
 	// Find the route with lowest fuel use. If multiple routes use the same fuel,
 	// choose the one with the fewest jumps (i.e. using jump drive rather than
 	// hyperdrive). If multiple routes have the same fuel and the same number of
 	// jumps, break the tie by using how "dangerous" the route is.
-	edges.emplace(center);
 	while(maxCount && !edges.empty())
 	{
-		Edge top = edges.top();
-		edges.pop();
+		Edge top = PopEdge();
+		top.minFuel = 0;
+		top.minDays = 0;
 
-		// Source is only defined when given a ship and a destination system.
-		// Once we have a route between them, stop searching for more routes.
+		// If a better path to this system was found after this edge was added,
+		// then that path has already been explored from here.
+		if(top < *Find(top.next))
+			continue;
+		// A source is only defined when given a ship and a destination system.
+		// Once we have a route from the source, stop searching for more routes.
 		if(top.next == source)
 			break;
 		// Increment the danger and the travel time to include this system. The
@@ -253,6 +389,8 @@ void DistanceMap::Init(const Ship *ship)
 		if(jumpFuel && !Propagate(top, true))
 			break;
 	}
+	// The heap is not needed once the search is done.
+	vector<Edge>().swap(edges);
 }
 
 
@@ -281,8 +419,8 @@ bool DistanceMap::Propagate(Edge edge, bool useJump)
 // Check if we already have a better path to the given system.
 bool DistanceMap::HasBetter(const System &to, const Edge &edge)
 {
-	auto it = route.find(&to);
-	return (it != route.end() && !(it->second < edge));
+	const Edge *existing = Find(&to);
+	return (existing && !(*existing < edge));
 }
 
 
@@ -292,10 +430,134 @@ void DistanceMap::Add(const System &to, Edge edge)
 {
 	// This is the best path we have found so far to this system, but it is
 	// conceivable that a better one will be found.
-	route[&to] = edge;
+	size_t index = to.Index();
+	if(index >= route.size())
+	{
+		route.resize(index + 1);
+		isReached.resize(index + 1);
+	}
+	if(!isReached[index])
+	{
+		isReached[index] = true;
+		reached.push_back(&to);
+	}
+	route[index] = edge;
 	edge.next = &to;
 	if(maxDistance < 0 || edge.days < maxDistance)
-		edges.emplace(edge);
+	{
+		Estimate(to, edge);
+		PushEdge(edge);
+	}
+}
+
+
+
+// Prepare the lower bounds on how many jumps it takes to reach the source.
+// No jump covers more than the longest link or jump range in the galaxy, or
+// than the ship's own jump range; only wormholes can take it any farther.
+void DistanceMap::InitEstimate()
+{
+	shared_ptr<const GalaxyBounds> bounds = GetGalaxyBounds();
+	maxJumpDistance = max(bounds->maxJumpDistance, jumpRange);
+	if(hyperspaceFuel && jumpFuel)
+		minJumpFuel = min(hyperspaceFuel, jumpFuel);
+	else
+		minJumpFuel = max(hyperspaceFuel, jumpFuel);
+	wormholeDistance = bounds->wormholeDistance;
+}
+
+
+
+// Estimate the cost of reaching the source from the given system. This must
+// never be more than the actual cost, or the route found may not be the best.
+void DistanceMap::Estimate(const System &from, Edge &edge) const
+{
+	if(!wormholeDistance || maxJumpDistance <= 0.)
+		return;
+
+	// A route through a wormhole must get to one end of it, and then from the
+	// end of the last wormhole to the source.
+	double distance = min(from.Position().Distance(source->Position()),
+		WormholeDistance(from) + WormholeDistance(*source));
+
+	// Allow for rounding errors, so that a system exactly one jump range away
+	// is not counted as needing two jumps.
+	int jumps = max(0, static_cast<int>(ceil(distance / maxJumpDistance - 1e-6)));
+	edge.minFuel = jumps * minJumpFuel;
+	edge.minDays = jumps;
+}
+
+
+
+// Get how far the given system is from the nearest end of a wormhole. Any
+// system created since that was calculated is assumed to be right next to one.
+double DistanceMap::WormholeDistance(const System &system) const
+{
+	size_t index = system.Index();
+	return (index < wormholeDistance->size() ? (*wormholeDistance)[index] : 0.);
+}
+
+
+
+// Get the best path found to the given system, or null if there is none.
+const DistanceMap::Edge *DistanceMap::Find(const System *system) const
+{
+	if(!system)
+		return nullptr;
+	size_t index = system->Index();
+	return (index < isReached.size() && isReached[index]) ? &route[index] : nullptr;
+}
+
+
+
+// Add an edge to the heap of edges to explore.
+void DistanceMap::PushEdge(const Edge &edge)
+{
+	// Move the new edge up the heap until its parent is at least as good.
+	size_t index = edges.size();
+	edges.push_back(edge);
+	while(index)
+	{
+		size_t parent = (index - 1) / HEAP_ARITY;
+		if(!(edges[parent] < edge))
+			break;
+		edges[index] = edges[parent];
+		index = parent;
+	}
+	edges[index] = edge;
+}
+
+
+
+// Remove the best edge from the heap of edges to explore.
+DistanceMap::Edge DistanceMap::PopEdge()
+{
+	Edge top = edges.front();
+	Edge last = edges.back();
+	edges.pop_back();
+	if(edges.empty())
+		return top;
+
+	// Move the last edge down from the top of the heap until none of its
+	// children are better than it.
+	size_t index = 0;
+	while(true)
+	{
+		size_t first = index * HEAP_ARITY + 1;
+		if(first >= edges.size())
+			break;
+		size_t best = first;
+		size_t end = min(first + HEAP_ARITY, edges.size());
+		for(size_t child = first + 1; child < end; ++child)
+			if(edges[best] < edges[child])
+				best = child;
+		if(!(last < edges[best]))
+			break;
+		edges[index] = edges[best];
+		index = best;
+	}
+	edges[index] = last;
+	return top;
 }
 
 
@@ -16,10 +16,9 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #ifndef DISTANCE_MAP_H_
 #define DISTANCE_MAP_H_
 
-#include <map>
-#include <queue>
+#include <memory>
 #include <set>
-#include <utility>
+#include <vector>
 
 class PlayerInfo;
 class Ship;
@@ -31,7 +30,8 @@ class System;
 // from the given "center" system. Ships with a hyperdrive travel using the
 // "links" between systems. Ships with jump drives can make use of those links,
 // but can also travel to any of a system's "neighbors." A distance map can also
-// be used to calculate the shortest route between two systems.
+// be used to calculate the shortest route between two systems. Routes are stored
+// in arrays indexed by System::Index(), rather than in a map.
 class DistanceMap {
 public:
 	// Find paths to the given system. The optional arguments put a limit on how
@@ -46,6 +46,13 @@ public:
 	// pathfinding will stop once a path to the destination is found.
 	DistanceMap(const Ship &ship, const System *destination);
 
+	// Get a map of paths to the given system, like the first constructor, but
+	// reuse a recently calculated map with the same arguments if there is one.
+	static std::shared_ptr<const DistanceMap> Cached(const System *center, int maxCount = -1, int maxDistance = -1);
+	// Forget all cached maps. This must be done whenever links between systems
+	// may have changed.
+	static void ClearCache();
+
 	// Find out if the given system is reachable.
 	bool HasRoute(const System *system) const;
 	// Find out how many days away the given system is.
@@ -78,6 +85,10 @@ private:
 		int fuel = 0;
 		int days = 0;
 		double danger = 0.;
+		// A lower bound on the fuel and days still needed to reach the source,
+		// which steers the search toward it. Only edges in the heap have this.
+		int minFuel = 0;
+		int minDays = 0;
 	};
 
 
@@ -86,12 +97,23 @@ private:
 	// jump drive paths, or both to find the shortest route. Bail out if the
 	// source system or the maximum count is reached.
 	void Init(const Ship *ship = nullptr);
+	// Prepare the lower bounds on how many jumps it takes to reach the source.
+	void InitEstimate();
+	// Estimate the cost of reaching the source from the given system.
+	void Estimate(const System &from, Edge &edge) const;
+	// Get how far the given system is from the nearest end of a wormhole.
+	double WormholeDistance(const System &system) const;
 	// Add the given links to the map. Return false if an end condition is hit.
 	bool Propagate(Edge edge, bool useJump);
 	// Check if we already have a better path to the given system.
 	bool HasBetter(const System &to, const Edge &edge);
 	// Add the given path to the record.
 	void Add(const System &to, Edge edge);
+	// Get the best path found to the given system, or null if there is none.
+	const Edge *Find(const System *system) const;
+	// Add an edge to the heap of edges to explore, or remove the best one.
+	void PushEdge(const Edge &edge);
+	Edge PopEdge();
 	// Check whether the given link is travelable. If no player was given in the
 	// constructor then this is always true; otherwise, the player must know
 	// that the given link exists.
@@ -99,10 +121,17 @@ private:
 
 
 private:
-	std::map<const System *, Edge> route;
+	// The best path to each system, indexed by System::Index(). Only the paths
+	// to systems in the "reached" list are valid.
+	std::vector<Edge> route;
+	std::vector<bool> isReached;
+	std::vector<const System *> reached;
 
 	// Variables only used during construction:
-	std::priority_queue<Edge> edges;
+	// A heap of edges that still need to be explored, with the best one first.
+	// Each node in the heap has several children, which makes it shallower
+	// than a binary heap and so faster to remove edges from.
+	std::vector<Edge> edges;
 	const PlayerInfo *player = nullptr;
 	const System *source = nullptr;
 	const System *center = nullptr;
@@ -114,6 +143,12 @@ private:
 	int jumpFuel = 0;
 	bool useWormholes = true;
 	double jumpRange = 0.;
+	// For estimating the cost of reaching the source: the longest distance one
+	// jump may cover, the least fuel it uses, and how far each system is from
+	// the nearest end of a wormhole.
+	double maxJumpDistance = 0.;
+	int minJumpFuel = 0;
+	std::shared_ptr<const std::vector<double>> wormholeDistance;
 };
 
 
@@ -135,9 +135,9 @@ void DrawList::Push(const Body &body, Point pos, Point blur, double cloak, int s
 {
 	SpriteShader::Item item;
 
-	item.texture = body.GetSprite()->Texture(isHighDPI);
+	item.sprite = body.GetSprite();
+	item.isHighDPI = isHighDPI;
 	item.frame = body.GetFrame(step);
-	item.frameCount = body.GetSprite()->Frames();
 
 	item.position[0] = static_cast<float>(pos.X() * zoom);
 	item.position[1] = static_cast<float>(pos.Y() * zoom);
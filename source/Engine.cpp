@@ -233,6 +233,17 @@ namespace {
 		return *GameData::Colors().Get("minable target pointer unselected");
 	}
 
+	// Load the sprites of the stellar objects and asteroids in the given system
+	// before any others that are still loading in the background.
+	void PrioritizeSprites(const System &system)
+	{
+		for(const StellarObject &object : system.Objects())
+			GameData::Prioritize(object.GetSprite());
+		for(const System::Asteroid &asteroid : system.Asteroids())
+			GameData::Prioritize(asteroid.Type() ? asteroid.Type()->GetSprite()
+				: SpriteSet::Get("asteroid/" + asteroid.Name() + "/spin"));
+	}
+
 	const double RADAR_SCALE = .025;
 	const double MAX_FUEL_DISPLAY = 5000.;
 }
@@ -255,6 +266,12 @@ Engine::Engine(PlayerInfo &player)
 	for(const StellarObject &object : player.GetSystem()->Objects())
 		if(object.HasSprite() && object.HasValidPlanet())
 			GameData::Preload(object.GetPlanet()->Landscape());
+	// The simulation cannot start until the sprites of everything the player
+	// starts out next to have been loaded, so load those before any others.
+	PrioritizeSprites(*player.GetSystem());
+	for(const shared_ptr<Ship> &ship : player.Ships())
+		if(ship->GetSystem() == player.GetSystem())
+			GameData::Prioritize(ship->GetSprite());
 
 	// Figure out what planet the player is landed on, if any.
 	const StellarObject *object = player.GetStellarObject();
@@ -1237,6 +1254,7 @@ void Engine::EnterSystem()
 					&& flagship->Position().Distance(object.Position()) < 1.)
 				usedWormhole = &object;
 		}
+	PrioritizeSprites(*system);
 
 	// Advance the positions of every StellarObject and update politics.
 	// Remove expired bribes, clearance, and grace periods from past fines.
@@ -1483,7 +1501,10 @@ void Engine::CalculateStep()
 	// on to the ends of the respective lists of objects. These new objects will
 	// be drawn this step (and the projectiles will participate in collision
 	// detection) but they should not be moved, which is why we put off adding
-	// them to the lists until now.
+	// them to the lists until now. Any of their sprites that are still loading
+	// in the background are needed right away.
+	for(const shared_ptr<Ship> &ship : newShips)
+		GameData::Prioritize(ship->GetSprite());
 	ships.splice(ships.end(), newShips);
 	Append(projectiles, newProjectiles);
 	flotsam.splice(flotsam.end(), newFlotsam);
@@ -25,6 +25,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #define STRICT
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#include <sys/utime.h>
 #else
 #include <dirent.h>
 #include <sys/stat.h>
@@ -441,6 +442,23 @@ time_t Files::Timestamp(const string &filePath)
 
 
 
+void Files::SetTimestamp(const string &filePath, time_t timestamp)
+{
+#if defined _WIN32
+	struct _utimbuf times;
+	times.actime = timestamp;
+	times.modtime = timestamp;
+	_wutime(Utf8::ToUTF16(filePath).c_str(), &times);
+#else
+	struct utimbuf times;
+	times.actime = timestamp;
+	times.modtime = timestamp;
+	utime(filePath.c_str(), &times);
+#endif
+}
+
+
+
 void Files::Copy(const string &from, const string &to)
 {
 #if defined _WIN32
@@ -486,6 +504,19 @@ void Files::Delete(const string &filePath)
 
 
 
+void Files::CreateFolder(const string &path)
+{
+	if(Exists(path))
+		return;
+#if defined _WIN32
+	CreateDirectoryW(Utf8::ToUTF16(path).c_str(), nullptr);
+#else
+	mkdir(path.c_str(), 0755);
+#endif
+}
+
+
+
 // Get the filename from a path.
 string Files::Name(const string &path)
 {
@@ -561,6 +592,23 @@ void Files::Write(FILE *file, const string &data)
 
 
 
+void Files::Append(const string &path, const string &data)
+{
+#if defined _WIN32
+	FILE *file = nullptr;
+	_wfopen_s(&file, Utf8::ToUTF16(path).c_str(), L"ab");
+#else
+	FILE *file = fopen(path.c_str(), "ab");
+#endif
+	if(!file)
+		return;
+
+	Write(file, data);
+	fclose(file);
+}
+
+
+
 // Open this user's plugins directory in their native file explorer.
 void Files::OpenUserPluginFolder()
 {
@@ -55,9 +55,13 @@ public:
 
 	static bool Exists(const std::string &filePath);
 	static std::time_t Timestamp(const std::string &filePath);
+	// Change the modification time of the given file.
+	static void SetTimestamp(const std::string &filePath, std::time_t timestamp);
 	static void Copy(const std::string &from, const std::string &to);
 	static void Move(const std::string &from, const std::string &to);
 	static void Delete(const std::string &filePath);
+	// Create the given directory, if it does not already exist.
+	static void CreateFolder(const std::string &path);
 
 	// Get the filename from a path.
 	static std::string Name(const std::string &path);
@@ -68,6 +72,8 @@ public:
 	static std::string Read(FILE *file);
 	static void Write(const std::string &path, const std::string &data);
 	static void Write(FILE *file, const std::string &data);
+	// Add the given data to the end of a file, creating it if necessary.
+	static void Append(const std::string &path, const std::string &data);
 
 	// Open this user's plugins directory in their native file explorer.
 	static void OpenUserPluginFolder();
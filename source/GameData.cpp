@@ -35,9 +35,11 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "GameEvent.h"
 #include "Government.h"
 #include "Hazard.h"
+#include "ImageCache.h"
 #include "ImageSet.h"
 #include "Interface.h"
 #include "LineShader.h"
+#include "LocationFilter.h"
 #include "MaskManager.h"
 #include "Minable.h"
 #include "Mission.h"
@@ -50,11 +52,13 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Planet.h"
 #include "PointerShader.h"
 #include "Politics.h"
+#include "Preferences.h"
 #include "Random.h"
 #include "RingShader.h"
 #include "Ship.h"
 #include "Sprite.h"
 #include "SpriteQueue.h"
+#include "SpriteResidency.h"
 #include "SpriteSet.h"
 #include "SpriteShader.h"
 #include "StarField.h"
@@ -65,6 +69,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "UniverseObjects.h"
 
 #include <algorithm>
+#include <future>
 #include <iostream>
 #include <utility>
 #include <vector>
@@ -73,14 +78,6 @@ using namespace std;
 
 namespace {
 	UniverseObjects objects;
-	Set<Fleet> defaultFleets;
-	Set<Government> defaultGovernments;
-	Set<Planet> defaultPlanets;
-	Set<System> defaultSystems;
-	Set<Galaxy> defaultGalaxies;
-	Set<Sale<Ship>> defaultShipSales;
-	Set<Sale<Outfit>> defaultOutfitSales;
-	Set<Wormhole> defaultWormholes;
 	TextReplacements defaultSubstitutions;
 
 	Politics politics;
@@ -89,6 +86,7 @@ namespace {
 
 	map<string, string> plugins;
 	SpriteQueue spriteQueue;
+	SpriteResidency residency(spriteQueue);
 
 	vector<string> sources;
 	map<const Sprite *, shared_ptr<ImageSet>> deferred;
@@ -100,6 +98,23 @@ namespace {
 	map<const System *, map<string, int>> purchases;
 
 	ConditionsStore globalConditions;
+
+	// Whether sprites that are referred to but do not exist have been reported.
+	bool checkedSpriteReferences = false;
+	// Cleaning up the image cache runs in the background once every sprite
+	// has been loaded.
+	future<void> pruneImageCache;
+
+	// The user interface must be loaded before the game can start, but all other
+	// sprites can be loaded in the background once it does.
+	SpriteQueue::Priority LoadPriority(const string &name)
+	{
+		static const vector<string> INTERFACE = {"_menu/", "icon/", "ui/"};
+		for(const string &prefix : INTERFACE)
+			if(!name.compare(0, prefix.length(), prefix))
+				return SpriteQueue::Priority::IMMEDIATE;
+		return SpriteQueue::Priority::BACKGROUND;
+	}
 }
 
 
@@ -129,30 +144,36 @@ future<void> GameData::BeginLoad(bool onlyLoadData, bool debugMode)
 			if(ImageSet::IsDeferred(it.first))
 				deferred[SpriteSet::Get(it.first)] = it.second;
 			else
-				spriteQueue.Add(it.second);
+			{
+				spriteQueue.Add(it.second, LoadPriority(it.first));
+				residency.Add(it.second);
+			}
 		}
 
 		// Generate a catalog of music files.
 		Music::Init(sources);
 	}
 
-	return objects.Load(sources, debugMode);
+	// Data that is only being checked or printed must be parsed up front, so that
+	// every error is reported. Otherwise, only parse most definitions when needed.
+	return objects.Load(sources, debugMode, !onlyLoadData);
 }
 
 
 
 void GameData::FinishLoading()
 {
-	// Store the current state, to revert back to later.
-	defaultFleets = objects.fleets;
-	defaultGovernments = objects.governments;
-	defaultPlanets = objects.planets;
-	defaultSystems = objects.systems;
-	defaultGalaxies = objects.galaxies;
-	defaultShipSales = objects.shipSales;
-	defaultOutfitSales = objects.outfitSales;
+	// Store the current state, to revert back to later. Objects that events can
+	// change are only copied once an event actually changes them.
+	objects.fleets.Snapshot();
+	objects.governments.Snapshot();
+	objects.planets.Snapshot();
+	objects.systems.Snapshot();
+	objects.galaxies.Snapshot();
+	objects.shipSales.Snapshot();
+	objects.outfitSales.Snapshot();
+	objects.wormholes.Snapshot();
 	defaultSubstitutions = objects.substitutions;
-	defaultWormholes = objects.wormholes;
 	playerGovernment = objects.governments.Get("Escort");
 
 	politics.Reset();
@@ -239,14 +260,13 @@ void GameData::Preload(const Sprite *sprite)
 	// This sprite is not currently preloaded. Check to see whether we already
 	// have the maximum number of sprites loaded, in which case the oldest one
 	// must be unloaded to make room for this one.
-	const string &name = sprite->Name();
 	pit = preloaded.begin();
 	while(pit != preloaded.end())
 	{
 		++pit->second;
 		if(pit->second >= 20)
 		{
-			spriteQueue.Unload(name);
+			spriteQueue.Unload(pit->first->Name());
 			pit = preloaded.erase(pit);
 		}
 		else
@@ -260,14 +280,37 @@ void GameData::Preload(const Sprite *sprite)
 
 
 
+// Load the given sprite before any that are still loading in the background,
+// because it is about to be drawn.
+void GameData::Prioritize(const Sprite *sprite)
+{
+	if(sprite)
+		residency.Prioritize(sprite);
+}
+
+
+
 void GameData::ProcessSprites()
 {
+	// Any sprites that are unloaded to stay within the budget must be unloaded
+	// right away, before the next step checks which ones are loaded.
+	residency.Step(Preferences::TextureMemoryBudget());
 	spriteQueue.UploadSprites();
+
+	// Once every sprite has been loaded, look for invalid file paths, e.g. due
+	// to capitalization errors or other typos.
+	if(!checkedSpriteReferences && IsLoaded()
+			&& spriteQueue.GetProgress(SpriteQueue::Priority::BACKGROUND) == 1.)
+	{
+		SpriteSet::CheckReferences();
+		checkedSpriteReferences = true;
+		pruneImageCache = async(launch::async, &ImageCache::Prune);
+	}
 }
 
 
 
-// Wait until all pending sprite uploads are completed.
+// Wait until all the sprites that are needed right away are uploaded.
 void GameData::FinishLoadingSprites()
 {
 	spriteQueue.Finish();
@@ -275,6 +318,13 @@ void GameData::FinishLoadingSprites()
 
 
 
+// Check whether the sprites that are needed right away are all uploaded.
+bool GameData::ArePrioritySpritesLoaded()
+{
+	return !residency.HasRequests() && spriteQueue.GetProgress() == 1.;
+}
+
+
 // Get the list of resource sources (i.e. plugin folders).
 const vector<string> &GameData::Sources()
 {
@@ -294,15 +344,24 @@ UniverseObjects &GameData::Objects()
 // Revert any changes that have been made to the universe.
 void GameData::Revert()
 {
-	objects.fleets.Revert(defaultFleets);
-	objects.governments.Revert(defaultGovernments);
-	objects.planets.Revert(defaultPlanets);
-	objects.systems.Revert(defaultSystems);
-	objects.galaxies.Revert(defaultGalaxies);
-	objects.shipSales.Revert(defaultShipSales);
-	objects.outfitSales.Revert(defaultOutfitSales);
+	// The neighbor lists and autogenerated wormholes are not saved in the
+	// snapshot, so recalculate them if the star map has been changed.
+	bool changedSystems = objects.systems.IsModified();
+	objects.fleets.RestoreSnapshot();
+	objects.governments.RestoreSnapshot();
+	objects.planets.RestoreSnapshot();
+	objects.systems.RestoreSnapshot();
+	objects.galaxies.RestoreSnapshot();
+	objects.shipSales.RestoreSnapshot();
+	objects.outfitSales.RestoreSnapshot();
 	objects.substitutions.Revert(defaultSubstitutions);
-	objects.wormholes.Revert(defaultWormholes);
+	objects.wormholes.RestoreSnapshot();
+	if(changedSystems)
+		objects.UpdateSystems();
+	else
+		LocationFilter::ClearCache();
+	for(auto &it : objects.systems)
+		it.second.ResetEconomy();
 	for(auto &it : objects.persons)
 		it.second.Restore();
 
@@ -575,6 +634,13 @@ const Set<Mission> &GameData::Missions()
 
 
 
+const MissionIndex &GameData::MissionOffers()
+{
+	return objects.missionIndex;
+}
+
+
+
 const Set<News> &GameData::SpaceportNews()
 {
 	return objects.news;
@@ -870,7 +936,8 @@ void GameData::LoadSources()
 		if(!icon->IsEmpty())
 		{
 			icon->ValidateFrames();
-			spriteQueue.Add(icon);
+			spriteQueue.Add(icon, SpriteQueue::Priority::BACKGROUND);
+			residency.Add(icon);
 		}
 	}
 }
@@ -45,6 +45,7 @@ class Interface;
 class MaskManager;
 class Minable;
 class Mission;
+class MissionIndex;
 class News;
 class Outfit;
 class Panel;
@@ -84,9 +85,18 @@ public:
 	// Begin loading a sprite that was previously deferred. Currently this is
 	// done with all landscapes to speed up the program's startup.
 	static void Preload(const Sprite *sprite);
+	// Load the given sprite before any that are still loading in the background,
+	// because it is about to be drawn.
+	static void Prioritize(const Sprite *sprite);
+	// Upload any sprites that have been loaded, and unload or reload sprites to
+	// keep their textures within the memory budget. Call this every frame.
 	static void ProcessSprites();
-	// Wait until all pending sprite uploads are completed.
+	// Wait until all the sprites that are needed right away are uploaded.
 	static void FinishLoadingSprites();
+	// Check whether the sprites that are needed right away, including any that
+	// have been prioritized, are all uploaded. Unlike FinishLoadingSprites(),
+	// this does not wait.
+	static bool ArePrioritySpritesLoaded();
 
 	// Get the list of resource sources (i.e. plugin folders).
 	static const std::vector<std::string> &Sources();
@@ -127,6 +137,8 @@ public:
 	static const Set<Interface> &Interfaces();
 	static const Set<Minable> &Minables();
 	static const Set<Mission> &Missions();
+	// Get the missions sorted by where they can be offered.
+	static const MissionIndex &MissionOffers();
 	static const Set<News> &SpaceportNews();
 	static const Set<Outfit> &Outfits();
 	static const Set<Sale<Outfit>> &Outfitters();
@@ -39,6 +39,30 @@ namespace {
 		"substitutions",
 		"wormhole",
 	};
+
+	// Record the universe object definition, if any, made by the given change.
+	void AddDefinition(map<string, set<string>> &definitions, const DataNode &node)
+	{
+		if(node.Size() < 2 || !node.HasChildren() || !DEFINITION_NODES.count(node.Token(0)))
+			return;
+
+		const string &key = node.Token(0);
+		const string &name = node.Token(1);
+		if(key == "system")
+		{
+			// A system is only actually defined by this change node if its position is set.
+			if(any_of(node.begin(), node.end(), [](const DataNode &child) noexcept -> bool
+					{
+						return child.Size() >= 3 && child.Token(0) == "pos";
+					}))
+				definitions[key].emplace(name);
+		}
+		// Since this (or any other) event may be used to assign a planet to a system, we cannot
+		// do a robust "planet definition" check. Similarly, all other GameEvent-createable objects
+		// become valid once they appear as a root-level node that has at least one child node.
+		else
+			definitions[key].emplace(name);
+	}
 }
 
 
@@ -49,25 +73,7 @@ map<string, set<string>> GameEvent::DeferredDefinitions(const list<DataNode> &ch
 	auto definitions = map<string, set<string>> {};
 
 	for(auto &&node : changes)
-		if(node.Size() >= 2 && node.HasChildren() && DEFINITION_NODES.count(node.Token(0)))
-		{
-			const string &key = node.Token(0);
-			const string &name = node.Token(1);
-			if(key == "system")
-			{
-				// A system is only actually defined by this change node if its position is set.
-				if(any_of(node.begin(), node.end(), [](const DataNode &child) noexcept -> bool
-						{
-							return child.Size() >= 3 && child.Token(0) == "pos";
-						}))
-					definitions[key].emplace(name);
-			}
-			// Since this (or any other) event may be used to assign a planet to a system, we cannot
-			// do a robust "planet definition" check. Similarly, all other GameEvent-createable objects
-			// become valid once they appear as a root-level node that has at least one child node.
-			else
-				definitions[key].emplace(name);
-		}
+		AddDefinition(definitions, node);
 
 	return definitions;
 }
@@ -84,6 +90,9 @@ GameEvent::GameEvent(const DataNode &node)
 
 void GameEvent::Load(const DataNode &node)
 {
+	// Parse any deferred definitions first, so that the changes stay in order.
+	EnsureLoaded();
+
 	// If the event has a name, a condition should be automatically created that
 	// represents the fact that this event has occurred.
 	if(node.Size() >= 2)
@@ -118,7 +127,10 @@ void GameEvent::Load(const DataNode &node)
 		else if(key == "visit planet" && child.Size() >= 2)
 			planetsToVisit.push_back(GameData::Planets().Get(child.Token(1)));
 		else if(allowedChanges.count(key))
+		{
 			changes.push_back(child);
+			AddDefinition(definitions, child);
+		}
 		else
 			conditionsToApply.Add(child);
 	}
@@ -131,6 +143,7 @@ void GameEvent::Save(DataWriter &out) const
 	if(isDisabled)
 		return;
 
+	EnsureLoaded();
 	out.Write("event");
 	out.BeginChild();
 	{
@@ -156,6 +169,21 @@ void GameEvent::Save(DataWriter &out) const
 
 
 
+// Remember the given node, and only parse it the first time this event is used.
+void GameEvent::LoadLazily(const DataNode &node)
+{
+	if(node.Size() >= 2)
+		name = node.Token(1);
+	lazyDefinition.Add(node);
+
+	// Which objects this event defines is needed to check the references of
+	// the whole universe, so it is recorded without parsing the rest.
+	for(const DataNode &child : node)
+		AddDefinition(definitions, child);
+}
+
+
+
 // Prevent this GameEvent from being applied or written into a player's save.
 // (Events read from a save are not associated with the managed Set of GameData::Events.)
 void GameEvent::Disable()
@@ -183,6 +211,7 @@ void GameEvent::SetName(const string &name)
 
 const Date &GameEvent::GetDate() const
 {
+	EnsureLoaded();
 	return date;
 }
 
@@ -193,6 +222,7 @@ const Date &GameEvent::GetDate() const
 // Returns an empty string if it is valid. If not, a reason will be given in the string.
 string GameEvent::IsValid() const
 {
+	EnsureLoaded();
 	// When Apply is called, we mutate the universe definition before we update
 	// the player's knowledge of the universe. Thus, to determine if a system or
 	// planet is invalid, we must first peek at what `changes` will do.
@@ -214,6 +244,7 @@ string GameEvent::IsValid() const
 
 void GameEvent::SetDate(const Date &date)
 {
+	EnsureLoaded();
 	this->date = date;
 }
 
@@ -224,6 +255,7 @@ void GameEvent::Apply(PlayerInfo &player)
 	if(isDisabled)
 		return;
 
+	EnsureLoaded();
 	// Apply this event's ConditionSet to the player's conditions.
 	conditionsToApply.Apply(player.Conditions());
 	// Apply (and store a record of applying) this event's other general
@@ -245,7 +277,29 @@ void GameEvent::Apply(PlayerInfo &player)
 
 
 
+// Get the universe object definitions made by this event's changes, without
+// having to parse the event.
+const map<string, set<string>> &GameEvent::Definitions() const
+{
+	return definitions;
+}
+
+
+
 const list<DataNode> &GameEvent::Changes() const
 {
+	EnsureLoaded();
 	return changes;
 }
+
+
+
+// Parse any definitions of this event that were loaded lazily.
+void GameEvent::EnsureLoaded() const
+{
+	// Events are never created as const objects, so they can be modified here.
+	lazyDefinition.Resolve([this](const DataNode &node) -> void
+		{
+			const_cast<GameEvent *>(this)->Load(node);
+		});
+}
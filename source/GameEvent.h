@@ -19,6 +19,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "ConditionSet.h"
 #include "DataNode.h"
 #include "Date.h"
+#include "LazyDefinition.h"
 
 #include <list>
 #include <map>
@@ -52,6 +53,8 @@ public:
 	GameEvent(const DataNode &node);
 
 	void Load(const DataNode &node);
+	// Remember the given node, and only parse it the first time this event is used.
+	void LoadLazily(const DataNode &node);
 	void Save(DataWriter &out) const;
 	// If disabled, an event will not Apply() or Save().
 	void Disable();
@@ -69,9 +72,16 @@ public:
 
 	void Apply(PlayerInfo &player);
 
+	// Get the universe object definitions made by this event's changes, without
+	// having to parse the event.
+	const std::map<std::string, std::set<std::string>> &Definitions() const;
 	const std::list<DataNode> &Changes() const;
 
 
+private:
+	void EnsureLoaded() const;
+
+
 private:
 	Date date;
 	std::string name;
@@ -80,10 +90,14 @@ private:
 
 	ConditionSet conditionsToApply;
 	std::list<DataNode> changes;
+	std::map<std::string, std::set<std::string>> definitions;
 	std::vector<const System *> systemsToVisit;
 	std::vector<const Planet *> planetsToVisit;
 	std::vector<const System *> systemsToUnvisit;
 	std::vector<const Planet *> planetsToUnvisit;
+
+	// Definitions of this event that have not been parsed yet.
+	LazyDefinition lazyDefinition;
 };
 
 
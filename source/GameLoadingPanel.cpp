@@ -29,7 +29,6 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Point.h"
 #include "PointerShader.h"
 #include "Ship.h"
-#include "SpriteSet.h"
 #include "StarField.h"
 #include "System.h"
 #include "UI.h"
@@ -56,12 +55,11 @@ void GameLoadingPanel::Step()
 	GameData::ProcessSprites();
 	if(GameData::IsLoaded())
 	{
-		// Now that we have finished loading all the basic sprites and sounds, we can look for invalid file paths,
-		// e.g. due to capitalization errors or other typos.
-		SpriteSet::CheckReferences();
+		// Now that we have finished loading all the sounds, we can look for invalid file paths, e.g. due to
+		// capitalization errors or other typos. Most sprites are still loading, so they are checked later.
 		Audio::CheckReferences();
 		// All sprites with collision masks should also have their 1x scaled versions, so create
-		// any additional scaled masks from the default one.
+		// any additional scaled masks from the default one. Sprites that are still loading get them once they are.
 		GameData::GetMaskManager().ScaleMasks();
 		// Set the game's initial internal state.
 		GameData::FinishLoading();
@@ -0,0 +1,122 @@
+/* Gzip.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "Gzip.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+namespace {
+	// Data is compressed and decompressed in blocks of this size.
+	const size_t BLOCK = 1 << 16;
+	// Add 16 to the window size to use the gzip format instead of raw zlib data.
+	const int GZIP_WINDOW_BITS = MAX_WBITS + 16;
+	// Saved games are compressed at a level that is almost as fast as the
+	// fastest level, but still makes them about a quarter of the size.
+	const int COMPRESSION_LEVEL = 3;
+	// zlib can only be given this many bytes of input at a time.
+	const size_t MAX_CHUNK = numeric_limits<uInt>::max();
+}
+
+
+
+// Check if the given data begins with the gzip signature.
+bool Gzip::IsCompressed(const string &data)
+{
+	return data.size() >= 2 && static_cast<unsigned char>(data[0]) == 0x1f
+		&& static_cast<unsigned char>(data[1]) == 0x8b;
+}
+
+
+
+// Decompress the given data, if it is compressed.
+string Gzip::Decompress(const string &data, size_t size)
+{
+	if(!IsCompressed(data))
+		return data.substr(0, size);
+
+	z_stream stream = {};
+	if(inflateInit2(&stream, GZIP_WINDOW_BITS) != Z_OK)
+		return string();
+
+	string result;
+	size_t consumed = 0;
+	int status = Z_OK;
+	while(status == Z_OK && result.size() < size)
+	{
+		if(!stream.avail_in && consumed < data.size())
+		{
+			size_t count = min(data.size() - consumed, MAX_CHUNK);
+			stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data() + consumed));
+			stream.avail_in = static_cast<uInt>(count);
+			consumed += count;
+		}
+
+		size_t start = result.size();
+		result.resize(start + BLOCK);
+		stream.next_out = reinterpret_cast<Bytef *>(&result[start]);
+		stream.avail_out = BLOCK;
+		status = inflate(&stream, Z_NO_FLUSH);
+		result.resize(start + BLOCK - stream.avail_out);
+		// If no progress can be made, the data must be truncated.
+		if(status == Z_BUF_ERROR && consumed == data.size())
+			break;
+		if(status == Z_BUF_ERROR)
+			status = Z_OK;
+	}
+	inflateEnd(&stream);
+	return result;
+}
+
+
+
+// Compress the given data, writing it to the given file a block at a time.
+bool Gzip::Write(FILE *file, const string &data)
+{
+	if(!file)
+		return false;
+
+	z_stream stream = {};
+	if(deflateInit2(&stream, COMPRESSION_LEVEL, Z_DEFLATED, GZIP_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+
+	string buffer(BLOCK, '\0');
+	size_t consumed = 0;
+	int status = Z_OK;
+	while(status == Z_OK)
+	{
+		if(!stream.avail_in && consumed < data.size())
+		{
+			size_t count = min(data.size() - consumed, MAX_CHUNK);
+			stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data() + consumed));
+			stream.avail_in = static_cast<uInt>(count);
+			consumed += count;
+		}
+
+		stream.next_out = reinterpret_cast<Bytef *>(&buffer[0]);
+		stream.avail_out = BLOCK;
+		status = deflate(&stream, consumed == data.size() ? Z_FINISH : Z_NO_FLUSH);
+		size_t count = BLOCK - stream.avail_out;
+		if(count && fwrite(buffer.data(), 1, count, file) != count)
+			status = Z_ERRNO;
+	}
+	deflateEnd(&stream);
+	return status == Z_STREAM_END;
+}
@@ -0,0 +1,44 @@
+/* Gzip.h
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef ES_GZIP_H_
+#define ES_GZIP_H_
+
+#include <cstdio>
+#include <string>
+
+
+
+// Functions for reading and writing data in the gzip format, which is used to
+// make saved games take up less space. Data that does not begin with the gzip
+// signature is treated as plain text, so compressed and uncompressed files can
+// be read in exactly the same way.
+class Gzip {
+public:
+	// Check if the given data begins with the gzip signature.
+	static bool IsCompressed(const std::string &data);
+	// Decompress the given data, if it is compressed. To only read the start of
+	// it, give the number of bytes of output that are needed; more may be
+	// returned than that.
+	static std::string Decompress(const std::string &data, size_t size = std::string::npos);
+	// Compress the given data, writing it to the given file a block at a time.
+	// Return false if anything went wrong.
+	static bool Write(FILE *file, const std::string &data);
+};
+
+
+
+#endif
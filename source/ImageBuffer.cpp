@@ -16,6 +16,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "ImageBuffer.h"
 
 #include "File.h"
+#include "ImageCache.h"
 #include "Logger.h"
 
 #include <jpeglib.h>
@@ -25,12 +26,17 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <stdexcept>
 #include <vector>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 using namespace std;
 
 namespace {
 	bool ReadPNG(const string &path, ImageBuffer &buffer, int frame);
 	bool ReadJPG(const string &path, ImageBuffer &buffer, int frame);
-	void Premultiply(ImageBuffer &buffer, int frame, int additive);
+	void PremultiplyRow(uint32_t *it, uint32_t *end, int additive);
+	void ShrinkRow(const uint32_t *a, const uint32_t *b, uint32_t *out, int width);
 }
 
 
@@ -129,21 +135,10 @@ void ImageBuffer::ShrinkToHalfSize()
 	ImageBuffer result(frames);
 	result.Allocate(width / 2, height / 2);
 
-	unsigned char *begin = reinterpret_cast<unsigned char *>(pixels);
-	unsigned char *out = reinterpret_cast<unsigned char *>(result.pixels);
+	uint32_t *out = result.pixels;
 	// Loop through every line of every frame of the buffer.
-	for(int y = 0; y < result.height * frames; ++y)
-	{
-		unsigned char *aIt = begin + (4 * width) * (2 * y);
-		unsigned char *aEnd = aIt + 4 * 2 * result.width;
-		unsigned char *bIt = begin + (4 * width) * (2 * y + 1);
-		for( ; aIt != aEnd; aIt += 4, bIt += 4)
-		{
-			for(int channel = 0; channel < 4; ++channel, ++aIt, ++bIt, ++out)
-				*out = (static_cast<unsigned>(aIt[0]) + static_cast<unsigned>(bIt[0])
-					+ static_cast<unsigned>(aIt[4]) + static_cast<unsigned>(bIt[4]) + 2) / 4;
-		}
-	}
+	for(int y = 0; y < result.height * frames; ++y, out += result.width)
+		ShrinkRow(pixels + width * (2 * y), pixels + width * (2 * y + 1), out, result.width);
 	swap(width, result.width);
 	swap(height, result.height);
 	swap(pixels, result.pixels);
@@ -151,6 +146,14 @@ void ImageBuffer::ShrinkToHalfSize()
 
 
 
+void ImageBuffer::Premultiply(int frame, int additive)
+{
+	for(int y = 0; y < height; ++y)
+		PremultiplyRow(Begin(y, frame), Begin(y, frame) + width, additive);
+}
+
+
+
 bool ImageBuffer::Read(const string &path, int frame)
 {
 	// First, make sure this is a JPG or PNG file.
@@ -163,6 +166,10 @@ bool ImageBuffer::Read(const string &path, int frame)
 	if(!isPNG && !isJPG)
 		return false;
 
+	// If this image was decoded on an earlier run, reuse the result.
+	if(ImageCache::Read(path, *this, frame))
+		return true;
+
 	if(isPNG && !ReadPNG(path, *this, frame))
 		return false;
 	if(isJPG && !ReadJPG(path, *this, frame))
@@ -182,8 +189,9 @@ bool ImageBuffer::Read(const string &path, int frame)
 	{
 		int additive = (path[pos] == '+') ? 2 : (path[pos] == '~') ? 1 : 0;
 		if(isPNG || (isJPG && additive == 2))
-			Premultiply(*this, frame, additive);
+			Premultiply(frame, additive);
 	}
+	ImageCache::Write(path, *this, frame);
 	return true;
 }
 
@@ -352,29 +360,97 @@ namespace {
 
 
 
-	void Premultiply(ImageBuffer &buffer, int frame, int additive)
+	uint32_t PremultiplyPixel(uint64_t value, int additive)
+	{
+		uint64_t alpha = (value & 0xFF000000) >> 24;
+
+		uint64_t red = (((value & 0xFF0000) * alpha) / 255) & 0xFF0000;
+		uint64_t green = (((value & 0xFF00) * alpha) / 255) & 0xFF00;
+		uint64_t blue = (((value & 0xFF) * alpha) / 255) & 0xFF;
+
+		value = red | green | blue;
+		if(additive == 1)
+			alpha >>= 2;
+		if(additive != 2)
+			value |= (alpha << 24);
+
+		return static_cast<uint32_t>(value);
+	}
+
+
+
+	// The vector versions of the conversions below work on the color channels
+	// as 16-bit numbers. For any product of two bytes, x / 255 is exactly equal
+	// to (x + 1 + (x >> 8)) >> 8, which avoids a division.
+#ifdef __SSE2__
+	__m128i PremultiplyPixels(__m128i value, int additive)
 	{
-		for(int y = 0; y < buffer.Height(); ++y)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i one = _mm_set1_epi16(1);
+		__m128i result[2] = {_mm_unpacklo_epi8(value, zero), _mm_unpackhi_epi8(value, zero)};
+		for(__m128i &half : result)
 		{
-			uint32_t *it = buffer.Begin(y, frame);
+			__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(half, 0xFF), 0xFF);
+			half = _mm_mullo_epi16(half, alpha);
+			half = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(half, one), _mm_srli_epi16(half, 8)), 8);
+		}
+		__m128i color = _mm_and_si128(_mm_packus_epi16(result[0], result[1]), _mm_set1_epi32(0xFFFFFF));
+		if(additive == 1)
+			return _mm_or_si128(color, _mm_slli_epi32(_mm_srli_epi32(value, 26), 24));
+		if(additive != 2)
+			return _mm_or_si128(color, _mm_andnot_si128(_mm_set1_epi32(0xFFFFFF), value));
+		return color;
+	}
+#endif
 
-			for(uint32_t *end = it + buffer.Width(); it != end; ++it)
-			{
-				uint64_t value = *it;
-				uint64_t alpha = (value & 0xFF000000) >> 24;
 
-				uint64_t red = (((value & 0xFF0000) * alpha) / 255) & 0xFF0000;
-				uint64_t green = (((value & 0xFF00) * alpha) / 255) & 0xFF00;
-				uint64_t blue = (((value & 0xFF) * alpha) / 255) & 0xFF;
 
-				value = red | green | blue;
-				if(additive == 1)
-					alpha >>= 2;
-				if(additive != 2)
-					value |= (alpha << 24);
+	void PremultiplyRow(uint32_t *it, uint32_t *end, int additive)
+	{
+#ifdef __SSE2__
+		for( ; end - it >= 4; it += 4)
+		{
+			__m128i *block = reinterpret_cast<__m128i *>(it);
+			_mm_storeu_si128(block, PremultiplyPixels(_mm_loadu_si128(block), additive));
+		}
+#endif
+		for( ; it != end; ++it)
+			*it = PremultiplyPixel(*it, additive);
+	}
+
+
 
-				*it = static_cast<uint32_t>(value);
+	// Average each 2x2 block of pixels from the two given rows, which are twice
+	// as wide as the output, rounding to the nearest value.
+	void ShrinkRow(const uint32_t *a, const uint32_t *b, uint32_t *out, int width)
+	{
+		uint32_t *end = out + width;
+#ifdef __SSE2__
+		for( ; end - out >= 4; a += 8, b += 8, out += 4)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			__m128i sum[2];
+			for(int i = 0; i < 2; ++i)
+			{
+				__m128i aPixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + 4 * i));
+				__m128i bPixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + 4 * i));
+				__m128i low = _mm_add_epi16(_mm_unpacklo_epi8(aPixels, zero), _mm_unpacklo_epi8(bPixels, zero));
+				__m128i high = _mm_add_epi16(_mm_unpackhi_epi8(aPixels, zero), _mm_unpackhi_epi8(bPixels, zero));
+				sum[i] = _mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+				sum[i] = _mm_srli_epi16(_mm_add_epi16(sum[i], _mm_set1_epi16(2)), 2);
 			}
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(sum[0], sum[1]));
+		}
+#endif
+		const unsigned char *aIt = reinterpret_cast<const unsigned char *>(a);
+		const unsigned char *bIt = reinterpret_cast<const unsigned char *>(b);
+		unsigned char *outIt = reinterpret_cast<unsigned char *>(out);
+		unsigned char *outEnd = reinterpret_cast<unsigned char *>(end);
+		for( ; outIt != outEnd; aIt += 4, bIt += 4)
+		{
+			for(int channel = 0; channel < 4; ++channel, ++aIt, ++bIt, ++outIt)
+				*outIt = (static_cast<unsigned>(aIt[0]) + static_cast<unsigned>(bIt[0])
+					+ static_cast<unsigned>(aIt[4]) + static_cast<unsigned>(bIt[4]) + 2) / 4;
 		}
 	}
 }
@@ -53,7 +53,12 @@ public:
 	const uint32_t *Begin(int y, int frame = 0) const;
 	uint32_t *Begin(int y, int frame = 0);
 
+	// Halve the size of every frame, averaging each 2x2 block of pixels.
 	void ShrinkToHalfSize();
+	// Convert the given frame to premultiplied alpha. If "additive" is 1, the
+	// alpha is also reduced to a quarter, for half-additive blending; if it is 2,
+	// the alpha is cleared, for additive blending.
+	void Premultiply(int frame, int additive = 0);
 
 	// Read a single frame. Return false if an error is encountered - either the
 	// image is the wrong size, or it is not a supported image format.
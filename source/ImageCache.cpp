@@ -0,0 +1,316 @@
+/* ImageCache.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "ImageCache.h"
+
+#include "File.h"
+#include "Files.h"
+#include "ImageBuffer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <new>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	// Each cache file starts with this header, followed by the path of the image
+	// that it holds, padded to a multiple of four bytes. The rest of the file is
+	// the pixel data of the image, stored as a series of runs: the number of
+	// fully transparent pixels, the number of pixels that follow, and then those
+	// pixels. Most sprites have a lot of empty space around them, so this makes
+	// the files much smaller, while still being trivial to decode.
+	struct Header {
+		char magic[4] = {'E', 'S', 'I', 'C'};
+		uint32_t version = 1;
+		int64_t timestamp = 0;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t pathLength = 0;
+		uint32_t runs = 0;
+	};
+	const Header CURRENT;
+
+	// Temporary files older than this were left behind by a crash.
+	const time_t ABANDONED_AGE = 600;
+
+	string cacheFolder;
+	bool isEnabled = false;
+	// Once the cache grows past this size, the least recently used entries are removed.
+	uint64_t maxCacheSize = ImageCache::DEFAULT_MAX_SIZE;
+
+
+
+	bool IsEnabled()
+	{
+		return isEnabled && !cacheFolder.empty();
+	}
+
+
+
+	string CachePath(const string &path)
+	{
+		// Use the FNV-1a hash of the image's path as the file name. The header
+		// holds the full path, so collisions are detected when reading.
+		uint64_t hash = 14695981039346656037ull;
+		for(char c : path)
+		{
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 1099511628211ull;
+		}
+		char name[24];
+		snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+		return cacheFolder + name;
+	}
+
+
+
+	size_t Padded(size_t length)
+	{
+		return (length + 3) & ~static_cast<size_t>(3);
+	}
+
+
+
+	// Check if the given cache file holds an up-to-date copy of the image it was
+	// made from. If so, get the size of the file.
+	bool IsCurrent(const string &cachePath, uint64_t &size)
+	{
+		File file(cachePath);
+		if(!file)
+			return false;
+
+		Header header;
+		if(fread(&header, sizeof(header), 1, file) != 1)
+			return false;
+		if(memcmp(header.magic, CURRENT.magic, sizeof(header.magic)) || header.version != CURRENT.version)
+			return false;
+		string path(header.pathLength, '\0');
+		if(header.pathLength > 0x10000 || fread(&path[0], 1, path.length(), file) != path.length())
+			return false;
+		if(CachePath(path) != cachePath || !Files::Exists(path) || Files::Timestamp(path) != header.timestamp)
+			return false;
+
+		if(fseek(file, 0, SEEK_END))
+			return false;
+		long end = ftell(file);
+		if(end < 0)
+			return false;
+		size = static_cast<uint64_t>(end);
+		return true;
+	}
+}
+
+
+
+// Set the folder to keep the cache in, whether to use it, and how large it
+// may grow. This must be done before any images are loaded, so that every
+// loading thread sees the same settings.
+void ImageCache::Init(const string &folder, bool enabled, uint64_t maxSize)
+{
+	cacheFolder = folder;
+	isEnabled = enabled;
+	maxCacheSize = maxSize;
+	if(IsEnabled())
+		Files::CreateFolder(cacheFolder);
+}
+
+
+
+// Fill in the given frame of the buffer from the cache, if it has an
+// up-to-date copy of the given image file. Return false if the image must
+// be decoded instead.
+bool ImageCache::Read(const string &path, ImageBuffer &buffer, int frame)
+{
+	if(!IsEnabled())
+		return false;
+
+	string cachePath = CachePath(path);
+	File file(cachePath);
+	if(!file)
+		return false;
+
+	Header header;
+	if(fread(&header, sizeof(header), 1, file) != 1)
+		return false;
+	if(memcmp(header.magic, CURRENT.magic, sizeof(header.magic)) || header.version != CURRENT.version)
+		return false;
+	if(header.timestamp != Files::Timestamp(path) || header.pathLength != path.length())
+		return false;
+	if(!header.width || !header.height || header.width > 0x8000 || header.height > 0x8000)
+		return false;
+
+	// Read everything after the header in one go. An entry is never larger than
+	// the raw pixel data, plus the path and two words for each run.
+	string data = Files::Read(file);
+	size_t pixelCount = static_cast<size_t>(header.width) * header.height;
+	size_t start = Padded(header.pathLength);
+	if(data.size() < start || data.size() - start > 4 * (pixelCount + 2 * header.runs))
+		return false;
+	if(data.compare(0, path.length(), path))
+		return false;
+
+	try {
+		buffer.Allocate(header.width, header.height);
+	}
+	catch(const bad_alloc &)
+	{
+		return false;
+	}
+	// If this frame does not match the others, let the decoder report the error.
+	if(static_cast<uint32_t>(buffer.Width()) != header.width || static_cast<uint32_t>(buffer.Height()) != header.height)
+		return false;
+
+	const char *it = data.data() + start;
+	const char *end = data.data() + data.size();
+	uint32_t *out = buffer.Begin(0, frame);
+	uint32_t *outEnd = out + pixelCount;
+	for(uint32_t i = 0; i < header.runs; ++i)
+	{
+		uint32_t run[2];
+		if(end - it < static_cast<ptrdiff_t>(sizeof(run)))
+			return false;
+		memcpy(run, it, sizeof(run));
+		it += sizeof(run);
+		if(run[0] > static_cast<size_t>(outEnd - out) || run[1] > static_cast<size_t>(outEnd - out) - run[0]
+				|| 4 * static_cast<size_t>(run[1]) > static_cast<size_t>(end - it))
+			return false;
+		memset(out, 0, 4 * static_cast<size_t>(run[0]));
+		out += run[0];
+		memcpy(out, it, 4 * static_cast<size_t>(run[1]));
+		out += run[1];
+		it += 4 * static_cast<size_t>(run[1]);
+	}
+	if(out != outEnd || it != end)
+		return false;
+
+	// Mark this entry as recently used, so that pruning the cache keeps it.
+	Files::SetTimestamp(cachePath, time(nullptr));
+	return true;
+}
+
+
+
+// Store the given frame of the buffer, which was just decoded from the
+// given image file.
+void ImageCache::Write(const string &path, const ImageBuffer &buffer, int frame)
+{
+	if(!IsEnabled() || !buffer.Pixels())
+		return;
+
+	Header header = CURRENT;
+	header.timestamp = Files::Timestamp(path);
+	header.width = buffer.Width();
+	header.height = buffer.Height();
+	header.pathLength = path.length();
+
+	string data(sizeof(header), '\0');
+	data += path;
+	data.resize(sizeof(header) + Padded(path.length()), '\0');
+	// Split the pixels into runs of transparent pixels and of everything else.
+	// Short gaps are not worth starting a new run for.
+	static const size_t MIN_GAP = 8;
+	const uint32_t *it = buffer.Begin(0, frame);
+	const uint32_t *end = it + static_cast<size_t>(header.width) * header.height;
+	while(it != end)
+	{
+		const uint32_t *first = it;
+		while(it != end && !*it)
+			++it;
+		const uint32_t *last = it;
+		for(const uint32_t *gap = it; gap != end; )
+		{
+			if(*gap++)
+				last = gap;
+			else if(static_cast<size_t>(gap - last) >= MIN_GAP)
+				break;
+		}
+		uint32_t run[2] = {static_cast<uint32_t>(it - first), static_cast<uint32_t>(last - it)};
+		data.append(reinterpret_cast<const char *>(run), sizeof(run));
+		data.append(reinterpret_cast<const char *>(it), 4 * static_cast<size_t>(run[1]));
+		it = last;
+		++header.runs;
+	}
+	memcpy(&data[0], &header, sizeof(header));
+
+	// Write to a temporary file first, so that other threads or another copy of
+	// the game never see a partially written entry.
+	string cachePath = CachePath(path);
+	string temporary = cachePath + "." + to_string(hash<thread::id>()(this_thread::get_id())) + ".tmp";
+	{
+		File file(temporary, true);
+		if(!file)
+			return;
+		Files::Write(file, data);
+	}
+	Files::Move(temporary, cachePath);
+}
+
+
+
+// Remove the entries for images that have been edited or removed since
+// they were cached, and then the least recently used entries, until the
+// cache fits in its size limit. If the cache is turned off, remove every
+// entry. This should only be called once all the images have been loaded.
+void ImageCache::Prune()
+{
+	if(cacheFolder.empty() || !Files::Exists(cacheFolder))
+		return;
+
+	struct Entry {
+		time_t timestamp;
+		uint64_t size;
+		string path;
+	};
+	vector<Entry> entries;
+	uint64_t totalSize = 0;
+	const time_t now = time(nullptr);
+	for(const string &path : Files::List(cacheFolder))
+	{
+		// Leave temporary files alone unless they have been abandoned, since a
+		// sprite that is being reloaded may be writing to one right now.
+		bool isTemporary = path.length() > 4 && !path.compare(path.length() - 4, 4, ".tmp");
+		if(isTemporary && now - Files::Timestamp(path) < ABANDONED_AGE)
+			continue;
+
+		uint64_t size = 0;
+		if(isTemporary || !IsEnabled() || !IsCurrent(path, size))
+			Files::Delete(path);
+		else
+		{
+			// Reading an entry updates its timestamp, so this is when it was last used.
+			entries.push_back({Files::Timestamp(path), size, path});
+			totalSize += size;
+		}
+	}
+	if(totalSize <= maxCacheSize)
+		return;
+
+	sort(entries.begin(), entries.end(),
+		[](const Entry &a, const Entry &b) { return a.timestamp < b.timestamp; });
+	for(const Entry &entry : entries)
+	{
+		if(totalSize <= maxCacheSize)
+			break;
+		Files::Delete(entry.path);
+		totalSize -= entry.size;
+	}
+}
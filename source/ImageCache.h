@@ -0,0 +1,59 @@
+/* ImageCache.h
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef IMAGE_CACHE_H_
+#define IMAGE_CACHE_H_
+
+#include <cstdint>
+#include <string>
+
+class ImageBuffer;
+
+
+
+// Decoding every PNG and JPEG file and converting it to premultiplied alpha
+// takes up most of the time it takes to launch the game. This class keeps a copy
+// of each image's final pixel data in the user's config directory, so that on
+// later launches the images can be read straight into memory instead. Entries
+// are keyed on the image's path and remember its modification time, so editing
+// an image makes the game decode it again. The cache is only used once it has
+// been given a folder and turned on. It is safe to use from several threads at
+// once.
+class ImageCache {
+public:
+	// By default, the cache may grow to this many bytes.
+	static const uint64_t DEFAULT_MAX_SIZE = static_cast<uint64_t>(512) << 20;
+
+	// Set the folder to keep the cache in, whether to use it, and how large it
+	// may grow. This must be done before any images are loaded, so that every
+	// loading thread sees the same settings.
+	static void Init(const std::string &folder, bool enabled, uint64_t maxSize = DEFAULT_MAX_SIZE);
+	// Fill in the given frame of the buffer from the cache, if it has an
+	// up-to-date copy of the given image file. Return false if the image must
+	// be decoded instead.
+	static bool Read(const std::string &path, ImageBuffer &buffer, int frame);
+	// Store the given frame of the buffer, which was just decoded from the
+	// given image file.
+	static void Write(const std::string &path, const ImageBuffer &buffer, int frame);
+	// Remove the entries for images that have been edited or removed since
+	// they were cached, and then the least recently used entries, until the
+	// cache fits in its size limit. If the cache is turned off, remove every
+	// entry. This should only be called once all the images have been loaded.
+	static void Prune();
+};
+
+
+
+#endif
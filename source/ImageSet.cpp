@@ -240,7 +240,7 @@ void ImageSet::Load() noexcept(false)
 	buffer[1].Clear(frames);
 
 	// Check whether we need to generate collision masks.
-	bool makeMasks = IsMasked(name);
+	bool makeMasks = IsMasked(name) && !isUploaded;
 	if(makeMasks)
 		masks.resize(frames);
 
@@ -269,7 +269,7 @@ void ImageSet::Load() noexcept(false)
 
 	// Warn about a "high-profile" image that will be blurry due to rendering at 50% scale.
 	bool willBlur = (buffer[0].Width() & 1) || (buffer[0].Height() & 1);
-	if(willBlur && (
+	if(willBlur && !isUploaded && (
 			(name.length() > 5 && !name.compare(0, 5, "ship/"))
 			|| (name.length() > 7 && !name.compare(0, 7, "outfit/"))
 			|| (name.length() > 10 && !name.compare(0, 10, "thumbnail/"))
@@ -288,6 +288,8 @@ void ImageSet::Upload(Sprite *sprite)
 	// Load the frames (this will clear the buffers).
 	sprite->AddFrames(buffer[0], false);
 	sprite->AddFrames(buffer[1], true);
-	GameData::GetMaskManager().SetMasks(sprite, std::move(masks));
+	if(!isUploaded)
+		GameData::GetMaskManager().SetMasks(sprite, std::move(masks));
 	masks.clear();
+	isUploaded = true;
 }
@@ -76,6 +76,9 @@ private:
 	// Data loaded from the images:
 	ImageBuffer buffer[2];
 	std::vector<Mask> masks;
+	// Whether the images have been uploaded before. If so, the sprite already
+	// has its masks, so they are not generated again.
+	bool isUploaded = false;
 };
 
 
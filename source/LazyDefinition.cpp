@@ -0,0 +1,98 @@
+/* LazyDefinition.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "LazyDefinition.h"
+
+#include <mutex>
+
+using namespace std;
+
+namespace {
+	// Parsing one definition often requires parsing another (e.g. a phrase that
+	// refers to other phrases), so the lock must be reentrant. Resolving is rare
+	// enough that a single lock shared by all definitions is not a bottleneck.
+	recursive_mutex resolveMutex;
+}
+
+
+
+LazyDefinition::LazyDefinition(const LazyDefinition &other)
+{
+	*this = other;
+}
+
+
+
+LazyDefinition &LazyDefinition::operator=(const LazyDefinition &other)
+{
+	if(this != &other)
+	{
+		lock_guard<recursive_mutex> lock(resolveMutex);
+		nodes = other.nodes;
+		isPending.store(!nodes.empty(), memory_order_release);
+	}
+	return *this;
+}
+
+
+
+void LazyDefinition::Add(const DataNode &node)
+{
+	lock_guard<recursive_mutex> lock(resolveMutex);
+	nodes.push_back(node);
+	isPending.store(true, memory_order_release);
+}
+
+
+
+void LazyDefinition::Clear()
+{
+	lock_guard<recursive_mutex> lock(resolveMutex);
+	nodes.clear();
+	// If the definition is being parsed right now, other threads must keep
+	// waiting until that is done.
+	if(!isResolving)
+		isPending.store(false, memory_order_release);
+}
+
+
+
+bool LazyDefinition::IsPending() const noexcept
+{
+	return isPending.load(memory_order_acquire);
+}
+
+
+
+void LazyDefinition::Resolve(const function<void(const DataNode &)> &load) const
+{
+	if(!IsPending())
+		return;
+
+	lock_guard<recursive_mutex> lock(resolveMutex);
+	// If the nodes are gone, either another thread finished resolving them while
+	// this one waited for the lock, or this thread is in the middle of resolving
+	// them and has looped back around to this definition.
+	if(nodes.empty())
+		return;
+
+	list<DataNode> toLoad;
+	toLoad.swap(nodes);
+	isResolving = true;
+	for(const DataNode &node : toLoad)
+		load(node);
+	isResolving = false;
+	isPending.store(!nodes.empty(), memory_order_release);
+}
@@ -0,0 +1,58 @@
+/* LazyDefinition.h
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LAZY_DEFINITION_H_
+#define LAZY_DEFINITION_H_
+
+#include "DataNode.h"
+
+#include <atomic>
+#include <functional>
+#include <list>
+
+
+
+// Class holding the raw data nodes that define a game object whose parsing has
+// been postponed until the first time the object is actually used. Most missions,
+// conversations, phrases and the like are never used in any given session, so
+// keeping only a copy of their definitions saves both loading time and memory.
+// Resolving a definition is thread-safe, and only ever happens once.
+class LazyDefinition {
+public:
+	LazyDefinition() = default;
+	LazyDefinition(const LazyDefinition &other);
+	LazyDefinition &operator=(const LazyDefinition &other);
+
+	// Remember the given node so it can be parsed later.
+	void Add(const DataNode &node);
+	// Forget any nodes that have not been parsed yet.
+	void Clear();
+
+	// Check if there are any nodes that still need to be parsed.
+	bool IsPending() const noexcept;
+	// Pass every stored node, in the order they were added, to the given function.
+	// If another thread is already doing so, wait until it is done instead.
+	void Resolve(const std::function<void(const DataNode &)> &load) const;
+
+
+private:
+	mutable std::list<DataNode> nodes;
+	mutable std::atomic<bool> isPending{false};
+	mutable bool isResolving = false;
+};
+
+
+
+#endif
@@ -35,6 +35,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "PlayerInfo.h"
 #include "Preferences.h"
 #include "Rectangle.h"
+#include "SaveJournal.h"
 #include "ShipyardPanel.h"
 #include "StarField.h"
 #include "StartConditionsPanel.h"
@@ -71,7 +72,8 @@ namespace {
 	string FileDate(const string &filename)
 	{
 		string date = "0000-00-00";
-		DataFile file(filename);
+		DataFile file;
+		SaveJournal::Load(filename, file);
 		for(const DataNode &node : file)
 			if(node.Token(0) == "date")
 			{
@@ -410,6 +412,9 @@ bool LoadPanel::Scroll(double dx, double dy)
 
 void LoadPanel::UpdateLists()
 {
+	// Make sure the list includes the most recent save, and that no file is
+	// still being written when the player copies or deletes it.
+	PlayerInfo::FinishSaving();
 	files.clear();
 
 	vector<string> fileList = Files::List(Files::Saves());
@@ -485,7 +490,7 @@ void LoadPanel::SnapshotCallback(const string &name)
 void LoadPanel::WriteSnapshot(const string &sourceFile, const string &snapshotName)
 {
 	// Copy the autosave to a new, named file.
-	Files::Copy(sourceFile, snapshotName);
+	SaveJournal::Copy(sourceFile, snapshotName);
 	if(Files::Exists(snapshotName))
 	{
 		UpdateLists();
@@ -531,7 +536,7 @@ void LoadPanel::DeletePilot(const string &)
 	for(const auto &fit : it->second)
 	{
 		string path = Files::Saves() + fit.first;
-		Files::Delete(path);
+		SaveJournal::Delete(path);
 		failed |= Files::Exists(path);
 	}
 	if(failed)
@@ -550,7 +555,7 @@ void LoadPanel::DeleteSave()
 	loadedInfo.Clear();
 	string pilot = selectedPilot;
 	string path = Files::Saves() + selectedFile;
-	Files::Delete(path);
+	SaveJournal::Delete(path);
 	if(Files::Exists(path))
 		GetUI()->Push(new Dialog("Deleting snapshot file failed."));
 
@@ -28,11 +28,71 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "System.h"
 
 #include <algorithm>
+#include <limits>
 #include <mutex>
 
 using namespace std;
 
 namespace {
+	// A filter that has been checked this many times without precalculated
+	// matches is probably going to be checked again, so it is worth finding all
+	// of its matches at once. A filter that picks a random planet or system has
+	// to check them all anyway, so it always stores its matches.
+	const int QUERIES_BEFORE_CACHING = 16;
+
+	// Every valid planet and system, in the order they are listed in GameData,
+	// so that picking a random one from a filter's precalculated matches gives
+	// the same result as checking each of them in turn.
+	class UniverseIndex {
+	public:
+		unsigned epoch = 0;
+		vector<const Planet *> planets;
+		vector<const System *> systems;
+		// The position of each planet and system in the lists above, indexed by
+		// Planet::Index() or System::Index().
+		vector<size_t> planetPositions;
+		vector<size_t> systemPositions;
+	};
+	const size_t NOT_LISTED = numeric_limits<size_t>::max();
+
+	// This is incremented every time the universe changes, making all the
+	// precalculated matches out of date.
+	atomic<unsigned> cacheEpoch{0};
+	shared_ptr<const UniverseIndex> universeIndex;
+	mutex universeMutex;
+
+	shared_ptr<const UniverseIndex> GetUniverseIndex()
+	{
+		lock_guard<mutex> lock(universeMutex);
+		if(universeIndex && universeIndex->epoch == cacheEpoch)
+			return universeIndex;
+
+		shared_ptr<UniverseIndex> index = make_shared<UniverseIndex>();
+		index->epoch = cacheEpoch;
+		index->planetPositions.resize(Planet::IndexCount(), NOT_LISTED);
+		for(const auto &it : GameData::Planets())
+			if(it.second.IsValid())
+			{
+				index->planetPositions[it.second.Index()] = index->planets.size();
+				index->planets.push_back(&it.second);
+			}
+		index->systemPositions.resize(System::IndexCount(), NOT_LISTED);
+		for(const auto &it : GameData::Systems())
+			if(it.second.IsValid())
+			{
+				index->systemPositions[it.second.Index()] = index->systems.size();
+				index->systems.push_back(&it.second);
+			}
+		universeIndex = index;
+		return index;
+	}
+
+	// Find where the given planet or system is in the index.
+	size_t Position(const vector<size_t> &positions, size_t index)
+	{
+		return index < positions.size() ? positions[index] : NOT_LISTED;
+	}
+
 	bool SetsIntersect(const set<string> &a, const set<string> &b)
 	{
 		// Quickest way to find out if two sets contain common elements: iterate
@@ -72,23 +132,8 @@ namespace {
 	// Check if the given system is within the given distance of the center.
 	int Distance(const System *center, const System *system, int maximum)
 	{
-		// This function should only ever be called from the main thread, but
-		// just to be sure, use mutex protection on the static locals.
-		static mutex distanceMutex;
-		lock_guard<mutex> lock(distanceMutex);
-
-		static const System *previousCenter = center;
-		static DistanceMap distance(center, -1, maximum);
-		static int previousMaximum = maximum;
-
-		if(center != previousCenter || maximum > previousMaximum)
-		{
-			previousCenter = center;
-			previousMaximum = maximum;
-			distance = DistanceMap(center, -1, maximum);
-		}
 		// If the distance is greater than the maximum, this is not a match.
-		int d = distance.Days(system);
+		int d = DistanceMap::Cached(center, -1, maximum)->Days(system);
 		return (d > maximum) ? -1 : d;
 	}
 
@@ -145,6 +190,38 @@ namespace {
 
 
 
+// Which planets or systems a filter matched, as of the given universe index.
+class LocationFilter::MatchBits {
+public:
+	shared_ptr<const UniverseIndex> universe;
+	// If the filter's "not" or "neighbor" filters depend on the origin, its
+	// matches cannot be calculated ahead of time.
+	bool isUsable = false;
+	// Whether each planet or system matches, by its position in the index.
+	vector<bool> matches;
+	// The positions of all the matches, in order.
+	vector<size_t> positions;
+};
+
+
+
+LocationFilter::MatchCache::MatchCache(const MatchCache &) noexcept
+{
+}
+
+
+
+LocationFilter::MatchCache &LocationFilter::MatchCache::operator=(const MatchCache &) noexcept
+{
+	atomic_store(&planets, shared_ptr<const MatchBits>());
+	atomic_store(&systems, shared_ptr<const MatchBits>());
+	planetQueries = 0;
+	systemQueries = 0;
+	return *this;
+}
+
+
+
 // Construct and Load() at the same time.
 LocationFilter::LocationFilter(const DataNode &node)
 {
@@ -316,35 +393,48 @@ bool LocationFilter::IsValid() const
 
 
 
-// If the player is in the given system, does this filter match?
-bool LocationFilter::Matches(const Planet *planet, const System *origin) const
+// Get the planets, systems and governments that a matching planet must be
+// one of, and the sets of attributes it must have at least one of each.
+const set<const Planet *> &LocationFilter::Planets() const
 {
-	if(!planet || !planet->IsValid())
-		return false;
+	return planets;
+}
 
-	// If a ship class was given, do not match planets.
-	if(!shipCategory.empty())
-		return false;
 
-	if(!governments.empty() && !governments.count(planet->GetGovernment()))
-		return false;
 
-	if(!planets.empty() && !planets.count(planet))
-		return false;
-	for(const set<string> &attr : attributes)
-		if(!SetsIntersect(attr, planet->Attributes()))
-			return false;
+const set<const System *> &LocationFilter::Systems() const
+{
+	return systems;
+}
 
-	for(const LocationFilter &filter : notFilters)
-		if(filter.Matches(planet, origin))
-			return false;
 
-	// If outfits are specified, make sure they can be bought here.
-	for(const set<const Outfit *> &outfitList : outfits)
-		if(!SetsIntersect(outfitList, planet->Outfitter()))
-			return false;
 
-	return Matches(planet->GetSystem(), origin, true);
+const set<const Government *> &LocationFilter::Governments() const
+{
+	return governments;
+}
+
+
+
+const list<set<string>> &LocationFilter::Attributes() const
+{
+	return attributes;
+}
+
+
+
+// If the player is in the given system, does this filter match?
+bool LocationFilter::Matches(const Planet *planet, const System *origin) const
+{
+	if(!planet || !planet->IsValid())
+		return false;
+
+	shared_ptr<const MatchBits> bits = GetMatches(true, false);
+	size_t position = bits ? Position(bits->universe->planetPositions, planet->Index()) : NOT_LISTED;
+	if(position != NOT_LISTED)
+		return bits->matches[position] && MatchesDistance(planet->GetSystem(), origin);
+
+	return CheckPlanet(planet, origin);
 }
 
 
@@ -352,9 +442,14 @@ bool LocationFilter::Matches(const Planet *planet, const System *origin) const
 bool LocationFilter::Matches(const System *system, const System *origin) const
 {
 	// If a ship class was given, do not match systems.
-	if(!shipCategory.empty())
+	if(!shipCategory.empty() || !system)
 		return false;
 
+	shared_ptr<const MatchBits> bits = GetMatches(false, false);
+	size_t position = bits ? Position(bits->universe->systemPositions, system->Index()) : NOT_LISTED;
+	if(position != NOT_LISTED)
+		return bits->matches[position] && MatchesDistance(system, origin);
+
 	return Matches(system, origin, false);
 }
 
@@ -447,17 +542,28 @@ LocationFilter LocationFilter::SetOrigin(const System *origin) const
 // Pick a random system that matches this filter, based on the given origin.
 const System *LocationFilter::PickSystem(const System *origin) const
 {
-	// Find a planet that satisfies the filter.
+	// Find a system that satisfies the filter.
 	vector<const System *> options;
-	for(const auto &it : GameData::Systems())
+	shared_ptr<const MatchBits> bits = GetMatches(false, true);
+	if(bits)
 	{
-		const System &system = it.second;
-		// Skip systems with incomplete data or that are inaccessible.
-		if(!system.IsValid() || system.Inaccessible())
-			continue;
-		if(Matches(&system, origin))
-			options.push_back(&system);
+		for(size_t position : bits->positions)
+		{
+			const System *system = bits->universe->systems[position];
+			if(!system->Inaccessible() && MatchesDistance(system, origin))
+				options.push_back(system);
+		}
 	}
+	else
+		for(const auto &it : GameData::Systems())
+		{
+			const System &system = it.second;
+			// Skip systems with incomplete data or that are inaccessible.
+			if(!system.IsValid() || system.Inaccessible())
+				continue;
+			if(Matches(&system, origin))
+				options.push_back(&system);
+		}
 	return options.empty() ? nullptr : options[Random::Int(options.size())];
 }
 
@@ -466,21 +572,38 @@ const System *LocationFilter::PickSystem(const System *origin) const
 // Pick a random planet that matches this filter, based on the given origin.
 const Planet *LocationFilter::PickPlanet(const System *origin, bool hasClearance, bool requireSpaceport) const
 {
-	// Find a planet that satisfies the filter.
-	vector<const Planet *> options;
-	for(const auto &it : GameData::Planets())
+	// Skip planets with incomplete data or which are from inaccessible systems.
+	// Also skip those that do not offer special jobs or missions, unless they
+	// were explicitly listed as options.
+	auto isCandidate = [this, hasClearance, requireSpaceport](const Planet &planet) -> bool
 	{
-		const Planet &planet = it.second;
-		// Skip planets with incomplete data or which are from inaccessible systems.
-		if(!planet.IsValid() || (planet.GetSystem() && planet.GetSystem()->Inaccessible()))
-			continue;
-		// Skip planets that do not offer special jobs or missions, unless they were explicitly listed as options.
+		if(planet.GetSystem() && planet.GetSystem()->Inaccessible())
+			return false;
 		if(planet.IsWormhole() || (requireSpaceport && !planet.HasSpaceport()) || (!hasClearance && !planet.CanLand()))
 			if(planets.empty() || !planets.count(&planet))
-				continue;
-		if(Matches(&planet, origin))
-			options.push_back(&planet);
+				return false;
+		return true;
+	};
+
+	// Find a planet that satisfies the filter.
+	vector<const Planet *> options;
+	shared_ptr<const MatchBits> bits = GetMatches(true, true);
+	if(bits)
+	{
+		for(size_t position : bits->positions)
+		{
+			const Planet *planet = bits->universe->planets[position];
+			if(isCandidate(*planet) && MatchesDistance(planet->GetSystem(), origin))
+				options.push_back(planet);
+		}
 	}
+	else
+		for(const auto &it : GameData::Planets())
+		{
+			const Planet &planet = it.second;
+			if(planet.IsValid() && isCandidate(planet) && Matches(&planet, origin))
+				options.push_back(&planet);
+		}
 	return options.empty() ? nullptr : options[Random::Int(options.size())];
 }
 
@@ -620,9 +743,103 @@ bool LocationFilter::Matches(const System *system, const System *origin, bool di
 	// Check this system's distance from the desired reference system.
 	if(center && Distance(center, system, centerMaxDistance) < centerMinDistance)
 		return false;
-	if(origin && originMaxDistance >= 0
-			&& Distance(origin, system, originMaxDistance) < originMinDistance)
+
+	return MatchesDistance(system, origin);
+}
+
+
+
+// Check if the given planet matches, without using the precalculated matches.
+bool LocationFilter::CheckPlanet(const Planet *planet, const System *origin) const
+{
+	// If a ship class was given, do not match planets.
+	if(!shipCategory.empty())
 		return false;
 
-	return true;
+	if(!governments.empty() && !governments.count(planet->GetGovernment()))
+		return false;
+
+	if(!planets.empty() && !planets.count(planet))
+		return false;
+	for(const set<string> &attr : attributes)
+		if(!SetsIntersect(attr, planet->Attributes()))
+			return false;
+
+	for(const LocationFilter &filter : notFilters)
+		if(filter.Matches(planet, origin))
+			return false;
+
+	// If outfits are specified, make sure they can be bought here.
+	for(const set<const Outfit *> &outfitList : outfits)
+		if(!SetsIntersect(outfitList, planet->Outfitter()))
+			return false;
+
+	return Matches(planet->GetSystem(), origin, true);
+}
+
+
+
+shared_ptr<const LocationFilter::MatchBits> LocationFilter::GetMatches(bool ofPlanets, bool force) const
+{
+	shared_ptr<const MatchBits> &slot = ofPlanets ? cache.planets : cache.systems;
+	shared_ptr<const MatchBits> bits = atomic_load(&slot);
+	if(bits && bits->universe->epoch == cacheEpoch)
+		return bits->isUsable ? bits : nullptr;
+	// If this filter had matches calculated before the universe changed, it is
+	// likely to be used again. Otherwise, wait until it has been used a few times.
+	atomic<int> &queries = ofPlanets ? cache.planetQueries : cache.systemQueries;
+	if(!bits && !force && ++queries < QUERIES_BEFORE_CACHING)
+		return nullptr;
+
+	// Calculate the matches without holding any lock, because checking the
+	// "not" and "neighbor" filters may require calculating their matches too.
+	// If two threads do this at once, they will both get the same result.
+	shared_ptr<MatchBits> result = make_shared<MatchBits>();
+	result->universe = GetUniverseIndex();
+	result->isUsable = UsesOriginOnlyForDistance();
+	if(result->isUsable)
+	{
+		size_t count = ofPlanets ? result->universe->planets.size() : result->universe->systems.size();
+		result->matches.resize(count);
+		for(size_t i = 0; i < count; ++i)
+		{
+			if(ofPlanets)
+				result->matches[i] = CheckPlanet(result->universe->planets[i], nullptr);
+			else
+				result->matches[i] = shipCategory.empty() && Matches(result->universe->systems[i], nullptr, false);
+			if(result->matches[i])
+				result->positions.push_back(i);
+		}
+	}
+	atomic_store(&slot, shared_ptr<const MatchBits>(result));
+	return result->isUsable ? result : nullptr;
+}
+
+
+
+bool LocationFilter::UsesOriginOnlyForDistance() const
+{
+	auto usesOrigin = [](const LocationFilter &filter) -> bool
+	{
+		return filter.originMaxDistance >= 0 || !filter.UsesOriginOnlyForDistance();
+	};
+	return none_of(notFilters.begin(), notFilters.end(), usesOrigin)
+		&& none_of(neighborFilters.begin(), neighborFilters.end(), usesOrigin);
+}
+
+
+
+bool LocationFilter::MatchesDistance(const System *system, const System *origin) const
+{
+	return !origin || originMaxDistance < 0 || Distance(origin, system, originMaxDistance) >= originMinDistance;
+}
+
+
+
+// Forget which planets and systems each filter was found to match.
+void LocationFilter::ClearCache()
+{
+	lock_guard<mutex> lock(universeMutex);
+	++cacheEpoch;
+	universeIndex.reset();
 }
@@ -16,7 +16,9 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #ifndef LOCATION_FILTER_H_
 #define LOCATION_FILTER_H_
 
+#include <atomic>
 #include <list>
+#include <memory>
 #include <set>
 #include <string>
 
@@ -50,6 +52,14 @@ public:
 	bool IsEmpty() const;
 	bool IsValid() const;
 
+	// Get the planets, systems and governments that a matching planet must be
+	// one of, and the sets of attributes it must have at least one of each.
+	// An empty set means that the filter does not limit that property.
+	const std::set<const Planet *> &Planets() const;
+	const std::set<const System *> &Systems() const;
+	const std::set<const Government *> &Governments() const;
+	const std::list<std::set<std::string>> &Attributes() const;
+
 	// If the player is in the given system, does this filter match?
 	bool Matches(const Planet *planet, const System *origin = nullptr) const;
 	bool Matches(const System *system, const System *origin = nullptr) const;
@@ -65,6 +75,10 @@ public:
 	const System *PickSystem(const System *origin) const;
 	const Planet *PickPlanet(const System *origin, bool hasClearance = false, bool requireSpaceport = true) const;
 
+	// Forget which planets and systems each filter was found to match. This
+	// must be done whenever planets or systems may have changed.
+	static void ClearCache();
+
 
 private:
 	// Load one particular line of conditions.
@@ -73,6 +87,36 @@ private:
 	// only if the filter wasn't looking for planet characteristics or if the
 	// didPlanet argument is set (meaning we already checked those).
 	bool Matches(const System *system, const System *origin, bool didPlanet) const;
+	// Check if the given valid planet matches, without using precalculated matches.
+	bool CheckPlanet(const Planet *planet, const System *origin) const;
+
+	// A record of which planets or systems this filter matches, ignoring any
+	// "distance" from the origin.
+	class MatchBits;
+	// Get a record of the planets or systems that this filter matches, if it
+	// is used often enough to be worth calculating one. Otherwise, return null.
+	std::shared_ptr<const MatchBits> GetMatches(bool ofPlanets, bool force) const;
+	// Check if the origin only affects this filter's own "distance" limits.
+	bool UsesOriginOnlyForDistance() const;
+	// Check if the given system is within this filter's "distance" limits.
+	bool MatchesDistance(const System *system, const System *origin) const;
+
+	// The cached matches are not copied along with the filter, because a copy
+	// is usually made in order to modify it.
+	class MatchCache {
+	public:
+		MatchCache() noexcept = default;
+		MatchCache(const MatchCache &) noexcept;
+		MatchCache &operator=(const MatchCache &) noexcept;
+
+	public:
+		// These are only read or written using std::atomic_load and atomic_store.
+		std::shared_ptr<const MatchBits> planets;
+		std::shared_ptr<const MatchBits> systems;
+		// How many queries were answered without precalculated matches.
+		std::atomic<int> planetQueries{0};
+		std::atomic<int> systemQueries{0};
+	};
 
 
 private:
@@ -104,6 +148,8 @@ private:
 	std::list<LocationFilter> notFilters;
 	// These filters store all the things the planet or system must border.
 	std::list<LocationFilter> neighborFilters;
+
+	mutable MatchCache cache;
 };
 
 
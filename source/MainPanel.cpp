@@ -66,6 +66,20 @@ void MainPanel::Step()
 {
 	engine.Wait();
 
+	// Collisions, AI, and landing depend on the sizes and collision masks of
+	// the sprites, so the simulation cannot start until the sprites of the
+	// player's ships and of everything around them have been loaded.
+	if(isLoadingSprites)
+	{
+		isLoadingSprites = !GameData::ArePrioritySpritesLoaded();
+		if(isLoadingSprites)
+		{
+			canClick = false;
+			canDrag = false;
+			return;
+		}
+	}
+
 	// Depending on what UI element is on top, the game is "paused." This
 	// checks only already-drawn panels.
 	bool isActive = GetUI()->IsTop(this);
@@ -152,6 +166,15 @@ void MainPanel::Draw()
 	FrameTimer loadTimer;
 	glClear(GL_COLOR_BUFFER_BIT);
 
+	// Until the simulation has started, there is nothing for the engine to draw.
+	if(isLoadingSprites)
+	{
+		const Font &font = FontSet::Get(18);
+		const string text = "Loading...";
+		font.Draw(text, Point(-.5 * font.Width(text), -.5 * font.Height()), *GameData::Colors().Get("medium"));
+		return;
+	}
+
 	engine.Draw();
 
 	if(isDragging)
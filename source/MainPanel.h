@@ -92,6 +92,8 @@ private:
 	bool isDragging = false;
 	bool hasShift = false;
 	bool hasControl = false;
+	// Whether the simulation is still waiting for sprites it needs to load.
+	bool isLoadingSprites = true;
 	bool canClick = false;
 	bool canDrag = false;
 };
@@ -28,6 +28,27 @@ namespace {
 	{
 		return to_string(100. * s) + "%";
 	}
+
+	// Create any of the given scaled masks that are missing from the 1x masks.
+	// Each list of masks is filled in all at once, so that another thread that
+	// finds it not empty can safely use it.
+	void Scale(map<double, vector<Mask>> &scales)
+	{
+		auto baseIt = scales.find(DEFAULT);
+		if(baseIt == scales.end() || baseIt->second.empty())
+			return;
+
+		const auto &baseMasks = baseIt->second;
+		for(auto &it : scales)
+			if(it.second.empty())
+			{
+				vector<Mask> masks;
+				masks.reserve(baseMasks.size());
+				for(auto &&mask : baseMasks)
+					masks.push_back(mask * it.first);
+				it.second.swap(masks);
+			}
+	}
 }
 
 
@@ -42,6 +63,8 @@ void MaskManager::SetMasks(const Sprite *sprite, vector<Mask> &&masks)
 		it->second.swap(masks);
 	else
 		scales.emplace(DEFAULT, std::move(masks));
+	if(isScaled)
+		Scale(scales);
 }
 
 
@@ -53,7 +76,11 @@ void MaskManager::RegisterScale(const Sprite *sprite, double scale)
 	auto &scales = spriteMasks[sprite];
 	auto lb = scales.lower_bound(scale);
 	if(lb == scales.end() || lb->first != scale)
+	{
 		scales.emplace_hint(lb, scale, vector<Mask>{});
+		if(isScaled)
+			Scale(scales);
+	}
 	else if(!lb->second.empty())
 		Logger::LogError("Collision mask for sprite \"" + sprite->Name() + "\" at scale "
 			+ PrintScale(scale) + " was already generated.");
@@ -64,29 +91,10 @@ void MaskManager::RegisterScale(const Sprite *sprite, double scale)
 // Create the scaled versions of all masks from the 1x versions.
 void MaskManager::ScaleMasks()
 {
+	lock_guard<mutex> lock(spriteMutex);
 	for(auto &spriteScales : spriteMasks)
-	{
-		auto &scales = spriteScales.second;
-		auto baseIt = scales.find(DEFAULT);
-		if(baseIt == scales.end() || baseIt->second.empty())
-			continue;
-
-		const auto &baseMasks = baseIt->second;
-		for(auto it = scales.begin(); it != baseIt; ++it)
-		{
-			auto &masks = it->second;
-			masks.reserve(baseMasks.size());
-			for(auto &&mask : baseMasks)
-				masks.push_back(mask * it->first);
-		}
-		for(auto it = next(baseIt); it != scales.end(); ++it)
-		{
-			auto &masks = it->second;
-			masks.reserve(baseMasks.size());
-			for(auto &&mask : baseMasks)
-				masks.push_back(mask * it->first);
-		}
-	}
+		Scale(spriteScales.second);
+	isScaled = true;
 }
 
 
@@ -96,13 +104,12 @@ void MaskManager::ScaleMasks()
 const std::vector<Mask> &MaskManager::GetMasks(const Sprite *sprite, double scale) const
 {
 	static const vector<Mask> EMPTY;
+	lock_guard<mutex> lock(spriteMutex);
 	const auto scalesIt = spriteMasks.find(sprite);
-	if(scalesIt == spriteMasks.end())
-	{
-		if(warned.insert(make_pair(sprite, true)).second)
-			Logger::LogError("Warning: sprite \"" + sprite->Name() + "\": no collision masks found.");
+	// Every sprite gets an entry at 1x scale once it is loaded, even if it has no
+	// masks. Until then, it may still be loading in the background.
+	if(scalesIt == spriteMasks.end() || !scalesIt->second.count(DEFAULT))
 		return EMPTY;
-	}
 
 	const auto &scales = scalesIt->second;
 	const auto maskIt = scales.find(scale);
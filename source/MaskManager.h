@@ -28,7 +28,8 @@ class Sprite;
 
 
 // Class that stores the masks for sprites that have them, and provides the correct
-// mask for the scale that the sprite requests.
+// mask for the scale that the sprite requests. Sprites may keep loading while the
+// game is running, so the masks can be added to and read from different threads.
 class MaskManager {
 public:
 	// Move the given masks at 1x scale into the manager's storage.
@@ -37,7 +38,8 @@ public:
 	// Add a scale that the given sprite needs to have a mask for.
 	void RegisterScale(const Sprite *sprite, double scale);
 
-	// Create the scaled versions of all masks from the 1x versions.
+	// Create the scaled versions of all masks from the 1x versions. Once this has
+	// been done, any masks or scales that are added later are scaled right away.
 	void ScaleMasks();
 
 	// Get the masks for the given sprite at the given scale. If a
@@ -49,7 +51,8 @@ private:
 	std::map<const Sprite *, std::map<double, std::vector<Mask>>> spriteMasks;
 
 	// Mutex to make sure different threads don't modify the masks at the same time.
-	std::mutex spriteMutex;
+	mutable std::mutex spriteMutex;
+	bool isScaled = false;
 };
 
 
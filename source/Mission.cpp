@@ -120,6 +120,20 @@ Mission::Mission(const DataNode &node)
 
 // Load a mission, either from the game data or from a saved game.
 void Mission::Load(const DataNode &node)
+{
+	LoadDefinition(node, false);
+}
+
+
+
+void Mission::LoadLazily(const DataNode &node)
+{
+	LoadDefinition(node, true);
+}
+
+
+
+void Mission::LoadDefinition(const DataNode &node, bool lazily)
 {
 	// All missions need a name.
 	if(node.Size() < 2)
@@ -137,17 +151,18 @@ void Mission::Load(const DataNode &node)
 		return;
 	}
 	name = node.Token(1);
+	offeredCondition = ConditionsStore::Key(name + ": offered");
 
 	for(const DataNode &child : node)
 	{
 		if(child.Token(0) == "name" && child.Size() >= 2)
-			displayName = child.Token(1);
+			displayName = TextTemplate(child.Token(1));
 		else if(child.Token(0) == "uuid" && child.Size() >= 2)
 			uuid = EsUuid::FromString(child.Token(1));
 		else if(child.Token(0) == "description" && child.Size() >= 2)
-			description = child.Token(1);
+			description = TextTemplate(child.Token(1));
 		else if(child.Token(0) == "blocked" && child.Size() >= 2)
-			blocked = child.Token(1);
+			blocked = TextTemplate(child.Token(1));
 		else if(child.Token(0) == "deadline" && child.Size() >= 4)
 			deadline = Date(child.Value(1), child.Value(2), child.Value(3));
 		else if(child.Token(0) == "deadline")
@@ -223,7 +238,7 @@ void Mission::Load(const DataNode &node)
 			repeat = (child.Size() == 1 ? 0 : static_cast<int>(child.Value(1)));
 		else if(child.Token(0) == "clearance")
 		{
-			clearance = (child.Size() == 1 ? "auto" : child.Token(1));
+			clearance = TextTemplate(child.Size() == 1 ? "auto" : child.Token(1));
 			clearanceFilter.Load(child);
 		}
 		else if(child.Token(0) == "infiltrating")
@@ -277,66 +292,96 @@ void Mission::Load(const DataNode &node)
 			stopoverFilters.emplace_back(child);
 		else if(child.Token(0) == "substitutions" && child.HasChildren())
 			substitutions.Load(child);
-		else if(child.Token(0) == "npc")
-			npcs.emplace_back(child);
-		else if(child.Token(0) == "on" && child.Size() >= 2 && child.Token(1) == "enter")
-		{
-			// "on enter" nodes may either name a specific system or use a LocationFilter
-			// to control the triggering system.
-			if(child.Size() >= 3)
-			{
-				MissionAction &action = onEnter[GameData::Systems().Get(child.Token(2))];
-				action.Load(child, name);
-			}
-			else
-				genericOnEnter.emplace_back(child, name);
-		}
-		else if(child.Token(0) == "on" && child.Size() >= 2)
+		else if(child.Token(0) == "npc" || (child.Token(0) == "on" && child.Size() >= 2))
 		{
-			static const map<string, Trigger> trigger = {
-				{"complete", COMPLETE},
-				{"offer", OFFER},
-				{"accept", ACCEPT},
-				{"decline", DECLINE},
-				{"fail", FAIL},
-				{"abort", ABORT},
-				{"defer", DEFER},
-				{"visit", VISIT},
-				{"stopover", STOPOVER},
-				{"waypoint", WAYPOINT},
-				{"daily", DAILY},
-			};
-			auto it = trigger.find(child.Token(1));
-			if(it != trigger.end())
-				actions[it->second].Load(child, name);
+			// Only the actions that decide whether this mission can be offered must be
+			// parsed right away. Everything else can wait until it is instantiated.
+			static const set<string> offerTriggers = {"offer", "accept", "decline", "defer"};
+			if(lazily && (child.Token(0) == "npc" || !offerTriggers.count(child.Token(1))))
+				lazyDefinition.Add(child);
 			else
-				child.PrintTrace("Skipping unrecognized attribute:");
+				LoadAction(child);
 		}
 		else
 			child.PrintTrace("Skipping unrecognized attribute:");
 	}
 
-	if(displayName.empty())
-		displayName = name;
+	if(displayName.IsEmpty())
+		displayName = TextTemplate(name);
 	if(hasPriority && location == LANDING)
 		node.PrintTrace("Warning: \"priority\" tag has no effect on \"landing\" missions:");
 }
 
 
 
+// Parse an "npc" or "on" node of this mission's definition.
+void Mission::LoadAction(const DataNode &child)
+{
+	if(child.Token(0) == "npc")
+		npcs.emplace_back(child);
+	else if(child.Token(1) == "enter")
+	{
+		// "on enter" nodes may either name a specific system or use a LocationFilter
+		// to control the triggering system.
+		if(child.Size() >= 3)
+		{
+			MissionAction &action = onEnter[GameData::Systems().Get(child.Token(2))];
+			action.Load(child, name);
+		}
+		else
+			genericOnEnter.emplace_back(child, name);
+	}
+	else
+	{
+		static const map<string, Trigger> trigger = {
+			{"complete", COMPLETE},
+			{"offer", OFFER},
+			{"accept", ACCEPT},
+			{"decline", DECLINE},
+			{"fail", FAIL},
+			{"abort", ABORT},
+			{"defer", DEFER},
+			{"visit", VISIT},
+			{"stopover", STOPOVER},
+			{"waypoint", WAYPOINT},
+			{"daily", DAILY},
+		};
+		auto it = trigger.find(child.Token(1));
+		if(it != trigger.end())
+			actions[it->second].Load(child, name);
+		else
+			child.PrintTrace("Skipping unrecognized attribute:");
+	}
+}
+
+
+
+// Parse any parts of this mission's definition that were loaded lazily.
+void Mission::EnsureLoaded() const
+{
+	// Mission templates are never created as const objects, so they can be modified here.
+	lazyDefinition.Resolve([this](const DataNode &child) -> void
+		{
+			const_cast<Mission *>(this)->LoadAction(child);
+		});
+}
+
+
+
 // Save a mission. It is safe to assume that any mission that is being saved
 // is already "instantiated," so only a subset of the data must be saved.
 void Mission::Save(DataWriter &out, const string &tag) const
 {
+	EnsureLoaded();
 	out.Write(tag, name);
 	out.BeginChild();
 	{
-		out.Write("name", displayName);
+		out.Write("name", displayName.Text());
 		out.Write("uuid", uuid.ToString());
-		if(!description.empty())
-			out.Write("description", description);
-		if(!blocked.empty())
-			out.Write("blocked", blocked);
+		if(!description.IsEmpty())
+			out.Write("description", description.Text());
+		if(!blocked.IsEmpty())
+			out.Write("blocked", blocked.Text());
 		if(deadline)
 			out.Write("deadline", deadline.Day(), deadline.Month(), deadline.Year());
 		if(cargoSize)
@@ -375,9 +420,9 @@ void Mission::Save(DataWriter &out, const string &tag) const
 		}
 		if(location == JOB)
 			out.Write("job");
-		if(!clearance.empty())
+		if(!clearance.IsEmpty())
 		{
-			out.Write("clearance", clearance);
+			out.Write("clearance", clearance.Text());
 			clearanceFilter.Save(out);
 		}
 		if(!hasFullClearance)
@@ -473,14 +518,14 @@ const EsUuid &Mission::UUID() const noexcept
 
 const string &Mission::Name() const
 {
-	return displayName;
+	return displayName.Text();
 }
 
 
 
 const string &Mission::Description() const
 {
-	return description;
+	return description.Text();
 }
 
 
@@ -498,6 +543,7 @@ bool Mission::IsVisible() const
 // not fully defined. If everything is fully defined, this is a valid mission.
 bool Mission::IsValid() const
 {
+	EnsureLoaded();
 	// Planets must be defined and in a system. However, a source system does not necessarily exist.
 	if(source && !source->IsValid())
 		return false;
@@ -570,6 +616,22 @@ bool Mission::IsAtLocation(Location location) const
 
 
 
+// The planet this mission may only be offered on, if any, and the filter
+// that the planet it is offered on must match.
+const Planet *Mission::SourcePlanet() const
+{
+	return source;
+}
+
+
+
+const LocationFilter &Mission::SourceFilter() const
+{
+	return sourceFilter;
+}
+
+
+
 // Information about what you are doing.
 const Ship *Mission::SourceShip() const
 {
@@ -694,7 +756,7 @@ bool Mission::CheckDeadline(const Date &today)
 // Check if you have special clearance to land on your destination.
 bool Mission::HasClearance(const Planet *planet) const
 {
-	if(clearance.empty())
+	if(clearance.IsEmpty())
 		return false;
 	if(planet == destination || stopovers.count(planet) || visitedStopovers.count(planet))
 		return true;
@@ -707,7 +769,7 @@ bool Mission::HasClearance(const Planet *planet) const
 // this is "auto", you don't have to hail them to get landing permission.
 const string &Mission::ClearanceMessage() const
 {
-	return clearance;
+	return clearance.Text();
 }
 
 
@@ -748,7 +810,7 @@ bool Mission::CanOffer(const PlayerInfo &player, const shared_ptr<Ship> &boardin
 	if(!toFail.IsEmpty() && toFail.Test(playerConditions))
 		return false;
 
-	if(repeat && playerConditions.Get(name + ": offered") >= repeat)
+	if(repeat && playerConditions.HasGet(offeredCondition).second >= repeat)
 		return false;
 
 	auto it = actions.find(OFFER);
@@ -905,7 +967,7 @@ void Mission::Fail()
 // so that you do not display the same message multiple times.
 string Mission::BlockedMessage(const PlayerInfo &player)
 {
-	if(blocked.empty())
+	if(blocked.IsEmpty())
 		return "";
 
 	int extraCrew = 0;
@@ -950,8 +1012,8 @@ string Mission::BlockedMessage(const PlayerInfo &player)
 		out << "no additional space";
 	subs["<capacity>"] = out.str();
 
-	string message = Format::Replace(blocked, subs);
-	blocked.clear();
+	string message = blocked.Replace(subs);
+	blocked = TextTemplate();
 	return message;
 }
 
@@ -1036,7 +1098,7 @@ bool Mission::Do(Trigger trigger, PlayerInfo &player, UI *ui, const shared_ptr<S
 
 	if(trigger == ACCEPT)
 	{
-		++player.Conditions()[name + ": offered"];
+		++player.Conditions()[offeredCondition];
 		++player.Conditions()[name + ": active"];
 		// Any potential on offer conversation has been finished, so update
 		// the active NPCs for the first time.
@@ -1044,7 +1106,7 @@ bool Mission::Do(Trigger trigger, PlayerInfo &player, UI *ui, const shared_ptr<S
 	}
 	else if(trigger == DECLINE)
 	{
-		++player.Conditions()[name + ": offered"];
+		++player.Conditions()[offeredCondition];
 		++player.Conditions()[name + ": declined"];
 	}
 	else if(trigger == COMPLETE)
@@ -1081,6 +1143,7 @@ bool Mission::Do(Trigger trigger, PlayerInfo &player, UI *ui, const shared_ptr<S
 // takes off from a planet, they should be added to the active ships.
 const list<NPC> &Mission::NPCs() const
 {
+	EnsureLoaded();
 	return npcs;
 }
 
@@ -1140,7 +1203,7 @@ void Mission::Do(const ShipEvent &event, PlayerInfo &player, UI *ui)
 		{
 			hasFailed = true;
 			if(isVisible)
-				Messages::Add(message + "Mission failed: \"" + displayName + "\".", Messages::Importance::Highest);
+				Messages::Add(message + "Mission failed: \"" + displayName.Text() + "\".", Messages::Importance::Highest);
 		}
 	}
 
@@ -1182,6 +1245,7 @@ const string &Mission::Identifier() const
 // mission action.
 const MissionAction &Mission::GetAction(Trigger trigger) const
 {
+	EnsureLoaded();
 	auto ait = actions.find(trigger);
 	static const MissionAction EMPTY{};
 	return ait != actions.end() ? ait->second : EMPTY;
@@ -1193,6 +1257,7 @@ const MissionAction &Mission::GetAction(Trigger trigger) const
 // with a single choice, and then replacing any wildcard text as well.
 Mission Mission::Instantiate(const PlayerInfo &player, const shared_ptr<Ship> &boardingShip) const
 {
+	EnsureLoaded();
 	Mission result;
 	// If anything goes wrong below, this mission should not be offered.
 	result.hasFailed = true;
@@ -1205,6 +1270,7 @@ Mission Mission::Instantiate(const PlayerInfo &player, const shared_ptr<Ship> &b
 	result.sourceShip = boardingShip.get();
 	result.repeat = repeat;
 	result.name = name;
+	result.offeredCondition = offeredCondition;
 	result.waypoints = waypoints;
 	// Handle waypoint systems that are chosen randomly.
 	const System *const sourceSystem = player.GetSystem();
@@ -1232,7 +1298,7 @@ Mission Mission::Instantiate(const PlayerInfo &player, const shared_ptr<Ship> &b
 	for(const LocationFilter &filter : stopoverFilters)
 	{
 		// Unlike destinations, we can allow stopovers on planets that don't have a spaceport.
-		const Planet *planet = filter.PickPlanet(sourceSystem, !clearance.empty(), false);
+		const Planet *planet = filter.PickPlanet(sourceSystem, !clearance.IsEmpty(), false);
 		if(!planet)
 			return result;
 		result.stopovers.insert(planet);
@@ -1245,7 +1311,7 @@ Mission Mission::Instantiate(const PlayerInfo &player, const shared_ptr<Ship> &b
 	result.destination = destination;
 	if(!result.destination && !destinationFilter.IsEmpty())
 	{
-		result.destination = destinationFilter.PickPlanet(sourceSystem, !clearance.empty());
+		result.destination = destinationFilter.PickPlanet(sourceSystem, !clearance.IsEmpty());
 		if(!result.destination)
 			return result;
 	}
@@ -1442,10 +1508,10 @@ Mission Mission::Instantiate(const PlayerInfo &player, const shared_ptr<Ship> &b
 		result.genericOnEnter.emplace_back(action.Instantiate(subs, sourceSystem, jumps, payload));
 
 	// Perform substitution in the name and description.
-	result.displayName = Format::Replace(displayName, subs);
-	result.description = Format::Replace(description, subs);
-	result.clearance = Format::Replace(clearance, subs);
-	result.blocked = Format::Replace(blocked, subs);
+	result.displayName = TextTemplate(displayName.Replace(subs));
+	result.description = TextTemplate(description.Replace(subs));
+	result.clearance = TextTemplate(clearance.Replace(subs));
+	result.blocked = TextTemplate(blocked.Replace(subs));
 	result.clearanceFilter = clearanceFilter;
 	result.hasFullClearance = hasFullClearance;
 
@@ -1471,19 +1537,18 @@ int Mission::CalculateJumps(const System *sourceSystem)
 	while(!destinations.empty())
 	{
 		// Find the closest destination to this location.
-		DistanceMap distance(sourceSystem);
+		shared_ptr<const DistanceMap> distance = DistanceMap::Cached(sourceSystem);
 		auto it = destinations.begin();
 		auto bestIt = it;
 		for(++it; it != destinations.end(); ++it)
-			if(distance.Days(*it) < distance.Days(*bestIt))
+			if(distance->Days(*it) < distance->Days(*bestIt))
 				bestIt = it;
 
 		sourceSystem = *bestIt;
-		expectedJumps += distance.Days(*bestIt);
+		expectedJumps += distance->Days(*bestIt);
 		destinations.erase(bestIt);
 	}
-	DistanceMap distance(sourceSystem);
-	expectedJumps += distance.Days(destination->GetSystem());
+	expectedJumps += DistanceMap::Cached(sourceSystem)->Days(destination->GetSystem());
 
 	return expectedJumps;
 }
@@ -17,12 +17,15 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #define MISSION_H_
 
 #include "ConditionSet.h"
+#include "ConditionsStore.h"
 #include "Date.h"
 #include "EsUuid.h"
+#include "LazyDefinition.h"
 #include "LocationFilter.h"
 #include "MissionAction.h"
 #include "NPC.h"
 #include "TextReplacements.h"
+#include "text/TextTemplate.h"
 
 #include <list>
 #include <map>
@@ -61,6 +64,10 @@ public:
 
 	// Load a mission, either from the game data or from a saved game.
 	void Load(const DataNode &node);
+	// Load a mission from the game data, but only parse the parts needed to
+	// decide whether it can be offered. Its NPCs and any actions that are not
+	// needed until it has been offered are parsed when it is instantiated.
+	void LoadLazily(const DataNode &node);
 	// Save a mission. It is safe to assume that any mission that is being saved
 	// is already "instantiated," so only a subset of the data must be saved.
 	void Save(DataWriter &out, const std::string &tag = "mission") const;
@@ -89,6 +96,11 @@ public:
 	enum Location {SPACEPORT, LANDING, JOB, ASSISTING, BOARDING, SHIPYARD, OUTFITTER};
 	bool IsAtLocation(Location location) const;
 
+	// The planet this mission may only be offered on, if any, and the filter
+	// that the planet it is offered on must match.
+	const Planet *SourcePlanet() const;
+	const LocationFilter &SourceFilter() const;
+
 	// Information about what you are doing.
 	const Ship *SourceShip() const;
 	const Planet *Destination() const;
@@ -182,6 +194,10 @@ public:
 
 
 private:
+	void LoadDefinition(const DataNode &node, bool lazily);
+	// Parse an "npc" or "on" node, which can be deferred until the mission is used.
+	void LoadAction(const DataNode &node);
+	void EnsureLoaded() const;
 	bool Enter(const System *system, PlayerInfo &player, UI *ui);
 	// For legacy code, contraband definitions can be placed in two different
 	// locations, so move that parsing out to a helper function.
@@ -190,9 +206,9 @@ private:
 
 private:
 	std::string name;
-	std::string displayName;
-	std::string description;
-	std::string blocked;
+	TextTemplate displayName;
+	TextTemplate description;
+	TextTemplate blocked;
 	Location location = SPACEPORT;
 
 	EsUuid uuid;
@@ -207,11 +223,15 @@ private:
 	int expectedJumps = 0;
 	int deadlineBase = 0;
 	int deadlineMultiplier = 0;
-	std::string clearance;
+	TextTemplate clearance;
 	LocationFilter clearanceFilter;
 	bool hasFullClearance = true;
 
 	int repeat = 1;
+	// The condition counting how many times this mission has been offered. It is
+	// interned when the mission is loaded, because checking it is part of
+	// deciding whether the mission can be offered, which is done in parallel.
+	ConditionsStore::Key offeredCondition;
 	std::string cargo;
 	int cargoSize = 0;
 	// Parameters for generating random cargo amounts:
@@ -259,6 +279,9 @@ private:
 	std::list<MissionAction> genericOnEnter;
 	// Track which `on enter` MissionActions have triggered.
 	std::set<const MissionAction *> didEnter;
+	// NPCs and actions of a mission template that have not been parsed yet.
+	// Instantiated missions always have every part of their definition parsed.
+	LazyDefinition lazyDefinition;
 };
 
 
@@ -0,0 +1,112 @@
+/* MissionIndex.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "MissionIndex.h"
+
+#include "Mission.h"
+#include "Planet.h"
+
+#include <algorithm>
+#include <set>
+
+using namespace std;
+
+namespace {
+	// Add the given index to the list filed under each of the given keys.
+	template <class Key, class Index>
+	void File(const set<Key> &keys, size_t index, Index &byKey)
+	{
+		for(const Key &key : keys)
+			byKey[key].push_back(index);
+	}
+
+	// Add all the indices filed under the given key to the given list.
+	template <class Key, class Index>
+	void Gather(const Key &key, const Index &byKey, vector<size_t> &result)
+	{
+		auto it = byKey.find(key);
+		if(it != byKey.end())
+			result.insert(result.end(), it->second.begin(), it->second.end());
+	}
+}
+
+
+
+// File all the given missions, other than those offered when boarding or
+// assisting a ship. This replaces any missions filed before.
+void MissionIndex::Build(const Set<Mission> &missions)
+{
+	*this = MissionIndex();
+	for(const auto &it : missions)
+	{
+		const Mission &mission = it.second;
+		if(mission.IsAtLocation(Mission::BOARDING) || mission.IsAtLocation(Mission::ASSISTING))
+			continue;
+
+		size_t index = this->missions.size();
+		this->missions.push_back(&mission);
+		isJob.push_back(mission.IsAtLocation(Mission::JOB));
+
+		// File each mission under the most specific thing that any planet it
+		// is offered on must have. For attributes, a planet must have at least
+		// one from each set, so any one of those sets will do.
+		const LocationFilter &filter = mission.SourceFilter();
+		if(mission.SourcePlanet())
+			byPlanet[mission.SourcePlanet()].push_back(index);
+		else if(!filter.Planets().empty())
+			File(filter.Planets(), index, byPlanet);
+		else if(!filter.Systems().empty())
+			File(filter.Systems(), index, bySystem);
+		else if(!filter.Governments().empty())
+			File(filter.Governments(), index, byGovernment);
+		else if(!filter.Attributes().empty())
+		{
+			const auto &attributes = filter.Attributes();
+			File(*min_element(attributes.begin(), attributes.end(),
+				[](const set<string> &a, const set<string> &b) { return a.size() < b.size(); }),
+				index, byAttribute);
+		}
+		else
+			anywhere.push_back(index);
+	}
+}
+
+
+
+// Get every mission that might be offered on the given planet, in the same
+// order as in the set of missions. Jobs are only included if requested.
+vector<const Mission *> MissionIndex::Candidates(const Planet *planet, bool includeJobs) const
+{
+	vector<const Mission *> result;
+	// No mission can be offered anywhere but on a valid planet.
+	if(!planet || !planet->IsValid())
+		return result;
+
+	vector<size_t> indices = anywhere;
+	Gather(planet, byPlanet, indices);
+	Gather(planet->GetSystem(), bySystem, indices);
+	Gather(planet->GetGovernment(), byGovernment, indices);
+	for(const string &attribute : planet->Attributes())
+		Gather(attribute, byAttribute, indices);
+
+	// A mission may be filed under more than one of this planet's attributes.
+	sort(indices.begin(), indices.end());
+	indices.erase(unique(indices.begin(), indices.end()), indices.end());
+
+	for(size_t index : indices)
+		if(includeJobs || !isJob[index])
+			result.push_back(missions[index]);
+	return result;
+}
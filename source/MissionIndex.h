@@ -0,0 +1,65 @@
+/* MissionIndex.h
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MISSION_INDEX_H_
+#define MISSION_INDEX_H_
+
+#include "Set.h"
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Government;
+class Mission;
+class Planet;
+class System;
+
+
+
+// Class for quickly finding the missions that might be offered on a planet.
+// Each mission is filed under the planet, system, government or attribute
+// that its source filter requires, so that when the player lands only the
+// missions filed under something that planet has need to be checked in full.
+class MissionIndex {
+public:
+	// File all the given missions, other than those offered when boarding or
+	// assisting a ship. This replaces any missions filed before.
+	void Build(const Set<Mission> &missions);
+
+	// Get every mission that might be offered on the given planet, in the same
+	// order as in the set of missions. Jobs are only included if requested.
+	std::vector<const Mission *> Candidates(const Planet *planet, bool includeJobs) const;
+
+
+private:
+	// All the filed missions, in order, and whether each one is a job.
+	std::vector<const Mission *> missions;
+	std::vector<bool> isJob;
+
+	// The indices of the missions filed under each planet, system, government
+	// or attribute, and of those whose source filter requires none of those.
+	std::unordered_map<const Planet *, std::vector<size_t>> byPlanet;
+	std::unordered_map<const System *, std::vector<size_t>> bySystem;
+	std::unordered_map<const Government *, std::vector<size_t>> byGovernment;
+	std::map<std::string, std::vector<size_t>> byAttribute;
+	std::vector<size_t> anywhere;
+};
+
+
+
+#endif
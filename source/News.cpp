@@ -26,6 +26,22 @@ using namespace std;
 
 
 void News::Load(const DataNode &node)
+{
+	LoadDefinition(node, false);
+}
+
+
+
+// Load this news item, but only parse the speaker's names and messages the
+// first time they are needed. The rest is needed to decide when it is shown.
+void News::LoadLazily(const DataNode &node)
+{
+	LoadDefinition(node, true);
+}
+
+
+
+void News::LoadDefinition(const DataNode &node, bool lazily)
 {
 	for(const DataNode &child : node)
 	{
@@ -53,6 +69,8 @@ void News::Load(const DataNode &node)
 		{
 			if(remove)
 				names = Phrase{};
+			else if(lazily)
+				names.LoadLazily(child);
 			else
 				names.Load(child);
 		}
@@ -84,6 +102,8 @@ void News::Load(const DataNode &node)
 		{
 			if(remove)
 				messages = Phrase{};
+			else if(lazily)
+				messages.LoadLazily(child);
 			else
 				messages.Load(child);
 		}
@@ -34,6 +34,8 @@ class Sprite;
 class News {
 public:
 	void Load(const DataNode &node);
+	// Defer parsing the names and messages until this news item is shown.
+	void LoadLazily(const DataNode &node);
 
 	// Check whether this news item has anything to say.
 	bool IsEmpty() const;
@@ -48,6 +50,10 @@ public:
 	std::string Message() const;
 
 
+private:
+	void LoadDefinition(const DataNode &node, bool lazily);
+
+
 private:
 	LocationFilter location;
 	ConditionSet toShow;
@@ -29,8 +29,10 @@ namespace {
 	GLint offI;
 	GLint transformI;
 	GLint positionI;
-	GLint frameI;
-	GLint frameCountI;
+	GLint firstRectI;
+	GLint secondRectI;
+	GLint layersI;
+	GLint fadeI;
 	GLint colorI;
 
 	GLuint vao;
@@ -74,8 +76,12 @@ void OutlineShader::Init()
 		"precision mediump sampler2DArray;\n"
 #endif
 		"uniform sampler2DArray tex;\n"
-		"uniform float frame;\n"
-		"uniform float frameCount;\n"
+		// Where the two frames to blend are in the texture. Coordinates within
+		// an atlas page need more precision than mediump.
+		"uniform highp vec4 firstRect;\n"
+		"uniform highp vec4 secondRect;\n"
+		"uniform vec2 layers;\n"
+		"uniform float fade;\n"
 		"uniform vec4 color;\n"
 		"uniform vec2 off;\n"
 		"const vec4 weight = vec4(.4, .4, .4, 1.);\n"
@@ -84,23 +90,30 @@ void OutlineShader::Init()
 
 		"out vec4 finalColor;\n"
 
-		"float Sobel(float layer) {\n"
+		// Sample the given frame at the given position within the sprite, which
+		// is clamped to the sprite's edge.
+		"float Sample(highp vec2 coord, highp vec4 rect, float layer) {\n"
+		"  highp vec2 position = rect.xy + clamp(coord, 0.f, 1.f) * rect.zw;\n"
+		"  return dot(texture(tex, vec3(position, layer)), weight);\n"
+		"}\n"
+
+		"float Sobel(highp vec4 rect, float layer) {\n"
 		"  float sum = 0.f;\n"
 		"  for(int dy = -1; dy <= 1; ++dy)\n"
 		"  {\n"
 		"    for(int dx = -1; dx <= 1; ++dx)\n"
 		"    {\n"
 		"      vec2 center = fragTexCoord + .618034 * off * vec2(dx, dy);\n"
-		"      float nw = dot(texture(tex, vec3(center + vec2(-off.x, -off.y), layer)), weight);\n"
-		"      float ne = dot(texture(tex, vec3(center + vec2(off.x, -off.y), layer)), weight);\n"
-		"      float sw = dot(texture(tex, vec3(center + vec2(-off.x, off.y), layer)), weight);\n"
-		"      float se = dot(texture(tex, vec3(center + vec2(off.x, off.y), layer)), weight);\n"
+		"      float nw = Sample(center + vec2(-off.x, -off.y), rect, layer);\n"
+		"      float ne = Sample(center + vec2(off.x, -off.y), rect, layer);\n"
+		"      float sw = Sample(center + vec2(-off.x, off.y), rect, layer);\n"
+		"      float se = Sample(center + vec2(off.x, off.y), rect, layer);\n"
 		"      float h = nw + sw - ne - se + 2.f * (\n"
-		"        dot(texture(tex, vec3(center + vec2(-off.x, 0.f), layer)), weight)\n"
-		"          - dot(texture(tex, vec3(center + vec2(off.x, 0.f), layer)), weight));\n"
+		"        Sample(center + vec2(-off.x, 0.f), rect, layer)\n"
+		"          - Sample(center + vec2(off.x, 0.f), rect, layer));\n"
 		"      float v = nw + ne - sw - se + 2.f * (\n"
-		"        dot(texture(tex, vec3(center + vec2(0.f, -off.y), layer)), weight)\n"
-		"          - dot(texture(tex, vec3(center + vec2(0.f, off.y), layer)), weight));\n"
+		"        Sample(center + vec2(0.f, -off.y), rect, layer)\n"
+		"          - Sample(center + vec2(0.f, off.y), rect, layer));\n"
 		"      sum += h * h + v * v;\n"
 		"    }\n"
 		"  }\n"
@@ -108,10 +121,7 @@ void OutlineShader::Init()
 		"}\n"
 
 		"void main() {\n"
-		"  float first = floor(frame);\n"
-		"  float second = mod(ceil(frame), frameCount);\n"
-		"  float fade = frame - first;\n"
-		"  float sum = mix(Sobel(first), Sobel(second), fade);\n"
+		"  float sum = mix(Sobel(firstRect, layers.x), Sobel(secondRect, layers.y), fade);\n"
 		"  finalColor = color * sqrt(sum / 180.f);\n"
 		"}\n";
 
@@ -120,8 +130,10 @@ void OutlineShader::Init()
 	offI = shader.Uniform("off");
 	transformI = shader.Uniform("transform");
 	positionI = shader.Uniform("position");
-	frameI = shader.Uniform("frame");
-	frameCountI = shader.Uniform("frameCount");
+	firstRectI = shader.Uniform("firstRect");
+	secondRectI = shader.Uniform("secondRect");
+	layersI = shader.Uniform("layers");
+	fadeI = shader.Uniform("fade");
 	colorI = shader.Uniform("color");
 
 	glUseProgram(shader.Object());
@@ -161,6 +173,12 @@ void OutlineShader::Init()
 void OutlineShader::Draw(const Sprite *sprite, const Point &pos, const Point &size,
 	const Color &color, const Point &unit, float frame)
 {
+	// Skip sprites that have been unloaded to save memory.
+	bool isHighDPI = (unit.Length() * Screen::Zoom() > 50.);
+	uint32_t texture = sprite->Texture(isHighDPI);
+	if(!texture)
+		return;
+
 	glUseProgram(shader.Object());
 	glBindVertexArray(vao);
 
@@ -172,8 +190,13 @@ void OutlineShader::Draw(const Sprite *sprite, const Point &pos, const Point &si
 		static_cast<float>(.5 / size.Y())};
 	glUniform2fv(offI, 1, off);
 
-	glUniform1f(frameI, frame);
-	glUniform1f(frameCountI, sprite->Frames());
+	Sprite::Region first;
+	Sprite::Region second;
+	float fade = sprite->Locate(frame, isHighDPI, first, second);
+	glUniform4fv(firstRectI, 1, first.rect);
+	glUniform4fv(secondRectI, 1, second.rect);
+	glUniform2f(layersI, first.layer, second.layer);
+	glUniform1f(fadeI, fade);
 
 	Point uw = unit * size.X();
 	Point uh = unit * size.Y();
@@ -191,7 +214,7 @@ void OutlineShader::Draw(const Sprite *sprite, const Point &pos, const Point &si
 
 	glUniform4fv(colorI, 1, color.Get());
 
-	glBindTexture(GL_TEXTURE_2D_ARRAY, sprite->Texture(unit.Length() * Screen::Zoom() > 50.));
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
 
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
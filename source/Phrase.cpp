@@ -21,6 +21,19 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 using namespace std;
 
+namespace {
+	// Check whether parsing the given definition would add anything to a phrase,
+	// i.e. whether it has at least one word, phrase or replace node with children.
+	bool HasParts(const DataNode &node)
+	{
+		for(const DataNode &child : node)
+			if(child.HasChildren() && (child.Token(0) == "word" || child.Token(0) == "phrase"
+					|| child.Token(0) == "replace"))
+				return true;
+		return false;
+	}
+}
+
 
 
 // Replace all occurrences ${phrase name} with the expanded phrase from GameData::Phrases()
@@ -62,29 +75,35 @@ Phrase::Phrase(const DataNode &node)
 
 void Phrase::Load(const DataNode &node)
 {
-	// Set the name of this phrase, so we know it has been loaded.
-	name = node.Size() >= 2 ? node.Token(1) : "Unnamed Phrase";
-	// To avoid a possible parsing ambiguity, the interpolation delimiters
-	// may not be used in a Phrase's name.
-	if(name.find("${") != string::npos || name.find('}') != string::npos)
-	{
-		node.PrintTrace("Error: Phrase names may not contain '${' or '}':");
+	// Parse any deferred definitions first, so that the sentences stay in order.
+	EnsureLoaded();
+	if(LoadName(node))
+		AddSentence(node);
+}
+
+
+
+// Remember the given node, and only parse it into a new branch of this phrase
+// the first time the phrase is used.
+void Phrase::LoadLazily(const DataNode &node)
+{
+	if(!LoadName(node))
 		return;
-	}
 
-	sentences.emplace_back(node, this);
-	if(sentences.back().empty())
-	{
-		sentences.pop_back();
-		node.PrintTrace("Error: Unable to parse node:");
-	}
+	// Only definitions that are sure to add something are deferred, so that
+	// whether this phrase is empty is known without parsing it. Anything else
+	// is parsed right away, so that its errors are reported.
+	if(HasParts(node))
+		lazyDefinition.Add(node);
+	else
+		AddSentence(node);
 }
 
 
 
 bool Phrase::IsEmpty() const
 {
-	return sentences.empty();
+	return sentences.empty() && !lazyDefinition.IsPending();
 }
 
 
@@ -101,6 +120,7 @@ const string &Phrase::Name() const
 // Get a random sentence's text.
 string Phrase::Get() const
 {
+	EnsureLoaded();
 	string result;
 	if(sentences.empty())
 		return result;
@@ -130,6 +150,8 @@ bool Phrase::ReferencesPhrase(const Phrase *other) const
 	if(other == this)
 		return true;
 
+	EnsureLoaded();
+
 	for(const auto &sentence : sentences)
 		for(const auto &part : sentence)
 			for(const auto &choice : part.choices)
@@ -142,6 +164,49 @@ bool Phrase::ReferencesPhrase(const Phrase *other) const
 
 
 
+// Set the name of this phrase from the given definition. Returns false if
+// the name is invalid, in which case the definition should be skipped.
+bool Phrase::LoadName(const DataNode &node)
+{
+	// Set the name of this phrase, so we know it has been loaded.
+	name = node.Size() >= 2 ? node.Token(1) : "Unnamed Phrase";
+	// To avoid a possible parsing ambiguity, the interpolation delimiters
+	// may not be used in a Phrase's name.
+	if(name.find("${") != string::npos || name.find('}') != string::npos)
+	{
+		node.PrintTrace("Error: Phrase names may not contain '${' or '}':");
+		return false;
+	}
+	return true;
+}
+
+
+
+// Parse the given definition into a new branch of this phrase.
+void Phrase::AddSentence(const DataNode &node)
+{
+	sentences.emplace_back(node, this);
+	if(sentences.back().empty())
+	{
+		sentences.pop_back();
+		node.PrintTrace("Error: Unable to parse node:");
+	}
+}
+
+
+
+// Parse any definitions of this phrase that were loaded lazily.
+void Phrase::EnsureLoaded() const
+{
+	// Phrases are never created as const objects, so they can be modified here.
+	lazyDefinition.Resolve([this](const DataNode &node) -> void
+		{
+			const_cast<Phrase *>(this)->AddSentence(node);
+		});
+}
+
+
+
 Phrase::Choice::Choice(const DataNode &node, bool isPhraseName)
 {
 	// The given datanode should not have any children.
@@ -16,6 +16,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #ifndef PHRASE_H_
 #define PHRASE_H_
 
+#include "LazyDefinition.h"
 #include "WeightedList.h"
 
 #include <functional>
@@ -41,6 +42,8 @@ public:
 
 	// Parse the given node into a new branch associated with this phrase.
 	void Load(const DataNode &node);
+	// Remember the given node, and only parse it the first time this phrase is used.
+	void LoadLazily(const DataNode &node);
 
 	bool IsEmpty() const;
 
@@ -49,6 +52,9 @@ public:
 
 
 private:
+	bool LoadName(const DataNode &node);
+	void AddSentence(const DataNode &node);
+	void EnsureLoaded() const;
 	bool ReferencesPhrase(const Phrase *phrase) const;
 
 
@@ -96,6 +102,8 @@ private:
 	std::string name;
 	// Each time this phrase is defined, a new sentence is created.
 	std::vector<Sentence> sentences;
+	// Definitions of this phrase that have not been parsed yet.
+	LazyDefinition lazyDefinition;
 };
 
 
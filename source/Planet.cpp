@@ -30,6 +30,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Wormhole.h"
 
 #include <algorithm>
+#include <atomic>
 
 using namespace std;
 
@@ -37,6 +38,9 @@ namespace {
 	const string WORMHOLE = "wormhole";
 	const string PLANET = "planet";
 
+	// The index that will be given to the next planet that is created.
+	atomic<size_t> nextIndex{0};
+
 	// Planet attributes in the form "requires: <attribute>" restrict the ability of ships to land
 	// unless the ship has all required attributes.
 	void SetRequiredAttributes(const set<string> &attributes, set<string> &required)
@@ -53,6 +57,13 @@ namespace {
 
 
 
+Planet::Planet()
+	: index(nextIndex++)
+{
+}
+
+
+
 // Load a planet's description from a file.
 void Planet::Load(const DataNode &node, Set<Wormhole> &wormholes)
 {
@@ -219,7 +230,7 @@ void Planet::Load(const DataNode &node, Set<Wormhole> &wormholes)
 		}
 		else if(key == "wormhole")
 		{
-			wormhole = wormholes.Get(value);
+			wormhole = wormholes.Modify(value);
 			wormhole->SetPlanet(*this);
 		}
 		else
@@ -250,14 +261,14 @@ void Planet::FinishLoading(Set<Wormhole> &wormholes)
 	// If this planet is in multiple systems, then it is a wormhole.
 	if(!wormhole && systems.size() > 1)
 	{
-		wormhole = wormholes.Get(TrueName());
+		wormhole = wormholes.Modify(TrueName());
 		wormhole->LoadFromPlanet(*this);
 		Logger::LogError("Warning: deprecated automatic generation of wormhole \"" + name + "\" from a multi-system planet.");
 	}
 	// If the wormhole was autogenerated we need to update it to
-	// match the planet's state.
+	// match the planet's state. It was generated with this planet's name.
 	else if(wormhole && wormhole->IsAutogenerated())
-		wormhole->LoadFromPlanet(*this);
+		wormholes.Modify(TrueName())->LoadFromPlanet(*this);
 }
 
 
@@ -272,6 +283,20 @@ bool Planet::IsValid() const
 
 
 
+size_t Planet::Index() const
+{
+	return index;
+}
+
+
+
+size_t Planet::IndexCount()
+{
+	return nextIndex;
+}
+
+
+
 // Get the name of the planet.
 const string &Planet::Name() const
 {
@@ -371,15 +396,18 @@ bool Planet::IsInhabited() const
 // Check if this planet has a shipyard.
 bool Planet::HasShipyard() const
 {
-	return !Shipyard().empty();
+	return any_of(shipSales.begin(), shipSales.end(),
+		[](const Sale<Ship> *sale) { return !sale->empty(); });
 }
 
 
 
-// Get the list of ships in the shipyard.
-const Sale<Ship> &Planet::Shipyard() const
+// Get the list of ships in the shipyard. This is put together each time it is
+// asked for, because an event may change what any of the shipyards sell. It
+// is not stored in the planet, so that several threads may ask at once.
+Sale<Ship> Planet::Shipyard() const
 {
-	shipyard.clear();
+	Sale<Ship> shipyard;
 	for(const Sale<Ship> *sale : shipSales)
 		shipyard.Add(*sale);
 
@@ -391,15 +419,16 @@ const Sale<Ship> &Planet::Shipyard() const
 // Check if this planet has an outfitter.
 bool Planet::HasOutfitter() const
 {
-	return !Outfitter().empty();
+	return any_of(outfitSales.begin(), outfitSales.end(),
+		[](const Sale<Outfit> *sale) { return !sale->empty(); });
 }
 
 
 
 // Get the list of outfits available from the outfitter.
-const Sale<Outfit> &Planet::Outfitter() const
+Sale<Outfit> Planet::Outfitter() const
 {
-	outfitter.clear();
+	Sale<Outfit> outfitter;
 	for(const Sale<Outfit> *sale : outfitSales)
 		outfitter.Add(*sale);
 
@@ -51,6 +51,8 @@ public:
 
 
 public:
+	Planet();
+
 	// Load a planet's description from a file.
 	void Load(const DataNode &node, Set<Wormhole> &wormholes);
 	// Legacy wormhole do not have an associated Wormhole object so
@@ -59,6 +61,12 @@ public:
 	// Check if both this planet and its containing system(s) have been defined.
 	bool IsValid() const;
 
+	// Get a number identifying this planet, so that information about planets
+	// can be stored in arrays instead of maps. Each planet (other than copies of
+	// the same planet) has a different index, less than Planet::IndexCount().
+	size_t Index() const;
+	static size_t IndexCount();
+
 	// Get the name of the planet (all wormholes use the same name).
 	// When saving missions or writing the player's save, the reference name
 	// associated with this planet is used even if the planet was not fully
@@ -97,11 +105,11 @@ public:
 	// Check if this planet has a shipyard.
 	bool HasShipyard() const;
 	// Get the list of ships in the shipyard.
-	const Sale<Ship> &Shipyard() const;
+	Sale<Ship> Shipyard() const;
 	// Check if this planet has an outfitter.
 	bool HasOutfitter() const;
 	// Get the list of outfits available from the outfitter.
-	const Sale<Outfit> &Outfitter() const;
+	Sale<Outfit> Outfitter() const;
 
 	// Get this planet's government. If not set, returns the system's government.
 	const Government *GetGovernment() const;
@@ -153,6 +161,7 @@ public:
 
 
 private:
+	size_t index;
 	bool isDefined = false;
 	std::string name;
 	std::string description;
@@ -164,10 +173,6 @@ private:
 
 	std::set<const Sale<Ship> *> shipSales;
 	std::set<const Sale<Outfit> *> outfitSales;
-	// The lists above will be converted into actual ship lists when they are
-	// first asked for:
-	mutable Sale<Ship> shipyard;
-	mutable Sale<Outfit> outfitter;
 
 	const Government *government = nullptr;
 	double requiredReputation = 0.;
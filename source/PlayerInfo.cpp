@@ -21,13 +21,16 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "DataWriter.h"
 #include "Dialog.h"
 #include "DistanceMap.h"
+#include "File.h"
 #include "Files.h"
 #include "text/Format.h"
 #include "GameData.h"
+#include "Gzip.h"
 #include "Government.h"
 #include "Hardpoint.h"
 #include "Logger.h"
 #include "Messages.h"
+#include "MissionIndex.h"
 #include "Outfit.h"
 #include "Person.h"
 #include "Planet.h"
@@ -35,9 +38,11 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Preferences.h"
 #include "Random.h"
 #include "SavedGame.h"
+#include "SaveJournal.h"
 #include "Ship.h"
 #include "ShipEvent.h"
 #include "ShipJumpNavigation.h"
+#include "Sprite.h"
 #include "StartConditions.h"
 #include "StellarObject.h"
 #include "System.h"
@@ -46,12 +51,17 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
 #include <ctime>
 #include <functional>
+#include <future>
 #include <iterator>
 #include <limits>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 
 using namespace std;
 
@@ -102,6 +112,186 @@ namespace {
 			return SystemEntry::WORMHOLE;
 		return SystemEntry::TAKE_OFF;
 	}
+
+	// Missions are only checked on several threads if there are at least this
+	// many of them for each thread.
+	const size_t MISSIONS_PER_THREAD = 16;
+	// The difference between the random seeds of consecutive missions.
+	const uint64_t SEED_STEP = 0x9E3779B97F4A7C15ull;
+
+	// Check which of the given missions can be offered to the player, spreading
+	// the work over several threads, and instantiate them. Each mission has a
+	// random seed of its own, so that what is offered does not depend on which
+	// thread checked each mission. The player must not change meanwhile.
+	vector<Mission> OfferMissions(const vector<const Mission *> &templates, const PlayerInfo &player)
+	{
+		const uint64_t seed = (static_cast<uint64_t>(Random::Int()) << 32) | Random::Int();
+		vector<char> canOffer(templates.size(), false);
+		auto check = [&](size_t begin, size_t end) -> void
+		{
+			for(size_t i = begin; i < end; ++i)
+			{
+				Random::Seed(seed + i * SEED_STEP);
+				canOffer[i] = templates[i]->CanOffer(player);
+			}
+		};
+
+		// Each thread only has a random number generator of its own on Linux
+		// (see Random.cpp). Elsewhere, all missions are checked on this thread.
+		size_t threads = 1;
+#ifdef __linux__
+		threads = max<size_t>(1, min<size_t>(thread::hardware_concurrency(), templates.size() / MISSIONS_PER_THREAD));
+#endif
+		// This thread checks the first share of the missions itself.
+		size_t share = (templates.size() + threads - 1) / threads;
+		vector<future<void>> tasks;
+		for(size_t begin = share; begin < templates.size(); begin += share)
+			tasks.push_back(async(launch::async, check, begin, min(begin + share, templates.size())));
+		check(0, min(share, templates.size()));
+		for(future<void> &task : tasks)
+			task.get();
+
+		// Instantiating a mission parses any parts of it, and of the phrases and
+		// conversations it uses, that were loaded lazily. That may add objects to
+		// GameData, so it must only be done on this thread.
+		vector<Mission> result;
+		for(size_t i = 0; i < templates.size(); ++i)
+			if(canOffer[i])
+			{
+				Random::Seed(seed + i * SEED_STEP);
+				result.push_back(templates[i]->Instantiate(player));
+				if(result.back().HasFailed(player))
+					result.pop_back();
+			}
+		// Continue this thread's random numbers from where the missions' left
+		// off, no matter how many threads were used.
+		Random::Seed(seed + templates.size() * SEED_STEP);
+		return result;
+	}
+
+	// A saved game that has been written to memory, but not yet to disk.
+	class PendingSave {
+	public:
+		string path;
+		string contents;
+		// If a date is given, and the existing save is from a different date,
+		// it becomes the first of this many backups before being replaced.
+		string date;
+		int previousCount = 0;
+		bool hasSpaceport = false;
+		// Whether to compress the pilot's save files.
+		bool isCompressed = false;
+		// Whether to only record what changed since the previous save of the
+		// same file, if possible.
+		bool isJournaled = false;
+		// The global conditions are saved along with the pilot, to a file of
+		// their own, unless no path is given for that.
+		string globalConditionsPath;
+		string globalConditions;
+	};
+
+	// Saves are written to disk on another thread, one at a time, in the order
+	// in which they were made.
+	mutex saveMutex;
+	shared_future<void> lastSave;
+	// The journal of the file that was most recently saved with one, and
+	// whether its base should be compressed.
+	unique_ptr<SaveJournal> journal;
+	bool isJournalCompressed = false;
+
+	// Write the given contents to a temporary file next to the given path, and
+	// return its name. If anything goes wrong, the partial file is deleted and
+	// an empty string is returned.
+	string WriteTemporary(const string &path, const string &contents, bool compress)
+	{
+		const string temporary = path + ".tmp";
+		bool written = false;
+		{
+			File file(temporary, true);
+			if(compress)
+				written = Gzip::Write(file, contents);
+			else
+				written = file && fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+			written &= file && !fflush(file);
+		}
+		if(written)
+			return temporary;
+
+		Logger::LogError("Error: Unable to write \"" + path + "\".");
+		if(Files::Exists(temporary))
+			Files::Delete(temporary);
+		return string();
+	}
+
+	// Write the given file in such a way that if the game exits partway through,
+	// or the write fails, the previous version of the file is left untouched.
+	bool WriteAtomically(const string &path, const string &contents, bool compress = false)
+	{
+		const string temporary = WriteTemporary(path, contents, compress);
+		if(temporary.empty())
+			return false;
+		Files::Move(temporary, path);
+		return true;
+	}
+
+	void WriteSave(const PendingSave &save)
+	{
+		if(save.isJournaled)
+		{
+			if(!journal || journal->Path() != save.path)
+				journal.reset(new SaveJournal(save.path));
+			isJournalCompressed = save.isCompressed;
+			if(journal->Append(save.contents))
+				return;
+		}
+
+		if(!save.date.empty() && SavedGame(save.path).GetDate() != save.date)
+		{
+			// Write the new save before moving the old one out of its way, so
+			// that the pilot's file is only missing for as short a time as
+			// possible, and the backups are left alone if it cannot be written.
+			const string temporary = WriteTemporary(save.path, save.contents, save.isCompressed);
+			if(temporary.empty())
+				return;
+
+			string root = save.path.substr(0, save.path.length() - 4);
+			const string rootPrevious = root + "~~previous-";
+			for(int i = save.previousCount - 1; i > 0; --i)
+			{
+				const string toMove = rootPrevious + to_string(i) + ".txt";
+				if(Files::Exists(toMove))
+					Files::Move(toMove, rootPrevious + to_string(i + 1) + ".txt");
+			}
+			if(Files::Exists(save.path))
+				Files::Move(save.path, rootPrevious + "1.txt");
+			Files::Move(temporary, save.path);
+			if(save.hasSpaceport)
+				WriteAtomically(rootPrevious + "spaceport.txt", save.contents, save.isCompressed);
+		}
+		else if(!WriteAtomically(save.path, save.contents, save.isCompressed))
+			return;
+		if(save.isJournaled)
+			journal->Restart(save.contents);
+
+		if(!save.globalConditionsPath.empty())
+			WriteAtomically(save.globalConditionsPath, save.globalConditions);
+	}
+
+	void StartSave(shared_ptr<const PendingSave> save)
+	{
+		lock_guard<mutex> lock(saveMutex);
+		shared_future<void> previous = lastSave;
+		lastSave = async(launch::async, [previous, save]() mutable -> void
+			{
+				if(previous.valid())
+					previous.wait();
+				WriteSave(*save);
+				// Don't keep this save (or the ones before it) in memory until the
+				// next save is started.
+				previous = shared_future<void>();
+				save.reset();
+			}).share();
+	}
 }
 
 
@@ -178,8 +368,10 @@ void PlayerInfo::New(const StartConditions &start)
 // Load player information from a saved game file.
 void PlayerInfo::Load(const string &path)
 {
-	// Make sure any previously loaded data is cleared.
+	// Make sure any previously loaded data is cleared, and that the file being
+	// loaded is not still being written.
 	Clear();
+	FinishSaving();
 
 	// A listing of missions and the ships where their cargo or passengers were when the game was saved.
 	// Missions and ships are referred to by string UUIDs.
@@ -203,7 +395,8 @@ void PlayerInfo::Load(const string &path)
 	// Register derived conditions now, so old primary versions can load into them.
 	RegisterDerivedConditions();
 
-	DataFile file(path);
+	DataFile file;
+	SaveJournal::Load(path, file);
 	for(const DataNode &child : file)
 	{
 		// Basic player information and persistent UI settings:
@@ -462,33 +655,54 @@ void PlayerInfo::Save() const
 	// Remember that this was the most recently saved player.
 	Files::Write(Files::Config() + "recent.txt", filePath + '\n');
 
+	// Only the text of the save is created here. Everything else, including
+	// rotating the backups, is done on another thread. Formatting the text takes
+	// about a millisecond per 100 kB of save, which is less than a frame even for
+	// a very large save, so it is not worth copying the player's state to do it
+	// on another thread as well.
+	shared_ptr<PendingSave> save = make_shared<PendingSave>();
+	save->path = filePath;
+	save->contents = SaveToString();
+	save->isCompressed = Preferences::Has("Compress saved games");
 	if(filePath.rfind(".txt") == filePath.length() - 4)
 	{
 		// Only update the backups if this save will have a newer date.
-		SavedGame saved(filePath);
-		if(saved.GetDate() != date.ToString())
-		{
-			string root = filePath.substr(0, filePath.length() - 4);
-			const int previousCount = Preferences::GetPreviousSaveCount();
-			const string rootPrevious = root + "~~previous-";
-			for(int i = previousCount - 1; i > 0; --i)
-			{
-				const string toMove = rootPrevious + to_string(i) + ".txt";
-				if(Files::Exists(toMove))
-					Files::Move(toMove, rootPrevious + to_string(i + 1) + ".txt");
-			}
-			if(Files::Exists(filePath))
-				Files::Move(filePath, rootPrevious + "1.txt");
-			if(planet->HasSpaceport())
-				Save(rootPrevious + "spaceport.txt");
-		}
+		save->date = date.ToString();
+		save->previousCount = Preferences::GetPreviousSaveCount();
+		save->hasSpaceport = planet && planet->HasSpaceport();
 	}
 
-	Save(filePath);
-
 	// Save global conditions:
-	DataWriter globalConditions(Files::Config() + "global conditions.txt");
+	DataWriter globalConditions;
 	GameData::GlobalConditions().Save(globalConditions);
+	save->globalConditionsPath = Files::Config() + "global conditions.txt";
+	save->globalConditions = std::move(globalConditions).SaveToString();
+
+	StartSave(save);
+}
+
+
+
+// Wait until every save that has been started is written to disk, and replace
+// any autosave journal with a full copy of the save.
+void PlayerInfo::FinishSaving()
+{
+	shared_future<void> pending;
+	{
+		lock_guard<mutex> lock(saveMutex);
+		pending = lastSave;
+	}
+	if(pending.valid())
+		pending.wait();
+
+	// No other saves can be started while this thread is busy here, so the
+	// journal can safely be folded into its base.
+	if(journal && journal->HasChanges())
+	{
+		string contents = journal->Contents();
+		WriteAtomically(journal->Path(), contents, isJournalCompressed);
+		journal->Restart(contents);
+	}
 }
 
 
@@ -527,27 +741,15 @@ void PlayerInfo::FinishTransaction()
 // Apply the given set of changes to the game data.
 void PlayerInfo::AddChanges(list<DataNode> &changes)
 {
-	bool changedSystems = false;
 	for(const DataNode &change : changes)
 	{
-		changedSystems |= (change.Token(0) == "system");
-		changedSystems |= (change.Token(0) == "link");
-		changedSystems |= (change.Token(0) == "unlink");
+		hasChangedSystems |= (change.Token(0) == "system");
+		hasChangedSystems |= (change.Token(0) == "link");
+		hasChangedSystems |= (change.Token(0) == "unlink");
 		GameData::Change(change);
 	}
-	if(changedSystems)
-	{
-		// Recalculate what systems have been seen.
-		GameData::UpdateSystems();
-		seen.clear();
-		for(const System *system : visitedSystems)
-		{
-			seen.insert(system);
-			for(const System *neighbor : system->VisibleNeighbors())
-				if(!neighbor->Hidden() || system->Links().count(neighbor))
-					seen.insert(neighbor);
-		}
-	}
+	if(!isBatchingChanges)
+		FinishChanges();
 
 	// Only move the changes into my list if they are not already there.
 	if(&changes != &dataChanges)
@@ -678,7 +880,9 @@ void PlayerInfo::IncrementDate()
 {
 	++date;
 
-	// Check if any special events should happen today.
+	// Check if any special events should happen today. If several of them
+	// change the star map, it only needs to be recalculated once.
+	isBatchingChanges = true;
 	auto it = gameEvents.begin();
 	while(it != gameEvents.end())
 	{
@@ -690,6 +894,8 @@ void PlayerInfo::IncrementDate()
 			it = gameEvents.erase(it);
 		}
 	}
+	isBatchingChanges = false;
+	FinishChanges();
 
 	// Check if any missions have failed because of deadlines and
 	// do any daily mission actions for those that have not failed.
@@ -2244,8 +2450,7 @@ void PlayerInfo::Unvisit(const Planet &planet)
 
 bool PlayerInfo::HasMapped(int mapSize) const
 {
-	DistanceMap distance(GetSystem(), mapSize);
-	for(const System *system : distance.Systems())
+	for(const System *system : DistanceMap::Cached(GetSystem(), mapSize)->Systems())
 		if(!HasVisited(*system))
 			return false;
 
@@ -2256,8 +2461,7 @@ bool PlayerInfo::HasMapped(int mapSize) const
 
 void PlayerInfo::Map(int mapSize)
 {
-	DistanceMap distance(GetSystem(), mapSize);
-	for(const System *system : distance.Systems())
+	for(const System *system : DistanceMap::Cached(GetSystem(), mapSize)->Systems())
 		if(!HasVisited(*system))
 			Visit(*system);
 	return;
@@ -2753,6 +2957,28 @@ void PlayerInfo::ApplyChanges()
 
 
 
+// Once a batch of changes has been applied, update the star map (and which
+// systems the player has seen) if any of them changed systems or links.
+void PlayerInfo::FinishChanges()
+{
+	if(!hasChangedSystems)
+		return;
+	hasChangedSystems = false;
+
+	// Recalculate what systems have been seen.
+	GameData::UpdateSystems();
+	seen.clear();
+	for(const System *system : visitedSystems)
+	{
+		seen.insert(system);
+		for(const System *neighbor : system->VisibleNeighbors())
+			if(!neighbor->Hidden() || system->Links().count(neighbor))
+				seen.insert(neighbor);
+	}
+}
+
+
+
 // Make change's to the player's planet, system, & ship locations as needed, to ensure the player and
 // their ships are in valid locations, even if the player did something drastic, such as remove a mod.
 void PlayerInfo::ValidateLoad()
@@ -3404,10 +3630,10 @@ void PlayerInfo::RegisterDerivedConditions()
 		if(!origin)
 			return -1;
 
-		auto distanceMap = DistanceMap(origin);
-		if(!distanceMap.HasRoute(destination))
+		shared_ptr<const DistanceMap> distanceMap = DistanceMap::Cached(origin);
+		if(!distanceMap->HasRoute(destination))
 			return -1;
-		return distanceMap.Days(destination);
+		return distanceMap->Days(destination);
 	};
 
 	auto &&hyperjumpsToSystemProvider = conditions.GetProviderPrefixed("hyperjumps to system: ");
@@ -3504,27 +3730,19 @@ void PlayerInfo::CreateMissions()
 {
 	boardingMissions.clear();
 
-	// Check for available missions.
+	// Check for available missions. Only the missions whose source filter
+	// could possibly match this planet need to be checked. They are checked on
+	// several threads, so anything about the player that is only figured out
+	// when first asked for must be figured out beforehand.
 	bool skipJobs = planet && !planet->IsInhabited();
 	bool hasPriorityMissions = false;
-	for(const auto &it : GameData::Missions())
+	Flagship();
+	for(Mission &mission : OfferMissions(GameData::MissionOffers().Candidates(planet, !skipJobs), *this))
 	{
-		if(it.second.IsAtLocation(Mission::BOARDING) || it.second.IsAtLocation(Mission::ASSISTING))
-			continue;
-		if(skipJobs && it.second.IsAtLocation(Mission::JOB))
-			continue;
-
-		if(it.second.CanOffer(*this))
-		{
-			list<Mission> &missions =
-				it.second.IsAtLocation(Mission::JOB) ? availableJobs : availableMissions;
-
-			missions.push_back(it.second.Instantiate(*this));
-			if(missions.back().HasFailed(*this))
-				missions.pop_back();
-			else if(!it.second.IsAtLocation(Mission::JOB))
-				hasPriorityMissions |= missions.back().HasPriority();
-		}
+		bool isJob = mission.IsAtLocation(Mission::JOB);
+		if(!isJob)
+			hasPriorityMissions |= mission.HasPriority();
+		(isJob ? availableJobs : availableMissions).push_back(std::move(mission));
 	}
 
 	// If any of the available missions are "priority" missions, no other
@@ -3785,27 +4003,54 @@ void PlayerInfo::Autosave() const
 	if(!CanBeSaved() || filePath.length() < 4)
 		return;
 
-	string path = filePath.substr(0, filePath.length() - 4) + "~autosave.txt";
-	Save(path);
+	shared_ptr<PendingSave> save = make_shared<PendingSave>();
+	save->path = filePath.substr(0, filePath.length() - 4) + "~autosave.txt";
+	// As in Save(), only the text is created on this thread.
+	save->contents = SaveToString();
+	save->isCompressed = Preferences::Has("Compress saved games");
+	save->isJournaled = true;
+	StartSave(save);
 }
 
 
 
-void PlayerInfo::Save(const string &filePath) const
+// Get the contents of this player's saved game.
+string PlayerInfo::SaveToString() const
 {
 	if(transactionSnapshot)
-		transactionSnapshot->SaveToPath(filePath);
-	else
-	{
-		DataWriter out(filePath);
-		Save(out);
-	}
+		return transactionSnapshot->SaveToString();
+
+	DataWriter out;
+	Save(out);
+	return std::move(out).SaveToString();
 }
 
 
 
 void PlayerInfo::Save(DataWriter &out) const
 {
+	// A summary of the pilot, so that the load panel does not need to read the
+	// entire file:
+	out.Write("summary");
+	out.BeginChild();
+	{
+		out.Write("pilot", firstName, lastName);
+		out.Write("date", date.Day(), date.Month(), date.Year());
+		if(system)
+			out.Write("system", system->Name());
+		if(planet)
+			out.Write("planet", planet->TrueName());
+		out.Write("playtime", playTime);
+		out.Write("credits", accounts.Credits());
+		if(flagship)
+		{
+			out.Write("flagship", flagship->Name());
+			if(flagship->GetSprite())
+				out.Write("flagship sprite", flagship->GetSprite()->Name());
+		}
+	}
+	out.EndChild();
+
 	// Basic player information and persistent UI settings:
 
 	// Pilot information:
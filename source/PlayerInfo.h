@@ -83,8 +83,12 @@ public:
 	void Load(const std::string &path);
 	// Load the most recently saved player. If no save could be loaded, returns false.
 	bool LoadRecent();
-	// Save this player (using the Identifier() as the file name).
+	// Save this player (using the Identifier() as the file name). The save is
+	// written to disk on another thread, after any other saves in progress.
 	void Save() const;
+	// Wait until every save that has been started is written to disk, and
+	// replace any autosave journal with a full copy of the save.
+	static void FinishSaving();
 
 	// Get the root filename used for this player's saved game files. (If there
 	// are multiple pilots with the same name it may have a digit appended.)
@@ -315,6 +319,9 @@ public:
 private:
 	// Apply any "changes" saved in this player info to the global game state.
 	void ApplyChanges();
+	// Once a batch of changes has been applied, update the star map (and which
+	// systems the player has seen) if any of them changed systems or links.
+	void FinishChanges();
 	// After loading & applying changes, make sure the player & ship locations are sensible.
 	void ValidateLoad();
 	// Helper to register derived conditions.
@@ -324,7 +331,8 @@ private:
 	void CreateMissions();
 	void StepMissions(UI *ui);
 	void Autosave() const;
-	void Save(const std::string &path) const;
+	// Get the contents of this player's saved game.
+	std::string SaveToString() const;
 	void Save(DataWriter &out) const;
 
 	// Check for and apply any punitive actions from planetary security.
@@ -410,6 +418,9 @@ private:
 	std::vector<std::pair<const Government *, double>> reputationChanges;
 	std::list<DataNode> dataChanges;
 	DataNode economy;
+	// While applying several events at once, the star map is only updated once.
+	bool isBatchingChanges = false;
+	bool hasChangedSystems = false;
 	// Persons that have been killed in this player's universe:
 	std::vector<std::string> destroyedPersons;
 	// Events that are going to happen some time in the future:
@@ -25,6 +25,8 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Screen.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <map>
 
 using namespace std;
@@ -59,6 +61,11 @@ namespace {
 	const vector<string> PARALLAX_SETTINGS = {"off", "fancy", "fast"};
 	int parallaxIndex = 2;
 
+	// By default, all sprites stay loaded, as they always have.
+	const vector<string> TEXTURE_MEMORY_SETTINGS = {"unlimited", "512 MB", "1 GB", "2 GB", "4 GB"};
+	const vector<size_t> TEXTURE_MEMORY_MEGABYTES = {0, 512, 1024, 2048, 4096};
+	int textureMemoryIndex = 0;
+
 	const vector<string> ALERT_INDICATOR_SETTING = {"off", "audio", "visual", "both"};
 	int alertIndicatorIndex = 3;
 
@@ -86,6 +93,7 @@ void Preferences::Load()
 	settings["Hide unexplored map regions"] = true;
 	settings["Turrets focus fire"] = true;
 	settings["Ship outlines in shops"] = true;
+	settings["Cache decoded images"] = false;
 
 	DataFile prefs(Files::Config() + "preferences.txt");
 	for(const DataNode &node : prefs)
@@ -108,6 +116,8 @@ void Preferences::Load()
 			autoAimIndex = max<int>(0, min<int>(node.Value(1), AUTO_AIM_SETTINGS.size() - 1));
 		else if(node.Token(0) == "Parallax background")
 			parallaxIndex = max<int>(0, min<int>(node.Value(1), PARALLAX_SETTINGS.size() - 1));
+		else if(node.Token(0) == "texture memory")
+			textureMemoryIndex = max<int>(0, min<int>(node.Value(1), TEXTURE_MEMORY_SETTINGS.size() - 1));
 		else if(node.Token(0) == "fullscreen")
 			screenModeIndex = max<int>(0, min<int>(node.Value(1), SCREEN_MODE_SETTINGS.size() - 1));
 		else if(node.Token(0) == "alert indicator")
@@ -147,6 +157,7 @@ void Preferences::Save()
 	out.Write("vsync", vsyncIndex);
 	out.Write("Automatic aiming", autoAimIndex);
 	out.Write("Parallax background", parallaxIndex);
+	out.Write("texture memory", textureMemoryIndex);
 	out.Write("alert indicator", alertIndicatorIndex);
 	out.Write("previous saves", previousSaveCount);
 
@@ -272,6 +283,33 @@ const string &Preferences::ParallaxSetting()
 
 
 
+void Preferences::ToggleTextureMemory()
+{
+	int targetIndex = textureMemoryIndex + 1;
+	if(targetIndex == static_cast<int>(TEXTURE_MEMORY_SETTINGS.size()))
+		targetIndex = 0;
+	textureMemoryIndex = targetIndex;
+}
+
+
+
+size_t Preferences::TextureMemoryBudget()
+{
+	// On 32-bit systems, the larger budgets do not fit in a size_t. Since all
+	// of memory is then within the budget anyway, use the largest size there is.
+	uint64_t bytes = static_cast<uint64_t>(TEXTURE_MEMORY_MEGABYTES[textureMemoryIndex]) << 20;
+	return static_cast<size_t>(min<uint64_t>(bytes, numeric_limits<size_t>::max()));
+}
+
+
+
+const string &Preferences::TextureMemorySetting()
+{
+	return TEXTURE_MEMORY_SETTINGS[textureMemoryIndex];
+}
+
+
+
 void Preferences::ToggleScreenMode()
 {
 	GameWindow::ToggleFullscreen();
@@ -95,6 +95,13 @@ public:
 	static BackgroundParallax GetBackgroundParallax();
 	static const std::string &ParallaxSetting();
 
+	// Texture memory setting, either "unlimited" or the most memory that sprite
+	// textures may use before the least recently drawn ones are unloaded.
+	static void ToggleTextureMemory();
+	// Get the texture memory budget in bytes, or 0 if it is unlimited.
+	static size_t TextureMemoryBudget();
+	static const std::string &TextureMemorySetting();
+
 	// Boarding target setting, either "proximity", "value" or "mixed".
 	static void ToggleBoarding();
 	static BoardingPriority GetBoardingPriority();
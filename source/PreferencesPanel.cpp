@@ -64,6 +64,7 @@ namespace {
 	const string SHIP_OUTLINES = "Ship outlines in shops";
 	const string BOARDING_PRIORITY = "Boarding target priority";
 	const string BACKGROUND_PARALLAX = "Parallax background";
+	const string TEXTURE_MEMORY = "Texture memory";
 	const string ALERT_INDICATOR = "Alert indicator";
 
 	// How many pages of settings there are.
@@ -192,6 +193,8 @@ bool PreferencesPanel::Click(int x, int y, int clicks)
 				Preferences::ToggleBoarding();
 			else if(zone.Value() == BACKGROUND_PARALLAX)
 				Preferences::ToggleParallax();
+			else if(zone.Value() == TEXTURE_MEMORY)
+				Preferences::ToggleTextureMemory();
 			else if(zone.Value() == VIEW_ZOOM_FACTOR)
 			{
 				// Increase the zoom factor unless it is at the maximum. In that
@@ -509,6 +512,8 @@ void PreferencesPanel::DrawSettings()
 		BACKGROUND_PARALLAX,
 		"Show hyperspace flash",
 		SHIP_OUTLINES,
+		TEXTURE_MEMORY,
+		"Cache decoded images",
 		"",
 		"Other",
 		"Clickable radar display",
@@ -520,7 +525,8 @@ void PreferencesPanel::DrawSettings()
 		"Show escort systems on map",
 		"Show stored outfits on map",
 		"System map sends move orders",
-		ALERT_INDICATOR
+		ALERT_INDICATOR,
+		"Compress saved games"
 	};
 	bool isCategory = true;
 	int page = 0;
@@ -620,6 +626,11 @@ void PreferencesPanel::DrawSettings()
 			text = Preferences::ParallaxSetting();
 			isOn = text != "off";
 		}
+		else if(setting == TEXTURE_MEMORY)
+		{
+			isOn = true;
+			text = Preferences::TextureMemorySetting();
+		}
 		else if(setting == REACTIVATE_HELP)
 		{
 			// Check how many help messages have been displayed.
@@ -0,0 +1,113 @@
+/* ResidencyTracker.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "ResidencyTracker.h"
+
+#include <algorithm>
+
+using namespace std;
+
+
+
+// Resources that have been used more recently than the given time are never
+// unloaded, even if that means going over the budget.
+ResidencyTracker::ResidencyTracker(long long minIdleTime)
+	: minIdleTime(minIdleTime)
+{
+}
+
+
+
+// Start tracking a resource, which is not loaded yet. Returns its index.
+size_t ResidencyTracker::Add()
+{
+	entries.emplace_back();
+	return entries.size() - 1;
+}
+
+
+
+// Note that the given resource has been loaded and uses the given memory.
+void ResidencyTracker::Load(size_t index, size_t size, long long now)
+{
+	Entry &entry = entries[index];
+	if(entry.isLoaded)
+		memory -= entry.size;
+	entry.size = size;
+	entry.lastUsed = now;
+	entry.isLoaded = true;
+	memory += size;
+}
+
+
+
+// Note that the given resource was used at the given time.
+void ResidencyTracker::Use(size_t index, long long now)
+{
+	entries[index].lastUsed = max(entries[index].lastUsed, now);
+}
+
+
+
+bool ResidencyTracker::IsLoaded(size_t index) const
+{
+	return entries[index].isLoaded;
+}
+
+
+
+// Get the memory used by all the loaded resources.
+size_t ResidencyTracker::Memory() const
+{
+	return memory;
+}
+
+
+
+// If the given budget is exceeded, unload the resources that have gone unused
+// the longest until the rest fit.
+vector<size_t> ResidencyTracker::Evict(size_t budget, long long now)
+{
+	vector<size_t> evicted;
+	if(!budget || memory <= budget)
+		return evicted;
+
+	// Resources that take up no memory are not worth unloading.
+	vector<size_t> idle;
+	for(size_t i = 0; i < entries.size(); ++i)
+	{
+		const Entry &entry = entries[i];
+		if(entry.isLoaded && entry.size && now - entry.lastUsed >= minIdleTime)
+			idle.push_back(i);
+	}
+	// Keep resources that were last used at the same time in the order they
+	// were added, so the result does not depend on how the sort is done.
+	stable_sort(idle.begin(), idle.end(), [this](size_t a, size_t b) -> bool
+		{
+			return entries[a].lastUsed < entries[b].lastUsed;
+		});
+
+	for(size_t i : idle)
+	{
+		if(memory <= budget)
+			break;
+
+		Entry &entry = entries[i];
+		entry.isLoaded = false;
+		memory -= entry.size;
+		evicted.push_back(i);
+	}
+	return evicted;
+}
@@ -0,0 +1,68 @@
+/* ResidencyTracker.h
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef RESIDENCY_TRACKER_H_
+#define RESIDENCY_TRACKER_H_
+
+#include <cstddef>
+#include <vector>
+
+
+
+// Class that decides which resources to unload when they use too much memory,
+// e.g. the textures of sprites. Each resource is referred to by its index, in
+// the order it was added. The times that are passed in may be in any unit, as
+// long as they never go backwards and the idle time uses the same unit.
+class ResidencyTracker {
+public:
+	// Resources that have been used more recently than the given time are
+	// never unloaded, even if that means going over the budget.
+	explicit ResidencyTracker(long long minIdleTime);
+
+	// Start tracking a resource, which is not loaded yet. Returns its index.
+	size_t Add();
+	// Note that the given resource has been loaded and uses the given memory.
+	void Load(size_t index, size_t size, long long now);
+	// Note that the given resource was used at the given time.
+	void Use(size_t index, long long now);
+
+	bool IsLoaded(size_t index) const;
+	// Get the memory used by all the loaded resources.
+	size_t Memory() const;
+
+	// If the given budget is exceeded, unload the resources that have gone
+	// unused the longest until the rest fit, and return their indices in the
+	// order they were unloaded. A budget of zero means there is no limit.
+	std::vector<size_t> Evict(size_t budget, long long now);
+
+
+private:
+	class Entry {
+	public:
+		size_t size = 0;
+		long long lastUsed = 0;
+		bool isLoaded = false;
+	};
+
+
+private:
+	long long minIdleTime;
+	std::vector<Entry> entries;
+	size_t memory = 0;
+};
+
+
+
+#endif
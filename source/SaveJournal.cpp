@@ -0,0 +1,353 @@
+/* SaveJournal.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "SaveJournal.h"
+
+#include "DataFile.h"
+#include "Files.h"
+#include "Gzip.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+	// Rather than letting the journal grow to more than half the size of the
+	// base, a new base is written.
+	const size_t MAX_JOURNAL_FRACTION = 2;
+	// Copying a single line from the previous save takes more space than just
+	// writing it again, unless it is at least this long.
+	const size_t MIN_COPIED_LENGTH = 16;
+
+	// A journal begins with a line identifying the base it applies to, so that
+	// a journal for an old base is never applied to a newer one.
+	string Header(const string &base)
+	{
+		// This is the 64-bit FNV-1a hash.
+		uint64_t hash = 14695981039346656037ull;
+		for(char c : base)
+			hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+		return "journal " + to_string(base.size()) + " " + to_string(hash) + "\n";
+	}
+
+	vector<string> SplitLines(const string &text)
+	{
+		vector<string> lines;
+		size_t start = 0;
+		while(start < text.length())
+		{
+			size_t end = text.find('\n', start);
+			if(end == string::npos)
+				end = text.length();
+			lines.emplace_back(text, start, end - start);
+			start = end + 1;
+		}
+		return lines;
+	}
+
+	string JoinLines(const vector<string> &lines)
+	{
+		size_t size = 0;
+		for(const string &line : lines)
+			size += line.length() + 1;
+
+		string text;
+		text.reserve(size);
+		for(const string &line : lines)
+		{
+			text += line;
+			text += '\n';
+		}
+		return text;
+	}
+
+	// Get the next line of the journal. A line that does not end in a newline
+	// was cut off while being written, so it is not returned.
+	bool NextLine(const string &journal, size_t &pos, string &line)
+	{
+		size_t end = journal.find('\n', pos);
+		if(end == string::npos)
+			return false;
+
+		line.assign(journal, pos, end - pos);
+		pos = end + 1;
+		return true;
+	}
+
+	// Apply the next entry in the journal to the given lines. Return false if
+	// the journal ends before the entry is complete, in which case the lines
+	// are left unchanged.
+	bool ApplyEntry(const string &journal, size_t &pos, vector<string> &lines)
+	{
+		vector<string> result;
+		string line;
+		while(NextLine(journal, pos, line))
+		{
+			if(line == ".")
+			{
+				lines.swap(result);
+				return true;
+			}
+			if(line.length() < 3 || line[1] != ' ')
+				return false;
+
+			char *end = nullptr;
+			size_t first = strtoull(line.c_str() + 2, &end, 10);
+			if(line[0] == '=')
+			{
+				// Copy a run of lines from the previous version of the save.
+				size_t count = strtoull(end, nullptr, 10);
+				if(first > lines.size() || count > lines.size() - first)
+					return false;
+				result.insert(result.end(), lines.begin() + first, lines.begin() + first + count);
+			}
+			else if(line[0] == '+')
+			{
+				// The given number of new lines follow.
+				for(size_t i = 0; i < first; ++i)
+				{
+					if(!NextLine(journal, pos, line))
+						return false;
+					result.push_back(line);
+				}
+			}
+			else
+				return false;
+		}
+		return false;
+	}
+
+	// Describe how to turn one version of a save into the next: as runs of
+	// lines that can be copied from the previous version, and new lines.
+	string Diff(const vector<string> &before, const unordered_map<string, vector<size_t>> &positions,
+		const vector<string> &after)
+	{
+		string entry;
+		size_t added = 0;
+		auto addLines = [&entry, &added, &after](size_t end)
+		{
+			if(!added)
+				return;
+			entry += "+ " + to_string(added) + "\n";
+			for(size_t i = end - added; i < end; ++i)
+			{
+				entry += after[i];
+				entry += '\n';
+			}
+			added = 0;
+		};
+
+		// Where the next line is most likely to be found: right after the run
+		// of lines that was copied most recently.
+		size_t next = 0;
+		for(size_t i = 0; i < after.size(); )
+		{
+			size_t start = before.size();
+			if(next < before.size() && before[next] == after[i])
+				start = next;
+			else
+			{
+				// If this line appears more than once, use the first place it
+				// appears after the previous run.
+				auto it = positions.find(after[i]);
+				if(it != positions.end())
+				{
+					auto pos = lower_bound(it->second.begin(), it->second.end(), next);
+					start = (pos == it->second.end() ? it->second.front() : *pos);
+				}
+			}
+
+			size_t count = 0;
+			while(start + count < before.size() && i + count < after.size()
+					&& before[start + count] == after[i + count])
+				++count;
+
+			if(count > 1 || (count && after[i].length() >= MIN_COPIED_LENGTH))
+			{
+				addLines(i);
+				entry += "= " + to_string(start) + " " + to_string(count) + "\n";
+				next = start + count;
+				i += count;
+			}
+			else
+			{
+				++added;
+				++i;
+			}
+		}
+		addLines(after.size());
+		entry += ".\n";
+		return entry;
+	}
+
+	unordered_map<string, vector<size_t>> FindPositions(const vector<string> &lines)
+	{
+		unordered_map<string, vector<size_t>> positions;
+		for(size_t i = 0; i < lines.size(); ++i)
+			positions[lines[i]].push_back(i);
+		return positions;
+	}
+}
+
+
+
+// Get the path of the journal that belongs to the given saved game.
+string SaveJournal::JournalPath(const string &path)
+{
+	return path.substr(0, path.rfind(".txt")) + ".journal";
+}
+
+
+
+// Get the text of the given saved game, including any changes recorded in its
+// journal.
+string SaveJournal::Read(const string &path)
+{
+	string base = Files::Read(path);
+	if(Gzip::IsCompressed(base))
+		base = Gzip::Decompress(base);
+
+	const string journalPath = JournalPath(path);
+	if(!Files::Exists(journalPath))
+		return base;
+
+	// If the journal belongs to a different version of the base, the base was
+	// replaced by a newer one before the journal could be restarted.
+	string journal = Files::Read(journalPath);
+	const string header = Header(base);
+	if(journal.compare(0, header.length(), header))
+		return base;
+
+	vector<string> lines = SplitLines(base);
+	size_t pos = header.length();
+	bool hasChanges = false;
+	while(ApplyEntry(journal, pos, lines))
+		hasChanges = true;
+	return hasChanges ? JoinLines(lines) : base;
+}
+
+
+
+// Load the given saved game, including any changes in its journal.
+void SaveJournal::Load(const string &path, DataFile &file)
+{
+	if(!Files::Exists(JournalPath(path)))
+	{
+		file.Load(path);
+		return;
+	}
+
+	istringstream in(Read(path));
+	file.Load(in);
+}
+
+
+
+// Copy a saved game, including the changes in its journal.
+void SaveJournal::Copy(const string &from, const string &to)
+{
+	if(Files::Exists(JournalPath(from)))
+		Files::Write(to, Read(from));
+	else
+		Files::Copy(from, to);
+}
+
+
+
+// Delete a saved game and its journal.
+void SaveJournal::Delete(const string &path)
+{
+	Files::Delete(path);
+	const string journalPath = JournalPath(path);
+	if(Files::Exists(journalPath))
+		Files::Delete(journalPath);
+}
+
+
+
+SaveJournal::SaveJournal(const string &path)
+	: path(path)
+{
+}
+
+
+
+const string &SaveJournal::Path() const
+{
+	return path;
+}
+
+
+
+// Record the given contents as changes to the previous contents, if possible.
+bool SaveJournal::Append(const string &contents)
+{
+	// If either file has been removed since the journal was started, the
+	// journal cannot be used any more.
+	const string journalPath = JournalPath(path);
+	if(!hasBase || !Files::Exists(path) || (journalSize && !Files::Exists(journalPath)))
+		return false;
+
+	vector<string> next = SplitLines(contents);
+	string entry = Diff(lines, positions, next);
+	if((journalSize + entry.length()) * MAX_JOURNAL_FRACTION > baseSize)
+		return false;
+
+	// The journal file is only created once there is something to put in it.
+	if(journalSize)
+		Files::Append(journalPath, entry);
+	else
+		Files::Write(journalPath, header + entry);
+	journalSize += entry.length();
+	lines.swap(next);
+	positions = FindPositions(lines);
+	return true;
+}
+
+
+
+// Begin a new journal for the base that was just written.
+void SaveJournal::Restart(const string &contents)
+{
+	const string journalPath = JournalPath(path);
+	if(Files::Exists(journalPath))
+		Files::Delete(journalPath);
+	header = Header(contents);
+	lines = SplitLines(contents);
+	positions = FindPositions(lines);
+	baseSize = contents.length();
+	journalSize = 0;
+	hasBase = true;
+}
+
+
+
+// Check if the journal contains changes that are not in the base.
+bool SaveJournal::HasChanges() const
+{
+	return journalSize != 0;
+}
+
+
+
+// Get the current contents of the saved game.
+string SaveJournal::Contents() const
+{
+	return JoinLines(lines);
+}
@@ -0,0 +1,86 @@
+/* SaveJournal.h
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SAVE_JOURNAL_H_
+#define SAVE_JOURNAL_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class DataFile;
+
+
+
+// Class for saving a game over and over again, e.g. for autosaves, without
+// rewriting the whole file each time. A full copy of the save (the "base") is
+// written only now and then. In between, each save just adds a list of the
+// lines that differ from the save before it to a journal file next to the
+// base. Loading the save replays those changes on top of the base.
+class SaveJournal {
+public:
+	// Get the path of the journal that belongs to the given saved game.
+	static std::string JournalPath(const std::string &path);
+	// Get the text of the given saved game, including any changes recorded in
+	// its journal. Changes that were only partly written are ignored.
+	static std::string Read(const std::string &path);
+	// Load the given saved game, including any changes in its journal.
+	static void Load(const std::string &path, DataFile &file);
+	// Copy a saved game. The copy has no journal; any changes in the
+	// original's journal are included in it instead.
+	static void Copy(const std::string &from, const std::string &to);
+	// Delete a saved game and its journal.
+	static void Delete(const std::string &path);
+
+public:
+	// Create a journal for the saved game with the given path. Until Restart()
+	// is called, no base has been written for it.
+	explicit SaveJournal(const std::string &path);
+
+	const std::string &Path() const;
+	// Record the given contents of the saved game as changes to the previous
+	// contents. This fails if there is no base yet, or if the journal would
+	// become too large compared to it; in that case the caller must write the
+	// contents as a new base and then call Restart().
+	bool Append(const std::string &contents);
+	// Begin a new, empty journal, now that the given contents have been
+	// written as the saved game's base. The journal file itself is deleted
+	// until there are changes to write to it.
+	void Restart(const std::string &contents);
+
+	// Check if the journal contains changes that are not in the base.
+	bool HasChanges() const;
+	// Get the current contents of the saved game, e.g. to write a new base.
+	std::string Contents() const;
+
+
+private:
+	// The path of the saved game.
+	std::string path;
+	// The lines of the most recent save, and where each of them appears.
+	std::vector<std::string> lines;
+	std::unordered_map<std::string, std::vector<size_t>> positions;
+	// The first line of the journal, which identifies the base.
+	std::string header;
+	// The sizes of the base and of the changes written to the journal so far.
+	size_t baseSize = 0;
+	size_t journalSize = 0;
+	bool hasBase = false;
+};
+
+
+
+#endif
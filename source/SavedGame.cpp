@@ -18,11 +18,57 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "DataFile.h"
 #include "DataNode.h"
 #include "Date.h"
+#include "File.h"
+#include "Files.h"
 #include "text/Format.h"
+#include "Gzip.h"
+#include "SaveJournal.h"
 #include "SpriteSet.h"
 
+#include <sstream>
+#include <vector>
+
 using namespace std;
 
+namespace {
+	// The summary at the start of a saved game is much shorter than this.
+	const size_t SUMMARY_SIZE = 4096;
+
+	// Read only the "summary" node at the start of the given saved game. If the
+	// file does not begin with one, return false.
+	bool LoadSummary(const string &path, DataFile &summary)
+	{
+		File file(path);
+		if(!file)
+			return false;
+		string data(SUMMARY_SIZE, '\0');
+		data.resize(fread(&data[0], 1, data.size(), file));
+		// If the whole file fit in the buffer, the summary cannot be cut off.
+		bool isWholeFile = (data.size() < SUMMARY_SIZE);
+		if(Gzip::IsCompressed(data))
+			data = Gzip::Decompress(data, SUMMARY_SIZE);
+		if(data.compare(0, 8, "summary\n"))
+			return false;
+
+		// The summary ends at the first line that is not indented.
+		size_t end = 8;
+		while(end < data.size() && (data[end] == '\t' || data[end] == ' '))
+		{
+			end = data.find('\n', end);
+			if(end == string::npos)
+				return false;
+			++end;
+		}
+		// If the summary is cut off, read the whole file after all.
+		if(end == data.size() && !isWholeFile)
+			return false;
+
+		istringstream in(data.substr(0, end));
+		summary.Load(in);
+		return true;
+	}
+}
+
 
 
 SavedGame::SavedGame(const string &path)
@@ -35,15 +81,32 @@ SavedGame::SavedGame(const string &path)
 void SavedGame::Load(const string &path)
 {
 	Clear();
-	DataFile file(path);
+	DataFile file;
+	// The summary at the start of the file is out of date if the file has a
+	// journal of changes.
+	if(Files::Exists(SaveJournal::JournalPath(path)) || !LoadSummary(path, file))
+		SaveJournal::Load(path, file);
 	if(file.begin() != file.end())
 		this->path = path;
 
+	// The summary contains the same nodes that older saves have at the top
+	// level, except that the credits and flagship are given directly.
+	vector<const DataNode *> nodes;
+	for(const DataNode &node : file)
+	{
+		if(node.Token(0) == "summary")
+			for(const DataNode &child : node)
+				nodes.push_back(&child);
+		else
+			nodes.push_back(&node);
+	}
+
 	int flagshipIterator = -1;
 	int flagshipTarget = 0;
 
-	for(const DataNode &node : file)
+	for(const DataNode *it : nodes)
 	{
+		const DataNode &node = *it;
 		if(node.Token(0) == "pilot" && node.Size() >= 3)
 			name = node.Token(1) + " " + node.Token(2);
 		else if(node.Token(0) == "date" && node.Size() >= 4)
@@ -56,6 +119,12 @@ void SavedGame::Load(const string &path)
 			playTime = Format::PlayTime(node.Value(1));
 		else if(node.Token(0) == "flagship index" && node.Size() >= 2)
 			flagshipTarget = node.Value(1);
+		else if(node.Token(0) == "credits" && node.Size() >= 2)
+			credits = Format::Credits(node.Value(1));
+		else if(node.Token(0) == "flagship" && node.Size() >= 2)
+			shipName = node.Token(1);
+		else if(node.Token(0) == "flagship sprite" && node.Size() >= 2)
+			shipSprite = node.Token(1);
 		else if(node.Token(0) == "account")
 		{
 			for(const DataNode &child : node)
@@ -72,7 +141,7 @@ void SavedGame::Load(const string &path)
 				if(child.Token(0) == "name" && child.Size() >= 2)
 					shipName = child.Token(1);
 				else if(child.Token(0) == "sprite" && child.Size() >= 2)
-					shipSprite = SpriteSet::Get(child.Token(1));
+					shipSprite = child.Token(1);
 			}
 		}
 	}
@@ -106,7 +175,7 @@ void SavedGame::Clear()
 	planet.clear();
 	playTime = "0s";
 
-	shipSprite = nullptr;
+	shipSprite.clear();
 	shipName.clear();
 }
 
@@ -154,9 +223,11 @@ const string &SavedGame::GetPlayTime() const
 
 
 
+// The sprite is only looked up when it is needed, so that a saved game can
+// be read on any thread.
 const Sprite *SavedGame::ShipSprite() const
 {
-	return shipSprite;
+	return shipSprite.empty() ? nullptr : SpriteSet::Get(shipSprite);
 }
 
 
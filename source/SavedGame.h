@@ -26,7 +26,8 @@ class Sprite;
 // information necessary from the file to display it in the "Load Game" panel,
 // without doing all the complicated parsing that PlayerInfo does. This is so
 // that we only need to have one PlayerInfo instance, and there does not need
-// to be logic for copying one PlayerInfo into another.
+// to be logic for copying one PlayerInfo into another. Newer saved games begin
+// with a summary of this information, so only that part of them is read.
 class SavedGame {
 public:
 	SavedGame() = default;
@@ -60,7 +61,7 @@ private:
 	std::string planet;
 	std::string playTime;
 
-	const Sprite *shipSprite = nullptr;
+	std::string shipSprite;
 	std::string shipName;
 };
 
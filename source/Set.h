@@ -16,26 +16,40 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #ifndef SET_H_
 #define SET_H_
 
+#include <functional>
 #include <map>
 #include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
 
 
 
 // Template representing a set of named objects of a given type, where you can
 // query it for a pointer to any object and it will return one, whether or not that
-// object has been loaded yet. (This allows cyclic pointers.)
+// object has been loaded yet. (This allows cyclic pointers.) Objects are stored
+// in a sorted map, so iteration is always in order of their names, but lookups by
+// name go through a hash index that refers to the names and objects in that map.
 template<class Type>
 class Set {
 public:
+	Set() = default;
+	// The index points into the stored data, so a copy must build its own.
+	Set(const Set &other);
+	Set &operator=(const Set &other);
+	// Moving the map does not move the objects it holds, so the index stays valid.
+	Set(Set &&other) = default;
+	Set &operator=(Set &&other) = default;
+
 	// Allow non-const access to the owner of this set; it can hand off only
 	// const references to avoid anyone else modifying the objects.
-	Type *Get(const std::string &name) { return &data[name]; }
-	const Type *Get(const std::string &name) const { return &data[name]; }
+	Type *Get(const std::string &name) { return Insert(name); }
+	const Type *Get(const std::string &name) const { return Insert(name); }
 	// If an item already exists in this set, get it. Otherwise, return a null
 	// pointer rather than creating the item.
 	const Type *Find(const std::string &name) const;
 
-	bool Has(const std::string &name) const { return data.count(name); }
+	bool Has(const std::string &name) const { return index.count(name); }
 
 	typename std::map<std::string, Type>::iterator begin() { return data.begin(); }
 	typename std::map<std::string, Type>::const_iterator begin() const { return data.begin(); }
@@ -49,18 +63,73 @@ public:
 	// those that are in the given set, revert to their contents.
 	void Revert(const Set<Type> &other);
 
+	// Mark the current contents of this set as the state to restore later. No
+	// copies are made until an object is actually changed, so any changes made
+	// after this must go through Modify() rather than Get().
+	void Snapshot();
+	// Get an object in order to change it. If a snapshot has been taken, this
+	// saves a copy of the object the first time it is modified.
+	Type *Modify(const std::string &name);
+	// Check if any objects have been modified or added since the snapshot.
+	bool IsModified() const;
+	// Undo every change made since the snapshot by copying the saved objects
+	// back into place. Objects that Modify() added are reset to how they were
+	// before they were defined rather than removed, because something may still
+	// be pointing to them.
+	void RestoreSnapshot();
+
+
+private:
+	// Get the object with the given name, creating it if it does not exist yet.
+	Type *Insert(const std::string &name) const;
+	// Rebuild the index from scratch, e.g. after the data has been copied.
+	void Reindex();
+
 
 private:
 	mutable std::map<std::string, Type> data;
+	// The keys of the index refer to the names stored in the map, so each name
+	// is only stored once no matter how it is being looked up.
+	mutable std::unordered_map<std::reference_wrapper<const std::string>, Type *,
+		std::hash<std::string>, std::equal_to<std::string>> index;
+
+	// The original state of every object modified since the snapshot. For an
+	// object that Modify() created, this is the newly constructed object.
+	bool hasSnapshot = false;
+	std::map<std::string, Type> originals;
 };
 
 
 
+template <class Type>
+Set<Type>::Set(const Set &other)
+	: data(other.data), hasSnapshot(other.hasSnapshot), originals(other.originals)
+{
+	Reindex();
+}
+
+
+
+template <class Type>
+Set<Type> &Set<Type>::operator=(const Set &other)
+{
+	if(this != &other)
+	{
+		data = other.data;
+		hasSnapshot = other.hasSnapshot;
+		originals = other.originals;
+		Reindex();
+	}
+	return *this;
+}
+
+
+
 template <class Type>
 const Type *Set<Type>::Find(const std::string &name) const
 {
-	auto it = data.find(name);
-	return (it == data.end() ? nullptr : &it->second);
+	auto it = index.find(name);
+	return it == index.end() ? nullptr : it->second;
 }
 
 
@@ -74,7 +143,10 @@ void Set<Type>::Revert(const Set<Type> &other)
 	while(it != data.end())
 	{
 		if(oit == other.data.end() || it->first < oit->first)
+		{
+			index.erase(it->first);
 			it = data.erase(it);
+		}
 		else if(it->first == oit->first)
 		{
 			// If this is an entry that is in the set we are reverting to, copy
@@ -91,4 +163,71 @@ void Set<Type>::Revert(const Set<Type> &other)
 
 
 
+template <class Type>
+void Set<Type>::Snapshot()
+{
+	hasSnapshot = true;
+	originals.clear();
+}
+
+
+
+template <class Type>
+Type *Set<Type>::Modify(const std::string &name)
+{
+	Type *object = Insert(name);
+	if(hasSnapshot && !originals.count(name))
+		originals.emplace(name, *object);
+	return object;
+}
+
+
+
+template <class Type>
+bool Set<Type>::IsModified() const
+{
+	return !originals.empty();
+}
+
+
+
+template <class Type>
+void Set<Type>::RestoreSnapshot()
+{
+	// Objects are copied back into place rather than replaced, so any pointers
+	// to them remain valid.
+	for(const auto &it : originals)
+		*index.find(it.first)->second = it.second;
+	originals.clear();
+}
+
+
+
+template <class Type>
+Type *Set<Type>::Insert(const std::string &name) const
+{
+	auto it = index.find(name);
+	if(it != index.end())
+		return it->second;
+
+	// Construct the object in place, since not every type can be copied or moved.
+	auto &entry = *data.emplace(std::piecewise_construct, std::forward_as_tuple(name),
+		std::forward_as_tuple()).first;
+	index.emplace(entry.first, &entry.second);
+	return &entry.second;
+}
+
+
+
+template <class Type>
+void Set<Type>::Reindex()
+{
+	index.clear();
+	index.reserve(data.size());
+	for(auto &it : data)
+		index.emplace(it.first, &it.second);
+}
+
+
+
 #endif
@@ -0,0 +1,80 @@
+/* ShelfPacker.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "ShelfPacker.h"
+
+using namespace std;
+
+
+
+// Create a packer for the given number of layers of the given size.
+ShelfPacker::ShelfPacker(int size, int layers)
+	: size(size), layers(layers)
+{
+}
+
+
+
+// Find room for the given number of rectangles of the given size. If they do
+// not all fit, nothing is placed.
+bool ShelfPacker::Place(int width, int height, vector<Slot> &slots)
+{
+	if(width <= 0 || height <= 0 || width > size || height > size)
+		return false;
+
+	vector<Layer> layout = layers;
+	size_t layer = 0;
+	for(Slot &slot : slots)
+	{
+		while(layer < layers.size() && !Place(layers[layer], width, height, slot))
+			++layer;
+		if(layer == layers.size())
+		{
+			layers.swap(layout);
+			return false;
+		}
+		slot.layer = layer;
+	}
+	return true;
+}
+
+
+
+// Find room for one rectangle in the given layer.
+bool ShelfPacker::Place(Layer &layer, int width, int height, Slot &slot) const
+{
+	// Use the shortest shelf that the rectangle fits on, to waste as little
+	// space as possible.
+	Shelf *best = nullptr;
+	for(Shelf &shelf : layer.shelves)
+		if(shelf.height >= height && size - shelf.width >= width && (!best || shelf.height < best->height))
+			best = &shelf;
+	// If there is none, start a new shelf above the existing ones.
+	if(!best)
+	{
+		if(size - layer.height < height)
+			return false;
+		layer.shelves.emplace_back();
+		best = &layer.shelves.back();
+		best->y = layer.height;
+		best->height = height;
+		layer.height += height;
+	}
+
+	slot.x = best->width;
+	slot.y = best->y;
+	best->width += width;
+	return true;
+}
@@ -0,0 +1,79 @@
+/* ShelfPacker.h
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SHELF_PACKER_H_
+#define SHELF_PACKER_H_
+
+#include <vector>
+
+
+
+// Class for finding room for rectangles in a stack of square layers, e.g. the
+// layers of an array texture. Each layer is split into horizontal strips
+// ("shelves"), which are filled from left to right. This wastes a little space
+// compared to fancier methods, but is fast, and works well when most of the
+// rectangles that are packed together have similar heights.
+class ShelfPacker {
+public:
+	// Where a rectangle has been placed.
+	class Slot {
+	public:
+		int layer = 0;
+		int x = 0;
+		int y = 0;
+	};
+
+
+public:
+	// Create a packer for the given number of layers of the given size.
+	ShelfPacker(int size, int layers);
+
+	// Find room for the given number of rectangles of the given size, and fill
+	// in where each of them was placed. If they do not all fit, nothing is
+	// placed, and this returns false.
+	bool Place(int width, int height, std::vector<Slot> &slots);
+
+
+private:
+	// A horizontal strip of a layer, into which rectangles are packed.
+	class Shelf {
+	public:
+		int y = 0;
+		int height = 0;
+		// How much of the width of the shelf has been used so far.
+		int width = 0;
+	};
+
+	class Layer {
+	public:
+		std::vector<Shelf> shelves;
+		// How much of the height of the layer the shelves take up.
+		int height = 0;
+	};
+
+
+private:
+	// Find room for one rectangle in the given layer.
+	bool Place(Layer &layer, int width, int height, Slot &slot) const;
+
+
+private:
+	int size;
+	std::vector<Layer> layers;
+};
+
+
+
+#endif
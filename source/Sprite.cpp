@@ -18,11 +18,13 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "ImageBuffer.h"
 #include "Preferences.h"
 #include "Screen.h"
+#include "TextureAtlas.h"
 
 #include "opengl.h"
 #include <SDL2/SDL.h>
 
 #include <algorithm>
+#include <cmath>
 
 using namespace std;
 
@@ -31,6 +33,8 @@ using namespace std;
 Sprite::Sprite(const string &name)
 	: name(name)
 {
+	texture[0] = 0;
+	texture[1] = 0;
 }
 
 
@@ -61,23 +65,31 @@ void Sprite::AddFrames(ImageBuffer &buffer, bool is2x)
 	if(Preferences::Has("Reduce large graphics") && buffer.Width() * buffer.Height() >= 1000000)
 		buffer.ShrinkToHalfSize();
 
-	// Upload the images as a single array texture.
-	glGenTextures(1, &texture[is2x]);
-	glBindTexture(GL_TEXTURE_2D_ARRAY, texture[is2x]);
-
-	// Use linear interpolation and no wrapping.
-	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-	// Upload the image data.
-	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, // target, mipmap level, internal format,
-		buffer.Width(), buffer.Height(), buffer.Frames(), // width, height, depth,
-		0, GL_RGBA, GL_UNSIGNED_BYTE, buffer.Pixels()); // border, input format, data type, data.
-
-	// Unbind the texture.
-	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	// Small sprites share a texture with others if there is room for them.
+	regions[is2x].clear();
+	GLuint id = TextureAtlas::Add(*this, buffer, regions[is2x]);
+	if(!id)
+	{
+		// Upload the images as a single array texture.
+		glGenTextures(1, &id);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, id);
+
+		// Use linear interpolation and no wrapping.
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		// Upload the image data.
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, // target, mipmap level, internal format,
+			buffer.Width(), buffer.Height(), buffer.Frames(), // width, height, depth,
+			0, GL_RGBA, GL_UNSIGNED_BYTE, buffer.Pixels()); // border, input format, data type, data.
+
+		// Unbind the texture.
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		memory += 4 * static_cast<size_t>(buffer.Width()) * buffer.Height() * buffer.Frames();
+	}
+	texture[is2x] = id;
 
 	// Free the ImageBuffer memory.
 	buffer.Clear();
@@ -88,12 +100,39 @@ void Sprite::AddFrames(ImageBuffer &buffer, bool is2x)
 // Free up all textures loaded for this sprite.
 void Sprite::Unload()
 {
-	glDeleteTextures(2, texture);
-	texture[0] = texture[1] = 0;
+	// Frames in the atlas share their texture with other sprites, so they
+	// stay loaded for good.
+	if(!regions[0].empty() || !regions[1].empty())
+		return;
+
+	GLuint ids[2] = {texture[0].exchange(0), texture[1].exchange(0)};
+	glDeleteTextures(2, ids);
+	memory = 0;
+}
+
+
+
+// Check whether this sprite's textures are loaded.
+bool Sprite::IsLoaded() const
+{
+	return texture[0];
+}
+
+
+
+// Get the amount of GPU memory used by this sprite's textures, in bytes. This
+// does not include the space it takes up in the atlas, which cannot be freed.
+size_t Sprite::MemoryUsage() const
+{
+	return memory;
+}
+
 
-	width = 0.f;
-	height = 0.f;
-	frames = 0;
+
+// Check whether this sprite has been drawn since the last time this was checked.
+bool Sprite::WasUsed() const
+{
+	return wasUsed.exchange(false, memory_order_relaxed);
 }
 
 
@@ -142,5 +181,40 @@ uint32_t Sprite::Texture() const
 // Get the index of the texture for the given high DPI mode.
 uint32_t Sprite::Texture(bool isHighDPI) const
 {
-	return (isHighDPI && texture[1]) ? texture[1] : texture[0];
+	// Asking for the texture is a sign that this sprite is about to be drawn.
+	wasUsed.store(true, memory_order_relaxed);
+	uint32_t highDPI = isHighDPI ? texture[1].load() : 0;
+	return highDPI ? highDPI : texture[0].load();
+}
+
+
+
+// Find the two frames that the given animation frame is blended from, and
+// where they are in the texture for the given high DPI mode.
+float Sprite::Locate(float frame, bool isHighDPI, Region &first, Region &second) const
+{
+	// Use the same resolution that Texture() would.
+	const vector<Region> &atlas = regions[isHighDPI && texture[1].load()];
+	int count = atlas.empty() ? max(frames, 1) : static_cast<int>(atlas.size());
+	float index = floor(frame);
+	int firstIndex = static_cast<int>(index) % count;
+	int secondIndex = static_cast<int>(ceil(frame)) % count;
+	if(firstIndex < 0)
+		firstIndex += count;
+	if(secondIndex < 0)
+		secondIndex += count;
+
+	if(atlas.empty())
+	{
+		first = Region();
+		first.layer = firstIndex;
+		second = Region();
+		second.layer = secondIndex;
+	}
+	else
+	{
+		first = atlas[firstIndex];
+		second = atlas[secondIndex];
+	}
+	return frame - index;
 }
@@ -18,27 +18,51 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "Point.h"
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 class ImageBuffer;
 
 
 
 // Class representing a drawable sprite. A sprite can have multiple frames, for
-// animation. Each frame is stored in a separate OpenGL texture object. This may
-// not be as efficient as sprite sheets, but with modern graphics cards it will
-// not matter much and it makes working with the graphics a lot simpler.
+// animation, which are stored as the layers of an OpenGL array texture. Small
+// sprites that are drawn in large numbers instead share a texture with others,
+// each frame taking up part of one of its layers (see TextureAtlas).
 class Sprite {
+public:
+	// Where one frame of a sprite is found in its texture: the layer of the
+	// array texture, and the offset and size of the frame within that layer,
+	// in texture coordinates.
+	class Region {
+	public:
+		float layer = 0.f;
+		float rect[4] = {0.f, 0.f, 1.f, 1.f};
+	};
+
+
 public:
 	explicit Sprite(const std::string &name = "");
+	Sprite(const Sprite &) = delete;
+	Sprite &operator=(const Sprite &) = delete;
 
 	const std::string &Name() const;
 
 	// Upload the given frames. The given buffer will be cleared afterwards.
 	void AddFrames(ImageBuffer &buffer, bool is2x);
-	// Free up all textures loaded for this sprite.
+	// Free up all textures loaded for this sprite. Its dimensions are kept, so
+	// it can still be laid out until it is loaded again.
 	void Unload();
+	// Check whether this sprite's textures are loaded.
+	bool IsLoaded() const;
+	// Get the amount of GPU memory used by this sprite's textures, in bytes.
+	size_t MemoryUsage() const;
+	// Check whether this sprite's texture has been asked for, i.e. whether it
+	// has been drawn, since the last time this was checked.
+	bool WasUsed() const;
 
 	// Image dimensions, in pixels.
 	float Width() const;
@@ -55,12 +79,23 @@ public:
 	// setting or specifying it manually.
 	uint32_t Texture() const;
 	uint32_t Texture(bool isHighDPI) const;
+	// Find the two frames that the given animation frame is blended from, and
+	// where they are in the texture for the given high DPI mode. Return how much
+	// weight the second frame should be given.
+	float Locate(float frame, bool isHighDPI, Region &first, Region &second) const;
 
 
 private:
 	std::string name;
 
-	uint32_t texture[2] = {0, 0};
+	// The textures may be read by a thread that is preparing a draw list
+	// while they are being loaded or unloaded.
+	std::atomic<uint32_t> texture[2];
+	// If the frames have been packed into a shared texture, this is where each
+	// one of them is. Otherwise, these are empty.
+	std::vector<Region> regions[2];
+	size_t memory = 0;
+	mutable std::atomic<bool> wasUsed{false};
 
 	float width = 0.f;
 	float height = 0.f;
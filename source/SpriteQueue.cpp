@@ -43,7 +43,7 @@ SpriteQueue::~SpriteQueue()
 {
 	{
 		lock_guard<mutex> lock(readMutex);
-		added = -1;
+		isQuitting = true;
 	}
 	readCondition.notify_all();
 	for(thread &t : threads)
@@ -53,22 +53,59 @@ SpriteQueue::~SpriteQueue()
 
 
 // Add a sprite to load.
-void SpriteQueue::Add(const shared_ptr<ImageSet> &images)
+void SpriteQueue::Add(const shared_ptr<ImageSet> &images, Priority priority)
 {
 	{
 		lock_guard<mutex> lock(readMutex);
 		// Do nothing if we are destroying the queue already.
-		if(added < 0)
+		if(isQuitting)
 			return;
 
-		toRead.push(images);
-		++added;
+		int index = static_cast<int>(priority);
+		toRead.Push(images, index);
+		++added[index];
 	}
 	readCondition.notify_one();
 }
 
 
 
+// If the given sprite is still waiting to be loaded in the background, load
+// it before any other background sprites. If it is already being read or
+// uploaded, it counts as needed right away from now on.
+void SpriteQueue::Prioritize(const shared_ptr<ImageSet> &images)
+{
+	// The load mutex must always be locked before the read mutex.
+	lock_guard<mutex> loadLock(loadMutex);
+	lock_guard<mutex> readLock(readMutex);
+	const int to = static_cast<int>(Priority::IMMEDIATE);
+	int from = toRead.Promote(images, to);
+	if(from < 0)
+	{
+		auto it = reading.find(images);
+		if(it != reading.end() && it->second != Priority::IMMEDIATE)
+		{
+			from = static_cast<int>(it->second);
+			it->second = Priority::IMMEDIATE;
+		}
+	}
+	if(from < 0)
+		for(pair<shared_ptr<ImageSet>, Priority> &it : toLoad)
+			if(it.first == images && it.second != Priority::IMMEDIATE)
+			{
+				from = static_cast<int>(it.second);
+				it.second = Priority::IMMEDIATE;
+				break;
+			}
+	if(from < 0)
+		return;
+
+	--added[from];
+	++added[to];
+}
+
+
+
 // Unload the texture for the given sprite (to free up memory).
 void SpriteQueue::Unload(const string &name)
 {
@@ -78,16 +115,24 @@ void SpriteQueue::Unload(const string &name)
 
 
 
-// Determine the fraction of sprites uploaded to the GPU.
-double SpriteQueue::GetProgress() const
+// Determine the fraction of sprites with at least the given priority that
+// have been uploaded to the GPU.
+double SpriteQueue::GetProgress(Priority priority) const
 {
 	// Wait until we have completed loading of as many sprites as we have added.
-	// The value of "added" is protected by readMutex.
+	// The values of "added" and "completed" are protected by readMutex.
 	unique_lock<mutex> readLock(readMutex);
+	int totalAdded = 0;
+	int totalCompleted = 0;
+	for(int i = static_cast<int>(priority); i < PRIORITIES; ++i)
+	{
+		totalAdded += added[i];
+		totalCompleted += completed[i];
+	}
 	// Special cases: we're bailing out, or we are done.
-	if(added <= 0 || added == completed)
+	if(isQuitting || totalAdded == totalCompleted)
 		return 1.;
-	return static_cast<double>(completed) / static_cast<double>(added);
+	return static_cast<double>(totalCompleted) / static_cast<double>(totalAdded);
 }
 
 
@@ -100,7 +145,8 @@ void SpriteQueue::UploadSprites()
 
 
 
-// Finish loading.
+// Finish loading the sprites that are needed right away. Any others keep
+// loading in the background.
 void SpriteQueue::Finish()
 {
 	// Loop until done loading.
@@ -129,16 +175,15 @@ void SpriteQueue::operator()()
 		unique_lock<mutex> lock(readMutex);
 		while(true)
 		{
-			// To signal this thread that it is time for it to quit, we set
-			// "added" to -1.
-			if(added < 0)
+			if(isQuitting)
 				return;
-			if(toRead.empty())
+			if(toRead.Empty())
 				break;
 
-			// Extract the one item we should work on reading right now.
-			shared_ptr<ImageSet> imageSet = toRead.front();
-			toRead.pop();
+			// Read the oldest of the sprites with the highest priority.
+			int index = 0;
+			shared_ptr<ImageSet> imageSet = toRead.Pop(index);
+			reading.emplace(imageSet, static_cast<Priority>(index));
 
 			// It's now safe to add to the lists.
 			lock.unlock();
@@ -149,13 +194,16 @@ void SpriteQueue::operator()()
 			imageSet->Load();
 
 			{
-				// The texture must be uploaded to OpenGL in the main thread.
-				unique_lock<mutex> lock(loadMutex);
-				toLoad.push(imageSet);
+				// The texture must be uploaded to OpenGL in the main thread. The
+				// sprite may have been prioritized while it was being read.
+				unique_lock<mutex> loadLock(loadMutex);
+				lock.lock();
+				auto it = reading.find(imageSet);
+				toLoad.emplace_back(imageSet, it->second);
+				reading.erase(it);
 			}
 			loadCondition.notify_one();
 
-			lock.lock();
 		}
 
 		readCondition.wait(lock);
@@ -179,15 +227,19 @@ void SpriteQueue::DoLoad(unique_lock<mutex> &lock)
 	for(int i = 0; !toLoad.empty() && i < 100; ++i)
 	{
 		// Extract the one item we should work on uploading right now.
-		shared_ptr<ImageSet> imageSet = toLoad.front();
-		toLoad.pop();
+		shared_ptr<ImageSet> imageSet = toLoad.front().first;
+		int index = static_cast<int>(toLoad.front().second);
+		toLoad.pop_front();
 
 		// It's now safe to modify the lists.
 		lock.unlock();
 
 		imageSet->Upload(SpriteSet::Modify(imageSet->Name()));
+		{
+			lock_guard<mutex> readLock(readMutex);
+			++completed[index];
+		}
 
 		lock.lock();
-		++completed;
 	}
 }
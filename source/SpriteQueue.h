@@ -16,7 +16,10 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #ifndef SPRITE_QUEUE_H_
 #define SPRITE_QUEUE_H_
 
+#include "TieredQueue.h"
+
 #include <condition_variable>
+#include <deque>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -33,8 +36,18 @@ class Sprite;
 
 
 // Class for queuing up a list of sprites to be loaded from the disk, with a set of
-// worker threads that begins loading them as soon as they are added.
+// worker threads that begins loading them as soon as they are added. Sprites that
+// are needed right away are loaded before any that can be loaded in the background.
 class SpriteQueue {
+public:
+	enum class Priority : int {
+		// Sprites that can keep loading while the game is already running.
+		BACKGROUND,
+		// Sprites that are needed now, or are about to be drawn.
+		IMMEDIATE
+	};
+
+
 public:
 	SpriteQueue();
 	~SpriteQueue();
@@ -46,14 +59,20 @@ public:
 	SpriteQueue &operator=(SpriteQueue &&other) = delete;
 
 	// Add a sprite to load.
-	void Add(const std::shared_ptr<ImageSet> &images);
+	void Add(const std::shared_ptr<ImageSet> &images, Priority priority = Priority::IMMEDIATE);
+	// If the given sprite is still waiting to be loaded in the background, load
+	// it before any other background sprites. If it is already being read or
+	// uploaded, it counts as needed right away from now on.
+	void Prioritize(const std::shared_ptr<ImageSet> &images);
 	// Unload the texture for the given sprite (to free up memory).
 	void Unload(const std::string &name);
-	// Determine the fraction of sprites uploaded to the GPU.
-	double GetProgress() const;
+	// Determine the fraction of sprites with at least the given priority that
+	// have been uploaded to the GPU.
+	double GetProgress(Priority priority = Priority::IMMEDIATE) const;
 	// Uploads any available sprites to the GPU.
 	void UploadSprites();
-	// Finish loading.
+	// Finish loading the sprites that are needed right away. Any others keep
+	// loading in the background.
 	void Finish();
 
 	// Thread entry point.
@@ -65,17 +84,22 @@ private:
 
 
 private:
-	// These are the image sets that need to be loaded from disk.
-	std::queue<std::shared_ptr<ImageSet>> toRead;
+	static const int PRIORITIES = 2;
+
+	// These are the image sets that need to be loaded from disk, and the ones
+	// that are being loaded right now.
+	TieredQueue<std::shared_ptr<ImageSet>, PRIORITIES> toRead;
+	std::map<std::shared_ptr<ImageSet>, Priority> reading;
 	mutable std::mutex readMutex;
 	std::condition_variable readCondition;
-	int added = 0;
+	int added[PRIORITIES] = {};
+	bool isQuitting = false;
 
 	// These image sets have been loaded from disk but have not been uploaded.
-	std::queue<std::shared_ptr<ImageSet>> toLoad;
+	std::deque<std::pair<std::shared_ptr<ImageSet>, Priority>> toLoad;
 	std::mutex loadMutex;
 	std::condition_variable loadCondition;
-	int completed = 0;
+	int completed[PRIORITIES] = {};
 
 	// These sprites must be unloaded to reclaim GPU memory.
 	std::queue<std::string> toUnload;
@@ -0,0 +1,145 @@
+/* SpriteResidency.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "SpriteResidency.h"
+
+#include "ImageSet.h"
+#include "Sprite.h"
+#include "SpriteQueue.h"
+#include "SpriteSet.h"
+
+#include <chrono>
+
+using namespace std;
+
+namespace {
+	// How often to check which of the loaded sprites have been drawn.
+	const long long CHECK_INTERVAL = 1000;
+	// Sprites that have been drawn more recently than this are never unloaded,
+	// even if that means going over the budget.
+	const long long MIN_IDLE_TIME = 10000;
+
+	long long Now()
+	{
+		return chrono::duration_cast<chrono::milliseconds>(
+			chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
+
+
+
+SpriteResidency::SpriteResidency(SpriteQueue &queue)
+	: queue(queue), tracker(MIN_IDLE_TIME)
+{
+}
+
+
+
+// Keep track of the sprite that the given images are being loaded for.
+void SpriteResidency::Add(const shared_ptr<ImageSet> &images)
+{
+	unloaded.push_back(tracker.Add());
+	index[SpriteSet::Get(images->Name())] = entries.size();
+	entries.emplace_back();
+	entries.back().sprite = SpriteSet::Get(images->Name());
+	entries.back().images = images;
+}
+
+
+
+// Load the given sprite before any that are loading in the background.
+void SpriteResidency::Prioritize(const Sprite *sprite)
+{
+	lock_guard<mutex> lock(requestMutex);
+	requests.push_back(sprite);
+}
+
+
+
+// Check if any sprites have been prioritized since the last step.
+bool SpriteResidency::HasRequests()
+{
+	lock_guard<mutex> lock(requestMutex);
+	return !requests.empty();
+}
+
+
+
+// Load the sprites that are needed, and unload those that are not.
+void SpriteResidency::Step(size_t budget)
+{
+	long long now = Now();
+
+	vector<const Sprite *> toPrioritize;
+	{
+		lock_guard<mutex> lock(requestMutex);
+		toPrioritize.swap(requests);
+	}
+	for(const Sprite *sprite : toPrioritize)
+	{
+		auto it = index.find(sprite);
+		if(it != index.end() && !sprite->IsLoaded())
+			Request(entries[it->second]);
+	}
+
+	// Check whether any of the sprites that are not loaded have finished loading
+	// or need to be loaded again.
+	for(auto it = unloaded.begin(); it != unloaded.end(); )
+	{
+		Entry &entry = entries[*it];
+		if(entry.sprite->IsLoaded())
+		{
+			entry.isQueued = false;
+			tracker.Load(*it, entry.sprite->MemoryUsage(), now);
+			it = unloaded.erase(it);
+			continue;
+		}
+		if(entry.sprite->WasUsed())
+			Request(entry);
+		++it;
+	}
+
+	// Checking every loaded sprite is not worth doing every frame.
+	if(now - lastCheck < CHECK_INTERVAL)
+		return;
+	lastCheck = now;
+
+	for(size_t i = 0; i < entries.size(); ++i)
+		if(tracker.IsLoaded(i) && entries[i].sprite->WasUsed())
+			tracker.Use(i, now);
+
+	// Unload the sprites that have gone unused the longest until the rest fit
+	// within the budget.
+	for(size_t i : tracker.Evict(budget, now))
+	{
+		queue.Unload(entries[i].sprite->Name());
+		unloaded.push_back(i);
+	}
+}
+
+
+
+// Make sure the given entry's sprite will be loaded as soon as possible.
+void SpriteResidency::Request(Entry &entry)
+{
+	if(entry.isQueued)
+		queue.Prioritize(entry.images);
+	else
+	{
+		entry.isQueued = true;
+		queue.Add(entry.images);
+	}
+}
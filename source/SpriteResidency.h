@@ -0,0 +1,92 @@
+/* SpriteResidency.h
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SPRITE_RESIDENCY_H_
+#define SPRITE_RESIDENCY_H_
+
+#include "ResidencyTracker.h"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class ImageSet;
+class Sprite;
+class SpriteQueue;
+
+
+
+// Class that keeps the GPU memory used by sprite textures within a budget. It
+// notes when each sprite was last drawn, and if the textures use too much
+// memory, it unloads the ones that have gone unused for the longest. Once an
+// unloaded sprite is drawn again, its images are queued to be loaded again,
+// and a sprite that is drawn while it is still loading in the background is
+// loaded ahead of the others.
+class SpriteResidency {
+public:
+	explicit SpriteResidency(SpriteQueue &queue);
+
+	// Keep track of the sprite that the given images are being loaded for.
+	void Add(const std::shared_ptr<ImageSet> &images);
+	// Load the given sprite before any that are loading in the background. This
+	// may be called from any thread; the request is handled in the next step.
+	void Prioritize(const Sprite *sprite);
+	// Check if any sprites have been prioritized since the last step.
+	bool HasRequests();
+	// This should be called on the main thread, at least once per frame. Queue
+	// any unloaded sprites that were drawn to be loaded again, and if the given
+	// budget (in bytes) is exceeded, unload the least recently drawn sprites.
+	// A budget of zero means there is no limit.
+	void Step(size_t budget);
+
+
+private:
+	class Entry {
+	public:
+		const Sprite *sprite = nullptr;
+		std::shared_ptr<ImageSet> images;
+		// Whether the sprite is queued to be loaded.
+		bool isQueued = true;
+	};
+
+
+private:
+	// Make sure the given entry's sprite will be loaded as soon as possible.
+	void Request(Entry &entry);
+
+
+private:
+	SpriteQueue &queue;
+	std::vector<Entry> entries;
+	std::map<const Sprite *, size_t> index;
+	// Sprites that have been asked to be loaded first.
+	std::vector<const Sprite *> requests;
+	std::mutex requestMutex;
+	// The entries that are not loaded, either because they are being loaded
+	// or because they were unloaded.
+	std::vector<size_t> unloaded;
+	// Which entries are loaded, how much GPU memory they use, and when each
+	// was last drawn (in milliseconds).
+	ResidencyTracker tracker;
+	// When the entries were last checked to see which were drawn.
+	long long lastCheck = 0;
+};
+
+
+
+#endif
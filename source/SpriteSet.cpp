@@ -20,6 +20,8 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include <map>
 #include <mutex>
+#include <tuple>
+#include <utility>
 
 using namespace std;
 
@@ -58,6 +60,6 @@ Sprite *SpriteSet::Modify(const string &name)
 
 	auto it = sprites.find(name);
 	if(it == sprites.end())
-		it = sprites.emplace(name, Sprite(name)).first;
+		it = sprites.emplace(piecewise_construct, forward_as_tuple(name), forward_as_tuple(name)).first;
 	return &it->second;
 }
@@ -34,8 +34,10 @@ using namespace std;
 namespace {
 	Shader shader;
 	GLint scaleI;
-	GLint frameI;
-	GLint frameCountI;
+	GLint firstRectI;
+	GLint secondRectI;
+	GLint layersI;
+	GLint fadeI;
 	GLint positionI;
 	GLint transformI;
 	GLint blurI;
@@ -46,6 +48,10 @@ namespace {
 	GLuint vao;
 	GLuint vbo;
 
+	// The texture that is currently bound, so that drawing several sprites
+	// from the same atlas page in a row does not bind it again each time.
+	uint32_t boundTexture = 0;
+
 	const vector<vector<GLint>> SWIZZLE = {
 		{GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA}, // 0 red + yellow markings (republic)
 		{GL_RED, GL_BLUE, GL_GREEN, GL_ALPHA}, // 1 red + magenta markings
@@ -113,8 +119,12 @@ void SpriteShader::Init(bool useShaderSwizzle)
 		"precision mediump sampler2DArray;\n"
 #endif
 		"uniform sampler2DArray tex;\n"
-		"uniform float frame;\n"
-		"uniform float frameCount;\n"
+		// Where the two frames to blend are in the texture. Coordinates within
+		// an atlas page need more precision than mediump.
+		"uniform highp vec4 firstRect;\n"
+		"uniform highp vec4 secondRect;\n"
+		"uniform vec2 layers;\n"
+		"uniform float fade;\n"
 		"uniform vec2 blur;\n";
 	if(useShaderSwizzle) fragmentCodeStream <<
 		"uniform int swizzler;\n";
@@ -126,19 +136,22 @@ void SpriteShader::Init(bool useShaderSwizzle)
 
 		"out vec4 finalColor;\n"
 
+		// Map a position within the sprite onto the given frame's part of the
+		// texture. Positions outside the sprite are clamped to its edge.
+		"highp vec3 Locate(highp vec2 coord, highp vec4 rect, float layer) {\n"
+		"  return vec3(rect.xy + clamp(coord, 0.f, 1.f) * rect.zw, layer);\n"
+		"}\n"
+
 		"void main() {\n"
-		"  float first = floor(frame);\n"
-		"  float second = mod(ceil(frame), frameCount);\n"
-		"  float fade = frame - first;\n"
 		"  vec4 color;\n"
 		"  if(blur.x == 0.f && blur.y == 0.f)\n"
 		"  {\n"
 		"    if(fade != 0.f)\n"
 		"      color = mix(\n"
-		"        texture(tex, vec3(fragTexCoord, first)),\n"
-		"        texture(tex, vec3(fragTexCoord, second)), fade);\n"
+		"        texture(tex, Locate(fragTexCoord, firstRect, layers.x)),\n"
+		"        texture(tex, Locate(fragTexCoord, secondRect, layers.y)), fade);\n"
 		"    else\n"
-		"      color = texture(tex, vec3(fragTexCoord, first));\n"
+		"      color = texture(tex, Locate(fragTexCoord, firstRect, layers.x));\n"
 		"  }\n"
 		"  else\n"
 		"  {\n"
@@ -150,10 +163,10 @@ void SpriteShader::Init(bool useShaderSwizzle)
 		"      vec2 coord = fragTexCoord + (blur * float(i)) / float(range);\n"
 		"      if(fade != 0.f)\n"
 		"        color += scale * mix(\n"
-		"          texture(tex, vec3(coord, first)),\n"
-		"          texture(tex, vec3(coord, second)), fade);\n"
+		"          texture(tex, Locate(coord, firstRect, layers.x)),\n"
+		"          texture(tex, Locate(coord, secondRect, layers.y)), fade);\n"
 		"      else\n"
-		"        color += scale * texture(tex, vec3(coord, first));\n"
+		"        color += scale * texture(tex, Locate(coord, firstRect, layers.x));\n"
 		"    }\n"
 		"  }\n";
 
@@ -260,8 +273,10 @@ void SpriteShader::Init(bool useShaderSwizzle)
 
 	shader = Shader(vertexCode, fragmentCode);
 	scaleI = shader.Uniform("scale");
-	frameI = shader.Uniform("frame");
-	frameCountI = shader.Uniform("frameCount");
+	firstRectI = shader.Uniform("firstRect");
+	secondRectI = shader.Uniform("secondRect");
+	layersI = shader.Uniform("layers");
+	fadeI = shader.Uniform("fade");
 	positionI = shader.Uniform("position");
 	transformI = shader.Uniform("transform");
 	blurI = shader.Uniform("blur");
@@ -318,9 +333,9 @@ SpriteShader::Item SpriteShader::Prepare(const Sprite *sprite, const Point &posi
 		return {};
 
 	Item item;
-	item.texture = sprite->Texture();
+	item.sprite = sprite;
+	item.isHighDPI = Screen::IsHighResolution();
 	item.frame = frame;
-	item.frameCount = sprite->Frames();
 	// Position.
 	item.position[0] = static_cast<float>(position.X());
 	item.position[1] = static_cast<float>(position.Y());
@@ -342,16 +357,32 @@ void SpriteShader::Bind()
 
 	GLfloat scale[2] = {2.f / Screen::Width(), -2.f / Screen::Height()};
 	glUniform2fv(scaleI, 1, scale);
+	boundTexture = 0;
 }
 
 
 
 void SpriteShader::Add(const Item &item, bool withBlur)
 {
-	glBindTexture(GL_TEXTURE_2D_ARRAY, item.texture);
+	// A sprite that has been unloaded to save memory is not drawn at all until
+	// it has been loaded again.
+	uint32_t texture = item.sprite ? item.sprite->Texture(item.isHighDPI) : 0;
+	if(!texture)
+		return;
 
-	glUniform1f(frameI, item.frame);
-	glUniform1f(frameCountI, item.frameCount);
+	if(texture != boundTexture)
+	{
+		glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+		boundTexture = texture;
+	}
+
+	Sprite::Region first;
+	Sprite::Region second;
+	float fade = item.sprite->Locate(item.frame, item.isHighDPI, first, second);
+	glUniform4fv(firstRectI, 1, first.rect);
+	glUniform4fv(secondRectI, 1, second.rect);
+	glUniform2f(layersI, first.layer, second.layer);
+	glUniform1f(fadeI, fade);
 	glUniform2fv(positionI, 1, item.position);
 	glUniformMatrix2fv(transformI, 1, false, item.transform);
 	// Special case: check if the blur should be applied or not.
@@ -365,10 +396,15 @@ void SpriteShader::Add(const Item &item, bool withBlur)
 	// Set the color swizzle.
 	if(SpriteShader::useShaderSwizzle)
 		glUniform1i(swizzlerI, swizzle);
-	else
+	else if(swizzle)
 		glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, SWIZZLE[swizzle].data());
 
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+	// A texture may be shared by several sprites, and may also be drawn by the
+	// batch shader, so it must not keep a swizzle beyond this one sprite.
+	if(!SpriteShader::useShaderSwizzle && swizzle)
+		glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, SWIZZLE[0].data());
 }
 
 
@@ -378,8 +414,6 @@ void SpriteShader::Unbind()
 	// Reset the swizzle.
 	if(SpriteShader::useShaderSwizzle)
 		glUniform1i(swizzlerI, 0);
-	else
-		glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, SWIZZLE[0].data());
 
 	glBindVertexArray(0);
 	glUseProgram(0);
@@ -32,10 +32,12 @@ class SpriteShader {
 public:
 	class Item {
 	public:
-		uint32_t texture = 0;
+		// The sprite's texture is only looked up when it is drawn, because that
+		// may only be done by the thread that owns the textures.
+		const Sprite *sprite = nullptr;
+		bool isHighDPI = false;
 		uint32_t swizzle = 0;
 		float frame = 0.f;
-		float frameCount = 1.f;
 		float position[2] = {0.f, 0.f};
 		float transform[4] = {0.f, 0.f, 0.f, 0.f};
 		float blur[2] = {0.f, 0.f};
@@ -26,8 +26,10 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Planet.h"
 #include "Random.h"
 #include "SpriteSet.h"
+#include "SystemGrid.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 
 using namespace std;
@@ -41,6 +43,9 @@ namespace {
 	const double VOLUME = 2000.;
 	// Above this supply amount, price differences taper off:
 	const double LIMIT = 20000.;
+
+	// The index that will be given to the next system that is created.
+	atomic<size_t> nextIndex{0};
 }
 
 const double System::DEFAULT_NEIGHBOR_DISTANCE = 100.;
@@ -89,6 +94,13 @@ double System::Asteroid::Energy() const
 
 
 
+System::System()
+	: index(nextIndex++)
+{
+}
+
+
+
 // Load a system's description.
 void System::Load(const DataNode &node, Set<Planet> &planets)
 {
@@ -166,7 +178,7 @@ void System::Load(const DataNode &node, Set<Planet> &planets)
 				// that they are no longer here.
 				for(StellarObject &object : objects)
 					if(object.GetPlanet())
-						planets.Get(object.GetPlanet()->TrueName())->RemoveSystem(this);
+						planets.Modify(object.GetPlanet()->TrueName())->RemoveSystem(this);
 
 				objects.clear();
 			}
@@ -330,7 +342,7 @@ void System::Load(const DataNode &node, Set<Planet> &planets)
 				// Remove any child objects too.
 				for( ; last != objects.end() && last->parent >= index; ++last, ++removed)
 					if(last->planet)
-						planets.Get(last->planet->TrueName())->RemoveSystem(this);
+						planets.Modify(last->planet->TrueName())->RemoveSystem(this);
 				last = objects.erase(removeIt, last);
 
 				// Recalculate every parent index.
@@ -464,38 +476,44 @@ void System::Load(const DataNode &node, Set<Planet> &planets)
 // Update any information about the system that may have changed due to events,
 // or because the game was started, e.g. neighbors, solar wind and power, or
 // if the system is inhabited.
-void System::UpdateSystem(const Set<System> &systems, const set<double> &neighborDistances)
+void System::UpdateSystem(const SystemGrid &grid, const set<double> &neighborDistances, bool updateNeighbors)
 {
-	accessibleLinks.clear();
-	neighbors.clear();
+	if(updateNeighbors)
+	{
+		accessibleLinks.clear();
+		neighbors.clear();
+	}
 
 	// Some systems in the game may be considered inaccessible. If this system is inaccessible,
 	// then it shouldn't have accessible links or jump neighbors.
 	if(inaccessible)
 		return;
 
-	// If linked systems are inaccessible, then they shouldn't be a part of the accessible links
-	// set that gets used for navigation and other purposes.
-	for(const System *link : links)
-		if(!link->Inaccessible())
-			accessibleLinks.insert(link);
-
-	// Neighbors are cached for each system for the purpose of quicker
-	// pathfinding. If this system has a static jump range then that
-	// is the only range that we need to create jump neighbors for, but
-	// otherwise we must create a set of neighbors for every potential
-	// jump range that can be encountered.
-	if(jumpRange)
+	if(updateNeighbors)
 	{
-		UpdateNeighbors(systems, jumpRange);
-		// Systems with a static jump range must also create a set for
-		// the DEFAULT_NEIGHBOR_DISTANCE to be returned for those systems
-		// which are visible from it.
-		UpdateNeighbors(systems, DEFAULT_NEIGHBOR_DISTANCE);
+		// If linked systems are inaccessible, then they shouldn't be a part of the accessible links
+		// set that gets used for navigation and other purposes.
+		for(const System *link : links)
+			if(!link->Inaccessible())
+				accessibleLinks.insert(link);
+
+		// Neighbors are cached for each system for the purpose of quicker
+		// pathfinding. If this system has a static jump range then that
+		// is the only range that we need to create jump neighbors for, but
+		// otherwise we must create a set of neighbors for every potential
+		// jump range that can be encountered.
+		if(jumpRange)
+		{
+			UpdateNeighbors(grid, jumpRange);
+			// Systems with a static jump range must also create a set for
+			// the DEFAULT_NEIGHBOR_DISTANCE to be returned for those systems
+			// which are visible from it.
+			UpdateNeighbors(grid, DEFAULT_NEIGHBOR_DISTANCE);
+		}
+		else
+			for(const double distance : neighborDistances)
+				UpdateNeighbors(grid, distance);
 	}
-	else
-		for(const double distance : neighborDistances)
-			UpdateNeighbors(systems, distance);
 
 	// Calculate the solar power and solar wind.
 	solarPower = 0.;
@@ -543,6 +561,20 @@ bool System::IsValid() const
 
 
 
+size_t System::Index() const
+{
+	return index;
+}
+
+
+
+size_t System::IndexCount()
+{
+	return nextIndex;
+}
+
+
+
 // Get this system's name.
 const string &System::Name() const
 {
@@ -600,6 +632,13 @@ const set<const System *> &System::Links() const
 
 
 
+const set<const System *> &System::AllLinks() const
+{
+	return links;
+}
+
+
+
 // Get a list of systems that can be jumped to from here with the given
 // jump distance, whether or not there is a direct hyperspace link to them.
 // If this system has its own jump range, then it will always return the
@@ -890,6 +929,18 @@ void System::StepEconomy()
 
 
 
+void System::ResetEconomy()
+{
+	for(auto &it : trade)
+	{
+		it.second.supply = 0.;
+		it.second.exports = 0.;
+		it.second.Update();
+	}
+}
+
+
+
 void System::SetSupply(const string &commodity, double tons)
 {
 	auto it = trade.find(commodity);
@@ -960,7 +1011,7 @@ void System::LoadObject(const DataNode &node, Set<Planet> &planets, int parent)
 	bool isAdded = (node.Token(0) == "add");
 	if(node.Size() >= 2 + isAdded)
 	{
-		Planet *planet = planets.Get(node.Token(1 + isAdded));
+		Planet *planet = planets.Modify(node.Token(1 + isAdded));
 		object.planet = planet;
 		planet->SetSystem(this);
 	}
@@ -1011,7 +1062,7 @@ void System::LoadObjectHelper(const DataNode &node, StellarObject &object, bool
 // Once the star map is fully loaded or an event has changed systems
 // or links, figure out which stars are "neighbors" of this one, i.e.
 // close enough to see or to reach via jump drive.
-void System::UpdateNeighbors(const Set<System> &systems, double distance)
+void System::UpdateNeighbors(const SystemGrid &grid, double distance)
 {
 	set<const System *> &neighborSet = neighbors[distance];
 
@@ -1021,17 +1072,10 @@ void System::UpdateNeighbors(const Set<System> &systems, double distance)
 		neighborSet.insert(system);
 
 	// Any other star system that is within the neighbor distance is also a
-	// neighbor.
-	for(const auto &it : systems)
-	{
-		const System &other = it.second;
-		// Skip systems that have no name or that are inaccessible.
-		if(it.first.empty() || other.Name().empty() || other.Inaccessible())
-			continue;
-
-		if(&other != this && other.Position().Distance(position) <= distance)
-			neighborSet.insert(&other);
-	}
+	// neighbor. The grid only holds systems that have names and are accessible.
+	for(const System *system : grid.Find(position, distance))
+		if(system != this)
+			neighborSet.insert(system);
 }
 
 
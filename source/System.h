@@ -35,6 +35,7 @@ class Minable;
 class Planet;
 class Ship;
 class Sprite;
+class SystemGrid;
 
 
 
@@ -66,17 +67,29 @@ public:
 
 
 public:
+	System();
+
 	// Load a system's description.
 	void Load(const DataNode &node, Set<Planet> &planets);
 	// Update any information about the system that may have changed due to events,
-	// e.g. neighbors, solar wind and power, or if the system is inhabited.
-	void UpdateSystem(const Set<System> &systems, const std::set<double> &neighborDistances);
+	// e.g. neighbors, solar wind and power, or if the system is inhabited. The
+	// grid must contain every named, accessible system. If no system near this
+	// one has changed, the neighbor lists can be left as they are.
+	void UpdateSystem(const SystemGrid &grid, const std::set<double> &neighborDistances,
+		bool updateNeighbors = true);
 
 	// Modify a system's links.
 	void Link(System *other);
 	void Unlink(System *other);
 
 	bool IsValid() const;
+
+	// Get a number identifying this system, so that information about systems
+	// can be stored in arrays instead of maps. Each system (other than copies of
+	// the same system) has a different index, less than System::IndexCount().
+	size_t Index() const;
+	static size_t IndexCount();
+
 	// Get this system's name and position (in the star map).
 	const std::string &Name() const;
 	void SetName(const std::string &name);
@@ -91,6 +104,8 @@ public:
 
 	// Get a list of systems you can travel to through hyperspace from here.
 	const std::set<const System *> &Links() const;
+	// Get every hyperspace link from this system, even to inaccessible systems.
+	const std::set<const System *> &AllLinks() const;
 	// Get a list of systems that can be jumped to from here with the given
 	// jump distance, whether or not there is a direct hyperspace link to them.
 	// If this system has its own jump range, then it will always return the
@@ -159,6 +174,8 @@ public:
 	// Update the economy. Returns the amount of trade goods this system exports.
 	void StepEconomy();
 	void SetSupply(const std::string &commodity, double tons);
+	// Reset every commodity to its starting supply.
+	void ResetEconomy();
 	double Supply(const std::string &commodity) const;
 	double Exports(const std::string &commodity) const;
 
@@ -177,7 +194,7 @@ private:
 	// Once the star map is fully loaded or an event has changed systems
 	// or links, figure out which stars are "neighbors" of this one, i.e.
 	// close enough to see or to reach via jump drive.
-	void UpdateNeighbors(const Set<System> &systems, double distance);
+	void UpdateNeighbors(const SystemGrid &grid, double distance);
 
 
 private:
@@ -194,6 +211,7 @@ private:
 
 
 private:
+	size_t index;
 	bool isDefined = false;
 	bool hasPosition = false;
 	// Name and position (within the star map) of this system.
@@ -0,0 +1,132 @@
+/* SystemGrid.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "SystemGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+
+
+SystemGrid::SystemGrid(double cellSize)
+	: cellSize(cellSize)
+{
+}
+
+
+
+void SystemGrid::Add(const System *system, const Point &position)
+{
+	uint64_t key = CellKey(CellIndex(position.X()), CellIndex(position.Y()));
+	auto it = systemCells.find(system);
+	if(it != systemCells.end())
+	{
+		// If the system is not changing cells, just update its position.
+		if(it->second == key)
+		{
+			for(Entry &entry : cells[key])
+				if(entry.system == system)
+					entry.position = position;
+			return;
+		}
+		Remove(system);
+	}
+
+	cells[key].push_back(Entry{system, position});
+	systemCells[system] = key;
+}
+
+
+
+void SystemGrid::Remove(const System *system)
+{
+	auto it = systemCells.find(system);
+	if(it == systemCells.end())
+		return;
+
+	auto cit = cells.find(it->second);
+	vector<Entry> &cell = cit->second;
+	cell.erase(find_if(cell.begin(), cell.end(),
+		[system](const Entry &entry) noexcept -> bool { return entry.system == system; }));
+	if(cell.empty())
+		cells.erase(cit);
+	systemCells.erase(it);
+}
+
+
+
+void SystemGrid::Clear()
+{
+	cells.clear();
+	systemCells.clear();
+}
+
+
+
+vector<const System *> SystemGrid::Find(const Point &center, double distance) const
+{
+	vector<const System *> result;
+	auto addCell = [&result, &center, distance](const vector<Entry> &cell) -> void
+	{
+		for(const Entry &entry : cell)
+			if(entry.position.Distance(center) <= distance)
+				result.push_back(entry.system);
+	};
+
+	int64_t minX = CellIndex(center.X() - distance);
+	int64_t maxX = CellIndex(center.X() + distance);
+	int64_t minY = CellIndex(center.Y() - distance);
+	int64_t maxY = CellIndex(center.Y() + distance);
+	// If the search area covers more cells than are actually in use, it is
+	// faster to check every system than to look up every cell in the area.
+	if((maxX - minX + 1.) * (maxY - minY + 1.) > cells.size())
+	{
+		for(const auto &it : cells)
+			addCell(it.second);
+		return result;
+	}
+
+	for(int64_t y = minY; y <= maxY; ++y)
+		for(int64_t x = minX; x <= maxX; ++x)
+		{
+			auto it = cells.find(CellKey(x, y));
+			if(it != cells.end())
+				addCell(it->second);
+		}
+	return result;
+}
+
+
+
+size_t SystemGrid::size() const
+{
+	return systemCells.size();
+}
+
+
+
+int64_t SystemGrid::CellIndex(double coordinate) const
+{
+	return static_cast<int64_t>(floor(coordinate / cellSize));
+}
+
+
+
+uint64_t SystemGrid::CellKey(int64_t x, int64_t y)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
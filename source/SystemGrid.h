@@ -0,0 +1,77 @@
+/* SystemGrid.h
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SYSTEM_GRID_H_
+#define SYSTEM_GRID_H_
+
+#include "Point.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class System;
+
+
+
+// Class that sorts star systems into a grid based on their positions on the
+// map, so that all the systems within a certain distance of a point can be found
+// without checking every system in the galaxy. Systems can be added, moved, or
+// removed one at a time, so an event that changes one system does not require
+// the whole grid to be rebuilt.
+class SystemGrid {
+public:
+	explicit SystemGrid(double cellSize = 100.);
+
+	// Add the given system at the given position, or move it there if it is
+	// already in the grid.
+	void Add(const System *system, const Point &position);
+	// Remove the given system from the grid, if it is in it.
+	void Remove(const System *system);
+	void Clear();
+
+	// Get every system in the grid that is within the given distance of the
+	// given point, in no particular order.
+	std::vector<const System *> Find(const Point &center, double distance) const;
+
+	size_t size() const;
+
+
+private:
+	// Get the index of the row or column that contains the given coordinate.
+	int64_t CellIndex(double coordinate) const;
+	// Get the key of the cell in the given column and row.
+	static uint64_t CellKey(int64_t x, int64_t y);
+
+
+private:
+	class Entry {
+	public:
+		const System *system;
+		Point position;
+	};
+
+
+private:
+	double cellSize;
+	// The systems in each cell, and the cell that each system is in.
+	std::unordered_map<uint64_t, std::vector<Entry>> cells;
+	std::unordered_map<const System *, uint64_t> systemCells;
+};
+
+
+
+#endif
@@ -135,6 +135,8 @@ bool TestData::InjectMission() const
 	for(const DataNode &node : dataNode)
 		if(node.Token(0) == "mission" && node.Size() > 1)
 			GameData::Objects().missions.Get(node.Token(1))->Load(node);
+	// The injected missions must be offered wherever they are defined to be.
+	GameData::Objects().missionIndex.Build(GameData::Objects().missions);
 
 	return true;
 }
@@ -20,6 +20,8 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "DataNode.h"
 #include "PlayerInfo.h"
 
+#include <algorithm>
+#include <iterator>
 #include <set>
 
 using namespace std;
@@ -64,8 +66,14 @@ void TextReplacements::Load(const DataNode &node)
 			continue;
 		}
 
-		ConditionSet toSubstitute(child);
-		substitutions.emplace_back(key, make_pair(std::move(toSubstitute), child.Token(1)));
+		auto it = find_if(substitutions.begin(), substitutions.end(),
+			[&key](const pair<string, vector<pair<ConditionSet, string>>> &sub) { return sub.first == key; });
+		if(it == substitutions.end())
+		{
+			substitutions.emplace_back(key, vector<pair<ConditionSet, string>>());
+			it = prev(substitutions.end());
+		}
+		it->second.emplace_back(ConditionSet(child), child.Token(1));
 	}
 }
 
@@ -87,10 +95,14 @@ void TextReplacements::Substitutions(map<string, string> &subs, const Conditions
 {
 	for(const auto &sub : substitutions)
 	{
-		const string &key = sub.first;
-		const ConditionSet &toSub = sub.second.first;
-		const string &replacement = sub.second.second;
-		if(toSub.Test(conditions))
-			subs[key] = replacement;
+		// Only the last valid replacement for each key is used, so there is no
+		// need to check the conditions of any that were loaded before it.
+		const auto &replacements = sub.second;
+		for(auto it = replacements.rbegin(); it != replacements.rend(); ++it)
+			if(it->first.Test(conditions))
+			{
+				subs[sub.first] = it->second;
+				break;
+			}
 	}
 }
@@ -47,8 +47,9 @@ public:
 
 
 private:
-	// Vector with "string to be replaced", "condition when to replace", and "replacement text".
-	std::vector<std::pair<std::string, std::pair<ConditionSet, std::string>>> substitutions;
+	// Vector with "string to be replaced" and all the possible replacements for it, in the
+	// order they were loaded, each with "condition when to replace" and "replacement text".
+	std::vector<std::pair<std::string, std::vector<std::pair<ConditionSet, std::string>>>> substitutions;
 };
 
 
@@ -0,0 +1,146 @@
+/* TextureAtlas.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "TextureAtlas.h"
+
+#include "ImageBuffer.h"
+#include "ShelfPacker.h"
+
+#include "opengl.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+	// The width and height of each layer of a page, and how many layers it has.
+	// Every OpenGL ES 3 implementation supports textures at least this large.
+	const int SIZE = 2048;
+	const int LAYERS = 2;
+	// Only sprites whose 1x frames are no bigger than this are packed.
+	const int MAX_SIZE = 256;
+	// The width of the copy of its edge pixels that surrounds each frame.
+	const int BORDER = 1;
+
+	class Page {
+	public:
+		GLuint texture = 0;
+		ShelfPacker packer{SIZE, LAYERS};
+	};
+
+	vector<Page> pages;
+
+
+
+	// Check whether the given sprite is one of the kinds that are drawn in large
+	// numbers, and whether it is small enough to share a page. Both resolutions
+	// are checked against the 2x size, so a sprite never ends up with only one
+	// of them in the atlas.
+	bool IsPackable(const Sprite &sprite, const ImageBuffer &buffer)
+	{
+		const string &name = sprite.Name();
+		if(name.compare(0, 11, "projectile/") && name.compare(0, 7, "effect/"))
+			return false;
+		if(sprite.Width() > MAX_SIZE || sprite.Height() > MAX_SIZE)
+			return false;
+
+		// All the frames must fit in a single empty page.
+		int columns = SIZE / (2 * static_cast<int>(sprite.Width()) + 2 * BORDER);
+		int rows = SIZE / (2 * static_cast<int>(sprite.Height()) + 2 * BORDER);
+		return buffer.Frames() <= columns * rows * LAYERS;
+	}
+
+
+
+	Page CreatePage()
+	{
+		Page page;
+
+		glGenTextures(1, &page.texture);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, page.texture);
+
+		// Use the same settings as for sprites with a texture of their own.
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		// Allocate the storage. Only the parts that frames are copied into are
+		// ever sampled, so it does not need to be cleared.
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, SIZE, SIZE, LAYERS,
+			0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		return page;
+	}
+}
+
+
+
+// Copy the given frames of the given sprite into the atlas, if the sprite is
+// small enough to share a texture with others.
+uint32_t TextureAtlas::Add(const Sprite &sprite, const ImageBuffer &buffer, vector<Sprite::Region> &regions)
+{
+	if(!IsPackable(sprite, buffer))
+		return 0;
+
+	// All the frames of a sprite go in the same page, so they share a texture.
+	int width = buffer.Width() + 2 * BORDER;
+	int height = buffer.Height() + 2 * BORDER;
+	vector<ShelfPacker::Slot> slots(buffer.Frames());
+	size_t index = 0;
+	while(index < pages.size() && !pages[index].packer.Place(width, height, slots))
+		++index;
+	if(index == pages.size())
+	{
+		pages.push_back(CreatePage());
+		if(!pages.back().packer.Place(width, height, slots))
+			return 0;
+	}
+	const Page &page = pages[index];
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, page.texture);
+	vector<uint32_t> pixels(width * height);
+	regions.resize(slots.size());
+	for(int frame = 0; frame < buffer.Frames(); ++frame)
+	{
+		// Copy the frame, repeating its outermost pixels in the border around
+		// it. That way, sampling at the very edge of the frame gives the same
+		// result as it would with a texture of its own.
+		for(int y = 0; y < height; ++y)
+		{
+			int sourceY = min(max(y - BORDER, 0), buffer.Height() - 1);
+			const uint32_t *in = buffer.Begin(sourceY, frame);
+			uint32_t *out = &pixels[y * width];
+			for(int x = 0; x < width; ++x)
+				out[x] = in[min(max(x - BORDER, 0), buffer.Width() - 1)];
+		}
+		const ShelfPacker::Slot &slot = slots[frame];
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, slot.x, slot.y, slot.layer,
+			width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+		// Texture coordinates refer to the frame itself, not to its border.
+		Sprite::Region &region = regions[frame];
+		region.layer = slot.layer;
+		region.rect[0] = static_cast<float>(slot.x + BORDER) / SIZE;
+		region.rect[1] = static_cast<float>(slot.y + BORDER) / SIZE;
+		region.rect[2] = static_cast<float>(buffer.Width()) / SIZE;
+		region.rect[3] = static_cast<float>(buffer.Height()) / SIZE;
+	}
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	return page.texture;
+}
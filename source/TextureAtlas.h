@@ -0,0 +1,47 @@
+/* TextureAtlas.h
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef TEXTURE_ATLAS_H_
+#define TEXTURE_ATLAS_H_
+
+#include "Sprite.h"
+
+#include <cstdint>
+#include <vector>
+
+class ImageBuffer;
+
+
+
+// Most projectiles and effects are small, and many different ones are on screen
+// at once. Rather than giving each of them a texture of its own, this class packs
+// their frames into a few large shared array textures ("pages"), so that all the
+// sprites in one page can be drawn with a single command. Each frame is surrounded
+// by a copy of its edge pixels, so sampling near the edge of a frame never picks
+// up its neighbors. Textures in the atlas are never freed. Like all other texture
+// operations, this must only be used from the thread that owns the GL context.
+class TextureAtlas {
+public:
+	// Copy the given frames of the given sprite into the atlas, if the sprite is
+	// small enough to share a texture with others, and fill in where each frame
+	// ended up. Return the texture the frames are in, or 0 if the sprite should
+	// be given a texture of its own instead.
+	static uint32_t Add(const Sprite &sprite, const ImageBuffer &buffer, std::vector<Sprite::Region> &regions);
+};
+
+
+
+#endif
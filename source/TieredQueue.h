@@ -0,0 +1,99 @@
+/* TieredQueue.h
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TIERED_QUEUE_H_
+#define TIERED_QUEUE_H_
+
+#include <algorithm>
+#include <deque>
+
+
+
+// Template for a queue that is split into a fixed number of tiers. Items are
+// taken first-in, first-out from the highest tier that has any, so an item in
+// a higher tier is always taken before any item in a lower one. An item that
+// is still waiting can be moved up to a higher tier.
+template <class Type, int TIERS>
+class TieredQueue {
+public:
+	bool Empty() const;
+	// Add an item to the back of the given tier.
+	void Push(const Type &item, int tier);
+	// If the given item is waiting in a lower tier than the given one, move it to
+	// the back of that tier. Return the tier it was moved from, or -1 if it was
+	// not moved.
+	int Promote(const Type &item, int tier);
+	// Take the oldest item from the highest tier that has any, and get the tier
+	// it was taken from. The queue must not be empty.
+	Type Pop(int &tier);
+
+
+private:
+	std::deque<Type> tiers[TIERS];
+};
+
+
+
+template <class Type, int TIERS>
+bool TieredQueue<Type, TIERS>::Empty() const
+{
+	for(const std::deque<Type> &items : tiers)
+		if(!items.empty())
+			return false;
+	return true;
+}
+
+
+
+template <class Type, int TIERS>
+void TieredQueue<Type, TIERS>::Push(const Type &item, int tier)
+{
+	tiers[tier].push_back(item);
+}
+
+
+
+template <class Type, int TIERS>
+int TieredQueue<Type, TIERS>::Promote(const Type &item, int tier)
+{
+	for(int from = 0; from < tier; ++from)
+	{
+		auto it = std::find(tiers[from].begin(), tiers[from].end(), item);
+		if(it == tiers[from].end())
+			continue;
+
+		tiers[from].erase(it);
+		tiers[tier].push_back(item);
+		return from;
+	}
+	return -1;
+}
+
+
+
+template <class Type, int TIERS>
+Type TieredQueue<Type, TIERS>::Pop(int &tier)
+{
+	tier = TIERS - 1;
+	while(tiers[tier].empty())
+		--tier;
+	Type item = tiers[tier].front();
+	tiers[tier].pop_front();
+	return item;
+}
+
+
+
+#endif
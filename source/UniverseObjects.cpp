@@ -17,10 +17,12 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "DataFile.h"
 #include "DataNode.h"
+#include "DistanceMap.h"
 #include "Files.h"
 #include "text/FontSet.h"
 #include "ImageSet.h"
 #include "Information.h"
+#include "LocationFilter.h"
 #include "Logger.h"
 #include "MaskManager.h"
 #include "Music.h"
@@ -72,9 +74,10 @@ namespace {
 
 
 
-future<void> UniverseObjects::Load(const vector<string> &sources, bool debugMode)
+future<void> UniverseObjects::Load(const vector<string> &sources, bool debugMode, bool lazily)
 {
 	progress = 0.;
+	loadLazily = lazily;
 
 	// We need to copy any variables used for loading to avoid a race condition.
 	// 'this' is not copied, so 'this' shouldn't be accessed after calling this
@@ -158,6 +161,9 @@ void UniverseObjects::FinishLoading()
 		else
 			Logger::LogError("Unhandled \"disable\" keyword of type \"" + category.first + "\"");
 	}
+
+	// Sort the missions by where they can be offered.
+	missionIndex.Build(missions);
 }
 
 
@@ -166,31 +172,38 @@ void UniverseObjects::FinishLoading()
 void UniverseObjects::Change(const DataNode &node)
 {
 	if(node.Token(0) == "fleet" && node.Size() >= 2)
-		fleets.Get(node.Token(1))->Load(node);
+		fleets.Modify(node.Token(1))->Load(node);
 	else if(node.Token(0) == "galaxy" && node.Size() >= 2)
-		galaxies.Get(node.Token(1))->Load(node);
+		galaxies.Modify(node.Token(1))->Load(node);
 	else if(node.Token(0) == "government" && node.Size() >= 2)
-		governments.Get(node.Token(1))->Load(node);
+		governments.Modify(node.Token(1))->Load(node);
 	else if(node.Token(0) == "outfitter" && node.Size() >= 2)
-		outfitSales.Get(node.Token(1))->Load(node, outfits);
+		outfitSales.Modify(node.Token(1))->Load(node, outfits);
 	else if(node.Token(0) == "planet" && node.Size() >= 2)
-		planets.Get(node.Token(1))->Load(node, wormholes);
+		planets.Modify(node.Token(1))->Load(node, wormholes);
 	else if(node.Token(0) == "shipyard" && node.Size() >= 2)
-		shipSales.Get(node.Token(1))->Load(node, ships);
+		shipSales.Modify(node.Token(1))->Load(node, ships);
 	else if(node.Token(0) == "system" && node.Size() >= 2)
-		systems.Get(node.Token(1))->Load(node, planets);
+		systems.Modify(node.Token(1))->Load(node, planets);
 	else if(node.Token(0) == "news" && node.Size() >= 2)
 		news.Get(node.Token(1))->Load(node);
 	else if(node.Token(0) == "link" && node.Size() >= 3)
-		systems.Get(node.Token(1))->Link(systems.Get(node.Token(2)));
+		systems.Modify(node.Token(1))->Link(systems.Modify(node.Token(2)));
 	else if(node.Token(0) == "unlink" && node.Size() >= 3)
-		systems.Get(node.Token(1))->Unlink(systems.Get(node.Token(2)));
+		systems.Modify(node.Token(1))->Unlink(systems.Modify(node.Token(2)));
 	else if(node.Token(0) == "substitutions" && node.HasChildren())
 		substitutions.Load(node);
 	else if(node.Token(0) == "wormhole" && node.Size() >= 2)
-		wormholes.Get(node.Token(1))->Load(node);
+		wormholes.Modify(node.Token(1))->Load(node);
 	else
 		node.PrintTrace("Error: Invalid \"event\" data:");
+
+	// Planets and systems that matched a filter before may no longer match it.
+	LocationFilter::ClearCache();
+	// Wormholes change which routes are shortest, and how far each system is
+	// from the nearest one.
+	if(node.Token(0) == "planet" || node.Token(0) == "wormhole")
+		DistanceMap::ClearCache();
 }
 
 
@@ -199,18 +212,103 @@ void UniverseObjects::Change(const DataNode &node)
 // (This must be done any time a GameEvent creates or moves a system.)
 void UniverseObjects::UpdateSystems()
 {
+	// Any routes that were calculated before now may no longer be valid.
+	DistanceMap::ClearCache();
+	LocationFilter::ClearCache();
+
+	// Only the neighbors of systems near one that has been added, moved, or
+	// otherwise changed since the last update need to be recalculated.
+	bool updateAll = neighborStates.empty() || neighborDistances != indexedDistances;
+	indexedDistances = neighborDistances;
+	// Systems within this distance of a changed system may need new neighbors.
+	double searchDistance = System::DEFAULT_NEIGHBOR_DISTANCE;
+	if(!neighborDistances.empty())
+		searchDistance = max(searchDistance, *neighborDistances.rbegin());
+
+	set<const System *> changed;
+	vector<Point> changedPositions;
+	for(const auto &it : systems)
+	{
+		const System &system = it.second;
+		NeighborState state(it.first, system);
+		searchDistance = max(searchDistance, system.JumpRange());
+
+		auto sit = neighborStates.find(&system);
+		if(sit == neighborStates.end())
+			sit = neighborStates.emplace(&system, state).first;
+		else if(sit->second == state)
+			continue;
+		else
+		{
+			if(sit->second.isIndexed)
+				changedPositions.push_back(sit->second.position);
+			sit->second = state;
+		}
+
+		changed.insert(&system);
+		if(state.isIndexed)
+		{
+			systemGrid.Add(&system, state.position);
+			changedPositions.push_back(state.position);
+		}
+		else
+			systemGrid.Remove(&system);
+	}
+	// Forget any systems that have been removed (i.e. by reverting to a state
+	// before they were created).
+	if(neighborStates.size() > static_cast<size_t>(systems.size()))
+	{
+		set<const System *> existing;
+		for(const auto &it : systems)
+			existing.insert(&it.second);
+		for(auto it = neighborStates.begin(); it != neighborStates.end(); )
+		{
+			if(existing.count(it->first))
+				++it;
+			else
+			{
+				if(it->second.isIndexed)
+					changedPositions.push_back(it->second.position);
+				systemGrid.Remove(it->first);
+				it = neighborStates.erase(it);
+			}
+		}
+	}
+
+	set<const System *> affected = changed;
+	if(!updateAll && !changedPositions.empty())
+		for(const Point &position : changedPositions)
+			for(const System *system : systemGrid.Find(position, searchDistance))
+				affected.insert(system);
+	// A system's neighbors include the systems it links to, if they are accessible.
+	if(!updateAll && !changed.empty())
+		for(const auto &it : systems)
+			for(const System *link : it.second.AllLinks())
+				if(changed.count(link))
+					affected.insert(&it.second);
+
+	// A planet that is in more than one system only needs to be updated once.
+	set<const Planet *> updatedPlanets;
 	for(auto &it : systems)
 	{
 		// Skip systems that have no name.
 		if(it.first.empty() || it.second.Name().empty())
 			continue;
-		it.second.UpdateSystem(systems, neighborDistances);
+		it.second.UpdateSystem(systemGrid, neighborDistances, updateAll || affected.count(&it.second));
 
 		// If there were changes to a system there might have been a change to a legacy
-		// wormhole which we must handle.
+		// wormhole which we must handle. Only planets that are or become legacy
+		// wormholes are changed by this, and they must go through Modify() so that
+		// reverting the universe undoes the change.
 		for(const auto &object : it.second.Objects())
-			if(object.GetPlanet())
-				planets.Get(object.GetPlanet()->TrueName())->FinishLoading(wormholes);
+		{
+			const Planet *planet = object.GetPlanet();
+			if(!planet || !updatedPlanets.insert(planet).second)
+				continue;
+			const Wormhole *wormhole = planet->GetWormhole();
+			if(wormhole ? wormhole->IsAutogenerated() : planet->Systems().size() > 1)
+				planets.Modify(planet->TrueName())->FinishLoading(wormholes);
+		}
 	}
 }
 
@@ -231,15 +329,14 @@ void UniverseObjects::CheckReferences()
 		else
 		{
 			// Any already-named event (i.e. loaded) may alter the universe.
-			auto definitions = GameEvent::DeferredDefinitions(it.second.Changes());
-			for(auto &&type : definitions)
+			for(auto &&type : it.second.Definitions())
 				deferred[type.first].insert(type.second.begin(), type.second.end());
 		}
 	}
 
-	// Stock conversations are never serialized.
+	// Stock conversations are never serialized. Avoid parsing any that were loaded lazily.
 	for(const auto &it : conversations)
-		if(it.second.IsEmpty())
+		if(!it.second.IsDefined())
 			Warn("conversation", it.first);
 	// The "default intro" conversation must invoke the prompt to set the player's name.
 	if(!conversations.Get("default intro")->IsValidIntro())
@@ -325,6 +422,24 @@ void UniverseObjects::CheckReferences()
 
 
 
+UniverseObjects::NeighborState::NeighborState(const string &key, const System &system)
+	: isIndexed(!key.empty() && !system.Name().empty() && !system.Inaccessible()),
+	isInaccessible(system.Inaccessible()), position(system.Position()), jumpRange(system.JumpRange()),
+	links(system.AllLinks())
+{
+}
+
+
+
+bool UniverseObjects::NeighborState::operator==(const NeighborState &other) const
+{
+	return isIndexed == other.isIndexed && isInaccessible == other.isInaccessible
+		&& position.X() == other.position.X() && position.Y() == other.position.Y()
+		&& jumpRange == other.jumpRange && links == other.links;
+}
+
+
+
 void UniverseObjects::LoadFile(const string &path, bool debugMode)
 {
 	// This is an ordinary file. Check to see if it is an image.
@@ -342,11 +457,21 @@ void UniverseObjects::LoadFile(const string &path, bool debugMode)
 			colors.Get(node.Token(1))->Load(
 				node.Value(2), node.Value(3), node.Value(4), node.Size() >= 6 ? node.Value(5) : 1.);
 		else if(key == "conversation" && node.Size() >= 2)
-			conversations.Get(node.Token(1))->Load(node);
+		{
+			if(loadLazily)
+				conversations.Get(node.Token(1))->LoadLazily(node);
+			else
+				conversations.Get(node.Token(1))->Load(node);
+		}
 		else if(key == "effect" && node.Size() >= 2)
 			effects.Get(node.Token(1))->Load(node);
 		else if(key == "event" && node.Size() >= 2)
-			events.Get(node.Token(1))->Load(node);
+		{
+			if(loadLazily)
+				events.Get(node.Token(1))->LoadLazily(node);
+			else
+				events.Get(node.Token(1))->Load(node);
+		}
 		else if(key == "fleet" && node.Size() >= 2)
 			fleets.Get(node.Token(1))->Load(node);
 		else if(key == "formation" && node.Size() >= 2)
@@ -372,7 +497,12 @@ void UniverseObjects::LoadFile(const string &path, bool debugMode)
 		else if(key == "minable" && node.Size() >= 2)
 			minables.Get(node.Token(1))->Load(node);
 		else if(key == "mission" && node.Size() >= 2)
-			missions.Get(node.Token(1))->Load(node);
+		{
+			if(loadLazily)
+				missions.Get(node.Token(1))->LoadLazily(node);
+			else
+				missions.Get(node.Token(1))->Load(node);
+		}
 		else if(key == "outfit" && node.Size() >= 2)
 			outfits.Get(node.Token(1))->Load(node);
 		else if(key == "outfitter" && node.Size() >= 2)
@@ -380,7 +510,12 @@ void UniverseObjects::LoadFile(const string &path, bool debugMode)
 		else if(key == "person" && node.Size() >= 2)
 			persons.Get(node.Token(1))->Load(node);
 		else if(key == "phrase" && node.Size() >= 2)
-			phrases.Get(node.Token(1))->Load(node);
+		{
+			if(loadLazily)
+				phrases.Get(node.Token(1))->LoadLazily(node);
+			else
+				phrases.Get(node.Token(1))->Load(node);
+		}
 		else if(key == "planet" && node.Size() >= 2)
 			planets.Get(node.Token(1))->Load(node, wormholes);
 		else if(key == "ship" && node.Size() >= 2)
@@ -435,7 +570,12 @@ void UniverseObjects::LoadFile(const string &path, bool debugMode)
 			}
 		}
 		else if(key == "news" && node.Size() >= 2)
-			news.Get(node.Token(1))->Load(node);
+		{
+			if(loadLazily)
+				news.Get(node.Token(1))->LoadLazily(node);
+			else
+				news.Get(node.Token(1))->Load(node);
+		}
 		else if(key == "rating" && node.Size() >= 2)
 		{
 			vector<string> &list = ratings[node.Token(1)];
@@ -32,6 +32,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Interface.h"
 #include "Minable.h"
 #include "Mission.h"
+#include "MissionIndex.h"
 #include "News.h"
 #include "Outfit.h"
 #include "Person.h"
@@ -40,6 +41,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "Ship.h"
 #include "StartConditions.h"
 #include "System.h"
+#include "SystemGrid.h"
 #include "Test.h"
 #include "TestData.h"
 #include "TextReplacements.h"
@@ -65,8 +67,10 @@ class UniverseObjects {
 	friend class GameData;
 	friend class TestData;
 public:
-	// Load game objects from the given directories of definitions.
-	std::future<void> Load(const std::vector<std::string> &sources, bool debugMode = false);
+	// Load game objects from the given directories of definitions. If loading lazily,
+	// objects that most sessions never use (like missions, conversations, events,
+	// phrases and news) are only fully parsed the first time they are needed.
+	std::future<void> Load(const std::vector<std::string> &sources, bool debugMode = false, bool lazily = false);
 	// Determine the fraction of data files read from disk.
 	double GetProgress() const;
 	// Resolve every game object dependency.
@@ -86,6 +90,22 @@ public:
 	void DrawMenuBackground(Panel *panel) const;
 
 
+private:
+	// The properties of a system that determine which systems are its neighbors.
+	class NeighborState {
+	public:
+		NeighborState(const std::string &key, const System &system);
+		bool operator==(const NeighborState &other) const;
+
+		// Whether the system is named and accessible, and therefore in the grid.
+		bool isIndexed;
+		bool isInaccessible;
+		Point position;
+		double jumpRange;
+		std::set<const System *> links;
+	};
+
+
 private:
 	void LoadFile(const std::string &path, bool debugMode = false);
 
@@ -93,6 +113,8 @@ private:
 private:
 	// A value in [0, 1] representing how many source files have been processed for content.
 	std::atomic<double> progress;
+	// Whether rarely used definitions should only be parsed when first needed.
+	bool loadLazily = false;
 
 
 private:
@@ -121,6 +143,13 @@ private:
 	Set<Sale<Outfit>> outfitSales;
 	Set<Wormhole> wormholes;
 	std::set<double> neighborDistances;
+	// The state of each system and the neighbor distances as of the last call to
+	// UpdateSystems(), so that it only needs to update systems that have changed.
+	SystemGrid systemGrid;
+	std::map<const System *, NeighborState> neighborStates;
+	std::set<double> indexedDistances;
+	// The missions sorted by where they can be offered.
+	MissionIndex missionIndex;
 
 	TextReplacements substitutions;
 	Trade trade;
@@ -30,6 +30,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 #include "GameLoadingPanel.h"
 #include "GameWindow.h"
 #include "Hardpoint.h"
+#include "ImageCache.h"
 #include "Logger.h"
 #include "MenuPanel.h"
 #include "Panel.h"
@@ -127,6 +128,11 @@ int main(int argc, char *argv[])
 	Files::Init(argv);
 
 	try {
+		// Some preferences affect how the game data is loaded, such as whether
+		// decoded images are cached, so they must be read first.
+		Preferences::Load();
+		ImageCache::Init(Files::Config() + "image cache/", Preferences::Has("Cache decoded images"));
+
 		// Begin loading the game data.
 		bool isConsoleOnly = loadOnly || printTests || printData;
 		future<void> dataLoading = GameData::BeginLoad(isConsoleOnly, debugMode);
@@ -174,8 +180,6 @@ int main(int argc, char *argv[])
 		timeBeginPeriod(1);
 #endif
 
-		Preferences::Load();
-
 		// Load global conditions:
 		DataFile globalConditions(Files::Config() + "global conditions.txt");
 		for(const DataNode &node : globalConditions)
@@ -217,6 +221,7 @@ int main(int argc, char *argv[])
 	Preferences::Set("fullscreen", GameWindow::IsFullscreen());
 	Screen::SetRaw(GameWindow::Width(), GameWindow::Height());
 	Preferences::Save();
+	PlayerInfo::FinishSaving();
 
 	Audio::Quit();
 	GameWindow::Quit();
@@ -408,6 +413,9 @@ void GameLoop(PlayerInfo &player, const Conversation &conversation, const string
 		(menuPanels.IsEmpty() ? gamePanels : menuPanels).DrawAll();
 		if(isFastForward)
 			SpriteShader::Draw(SpriteSet::Get("ui/fast forward"), Screen::TopLeft() + Point(10., 10.));
+		// Reload any sprites that were unloaded to save memory but are now
+		// being drawn again.
+		GameData::ProcessSprites();
 
 		GameWindow::Step();
 
@@ -270,21 +270,16 @@ string Format::Replace(const string &source, const map<string, string> &keys)
 		if(right == string::npos)
 			break;
 
-		bool matched = false;
 		++right;
-		size_t length = right - left;
-		for(const auto &it : keys)
-			if(!source.compare(left, length, it.first))
-			{
-				result.append(source, start, left - start);
-				result.append(it.second);
-				start = right;
-				search = start;
-				matched = true;
-				break;
-			}
-
-		if(!matched)
+		auto it = keys.find(source.substr(left, right - left));
+		if(it != keys.end())
+		{
+			result.append(source, start, left - start);
+			result.append(it->second);
+			start = right;
+			search = start;
+		}
+		else
 			search = left + 1;
 	}
 
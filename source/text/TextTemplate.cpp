@@ -0,0 +1,103 @@
+/* TextTemplate.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "TextTemplate.h"
+
+#include <algorithm>
+
+using namespace std;
+
+
+
+TextTemplate::TextTemplate(string text)
+	: text(std::move(text))
+{
+	const string &source = this->text;
+	size_t left = source.find('<');
+	while(left != string::npos)
+	{
+		// A key ends at the first '>'. If another '<' comes before that, this
+		// was not the start of a key after all.
+		size_t right = source.find_first_of("<>", left + 1);
+		if(right == string::npos)
+			break;
+		if(source[right] == '<')
+		{
+			left = right;
+			continue;
+		}
+
+		++right;
+		const char *begin = source.data() + left;
+		auto it = find_if(keys.begin(), keys.end(), [begin, right, left](const string &key) noexcept -> bool
+			{
+				return !key.compare(0, string::npos, begin, right - left);
+			});
+		slots.push_back(Slot{left, right, static_cast<size_t>(it - keys.begin())});
+		if(it == keys.end())
+			keys.emplace_back(source, left, right - left);
+
+		left = source.find('<', right);
+	}
+}
+
+
+
+// Get the text, with none of its keys replaced.
+const string &TextTemplate::Text() const
+{
+	return text;
+}
+
+
+
+bool TextTemplate::IsEmpty() const
+{
+	return text.empty();
+}
+
+
+
+// Get each distinct key in this text, in the order they first appear.
+const vector<string> &TextTemplate::Keys() const
+{
+	return keys;
+}
+
+
+
+// Replace each key that is in the given map with its value.
+string TextTemplate::Replace(const map<string, string> &subs) const
+{
+	if(slots.empty())
+		return text;
+
+	string result;
+	result.reserve(text.length());
+
+	size_t start = 0;
+	for(const Slot &slot : slots)
+	{
+		auto it = subs.find(keys[slot.key]);
+		if(it == subs.end())
+			continue;
+		result.append(text, start, slot.start - start);
+		result.append(it->second);
+		start = slot.end;
+	}
+	result.append(text, start, string::npos);
+	return result;
+}
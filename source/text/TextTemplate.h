@@ -0,0 +1,64 @@
+/* TextTemplate.h
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef ES_TEXT_TEXTTEMPLATE_H_
+#define ES_TEXT_TEXTTEMPLATE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+
+// Text containing "keys" in the form "<name>" that are to be replaced with
+// other text, such as the name of a mission's destination. The text is split
+// up into literal text and keys once, when it is loaded, so that filling in
+// the keys does not require searching the text again every time.
+class TextTemplate {
+public:
+	TextTemplate() = default;
+	explicit TextTemplate(std::string text);
+
+	// Get the text, with none of its keys replaced.
+	const std::string &Text() const;
+	bool IsEmpty() const;
+	// Get each distinct key in this text, in the order they first appear.
+	const std::vector<std::string> &Keys() const;
+
+	// Replace each key that is in the given map with its value. This gives the
+	// same result as Format::Replace() for keys that do not contain a '<'.
+	std::string Replace(const std::map<std::string, std::string> &subs) const;
+
+
+private:
+	// Where one of the keys appears in the text.
+	class Slot {
+	public:
+		size_t start;
+		size_t end;
+		size_t key;
+	};
+
+
+private:
+	std::string text;
+	std::vector<Slot> slots;
+	std::vector<std::string> keys;
+};
+
+
+
+#endif
@@ -194,6 +194,109 @@ SCENARIO( "Applying changes to conditions", "[ConditionSet][Usage]" ) {
 		}
 	}
 }
+
+SCENARIO( "Evaluating expressions with several operators", "[ConditionSet][Usage]" ) {
+	auto store = ConditionsStore {
+		{"a", 1},
+		{"b", 5},
+	};
+
+	GIVEN( "comparisons of arithmetic expressions" ) {
+		const auto set = ConditionSet{AsDataNode("and\n"
+			"\ta + b * 2 == 11\n"
+			"\t( a + b ) * 2 == 12\n"
+			"\ta - b - 1 == -5\n"
+			"\tb % 2 == 1\n"
+			"\tb / ( a - 1 ) > 1000\n"
+			"\t12 == ( ( b + a ) * ( 1 + a ) )\n")};
+		THEN( "the operators are applied in the right order" ) {
+			CHECK( set.Test(store) );
+		}
+		AND_GIVEN( "conditions that make one of them false" ) {
+			store.Set("b", 6);
+			THEN( "the set is not satisfied" ) {
+				CHECK_FALSE( set.Test(store) );
+			}
+		}
+	}
+	GIVEN( "a set that assigns a temporary condition before testing it" ) {
+		const auto set = ConditionSet{AsDataNode("and\n"
+			"\ttemp = a + b\n"
+			"\ttemp *= 2\n"
+			"\ttemp == 12\n"
+			"\tb == 5\n")};
+		THEN( "the temporary value is used for the test" ) {
+			CHECK( set.Test(store) );
+		}
+		THEN( "the conditions are not changed by testing" ) {
+			set.Test(store);
+			CHECK( primarySize(store) == 2 );
+		}
+		THEN( "applying it changes the conditions" ) {
+			set.Apply(store);
+			CHECK( store.Get("temp") == 12 );
+		}
+	}
+	GIVEN( "an \"or\" set" ) {
+		const auto set = ConditionSet{AsDataNode("or\n"
+			"\ta > b\n"
+			"\tand\n"
+			"\t\tb == 5\n"
+			"\t\ta * 3 == 3\n")};
+		THEN( "it is satisfied if one of its children is" ) {
+			CHECK( set.Test(store) );
+		}
+	}
+}
+
+SCENARIO( "Testing a set repeatedly", "[ConditionSet][Usage]" ) {
+	GIVEN( "a set that has been tested once" ) {
+		auto store = ConditionsStore {
+			{"a", 1},
+			{"b", 5},
+		};
+		const auto set = ConditionSet{AsDataNode("and\n"
+			"\ta + b == 6\n"
+			"\tnot c\n")};
+		REQUIRE( set.Test(store) );
+
+		THEN( "changes made in any way are noticed" ) {
+			store.Set("a", 2);
+			CHECK_FALSE( set.Test(store) );
+			store["a"] = 1;
+			CHECK( set.Test(store) );
+			++store["c"];
+			CHECK_FALSE( set.Test(store) );
+			store.Erase("c");
+			CHECK( set.Test(store) );
+			store.Add("b", 1);
+			CHECK_FALSE( set.Test(store) );
+			ConditionSet{AsDataNode("and\n\tb -= 1\n")}.Apply(store);
+			CHECK( set.Test(store) );
+		}
+		THEN( "a different store gives its own result" ) {
+			auto other = ConditionsStore {
+				{"a", 3},
+			};
+			CHECK_FALSE( set.Test(other) );
+			CHECK( set.Test(store) );
+			auto copy = store;
+			copy.Set("c", 1);
+			CHECK_FALSE( set.Test(copy) );
+			CHECK( set.Test(store) );
+		}
+		THEN( "derived conditions are read every time" ) {
+			int64_t c = 0;
+			auto &provider = store.GetProviderNamed("c");
+			provider.SetGetFunction([&c](const std::string &) { return c; });
+			CHECK( set.Test(store) );
+			c = 1;
+			CHECK_FALSE( set.Test(store) );
+			c = 0;
+			CHECK( set.Test(store) );
+		}
+	}
+}
 // #endregion unit tests
 
 
@@ -21,6 +21,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 // ... and any system includes needed for the test file.
 #include <map>
 #include <string>
+#include <utility>
 
 
 
@@ -484,6 +485,35 @@ SCENARIO( "Providing derived conditions", "[ConditionStore][DerivedConditions]"
 				REQUIRE( it == store.PrimariesEnd() );
 			}
 		}
+		WHEN( "looking up conditions by interned key" )
+		{
+			const auto primary = ConditionsStore::Key("myFirstVar");
+			const auto prefixed = ConditionsStore::Key("prefixA: test");
+			const auto missing = ConditionsStore::Key("prefixB: test");
+			THEN( "the same values are found as by name" )
+			{
+				REQUIRE( primary.Name() == "myFirstVar" );
+				REQUIRE( &primary.Name() == &ConditionsStore::Key("myFirstVar").Name() );
+				REQUIRE( store.HasGet(primary) == std::make_pair(true, int64_t(10)) );
+				REQUIRE( store.HasGet(prefixed) == std::make_pair(true, int64_t(-30)) );
+				REQUIRE( store.HasGet(missing) == std::make_pair(false, int64_t(0)) );
+			}
+			THEN( "a default key refers to the empty name" )
+			{
+				const auto empty = ConditionsStore::Key();
+				REQUIRE( empty.Name().empty() );
+				REQUIRE( &empty.Name() == &ConditionsStore::Key("").Name() );
+				REQUIRE( store.HasGet(empty) == std::make_pair(false, int64_t(0)) );
+			}
+			THEN( "conditions can be modified through their key" )
+			{
+				store[primary] += 5;
+				store[prefixed] = 12;
+				REQUIRE( store.Get("myFirstVar") == 15 );
+				REQUIRE( mockProvPrefixA.values["prefixA: test"] == 12 );
+				REQUIRE( primarySize(store) == 1 );
+			}
+		}
 		WHEN( "adding on a named derived condition" )
 		{
 			REQUIRE( store.Add("named1", -30) );
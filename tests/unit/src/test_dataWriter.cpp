@@ -0,0 +1,177 @@
+/* test_dataWriter.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../source/DataWriter.h"
+
+// Include a helper for creating well-formed DataNodes.
+#include "datanode-factory.h"
+
+// ... and any system includes needed for the test file.
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace { // test namespace
+// #region mock data
+
+// A file-backed DataWriter writes its output in blocks of this size.
+const size_t BLOCK_SIZE = 1 << 16;
+
+// The tests use real files in the directory they are run from.
+const std::string FILE_PATH = "test_dataWriter.txt";
+
+std::string ReadFile(const std::string &path)
+{
+	std::ifstream in(path, std::ios::binary);
+	std::ostringstream out;
+	out << in.rdbuf();
+	return out.str();
+}
+
+bool Exists(const std::string &path)
+{
+	return std::ifstream(path).good();
+}
+
+// Write enough lines that the output crosses the block size a few times.
+void WriteLines(DataWriter &writer)
+{
+	for(int i = 0; i < 10000; ++i)
+	{
+		writer.Write("line", i, "with a quoted token");
+		writer.BeginChild();
+		writer.Write("child", i / 3.);
+		writer.EndChild();
+	}
+}
+
+// Make sure no files are left behind by one test to affect the next.
+struct TestFiles {
+	TestFiles() { Remove(); }
+	~TestFiles() { Remove(); }
+	void Remove() { std::remove(FILE_PATH.c_str()); std::remove((FILE_PATH + ".tmp").c_str()); }
+};
+
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Writing tokens with a DataWriter", "[DataWriter]" ) {
+	DataWriter writer;
+	GIVEN( "strings" ) {
+		WHEN( "they contain no whitespace" ) {
+			writer.Write("plain", "with\"quote", "ünïcode");
+			THEN( "they are written as they are" ) {
+				CHECK( writer.SaveToString() == "plain with\"quote ünïcode\n" );
+			}
+		}
+		WHEN( "they are empty, contain whitespace or begin a comment" ) {
+			writer.Write("", "two words", "#tag", "tab\there");
+			THEN( "they are enclosed in quotation marks" ) {
+				CHECK( writer.SaveToString() == "\"\" \"two words\" \"#tag\" \"tab\there\"\n" );
+			}
+		}
+		WHEN( "they contain both whitespace and quotation marks" ) {
+			writer.Write("say \"hi\"");
+			THEN( "they are enclosed in backticks" ) {
+				CHECK( writer.SaveToString() == "`say \"hi\"`\n" );
+			}
+		}
+	}
+	GIVEN( "integers" ) {
+		writer.Write(0, -17, 4000000000u, INT64_MIN, UINT64_MAX);
+		THEN( "every digit is written" ) {
+			CHECK( writer.SaveToString() == "0 -17 4000000000 -9223372036854775808 18446744073709551615\n" );
+		}
+	}
+	GIVEN( "floating point numbers" ) {
+		writer.Write(3., -0.5, 1. / 3., 99999999., 123456789., 2.5e-7, -0., 0.1f);
+		THEN( "they are written with eight significant digits" ) {
+			CHECK( writer.SaveToString() == "3 -0.5 0.33333333 99999999 1.2345679e+08 2.5e-07 -0 0.1\n" );
+		}
+	}
+	GIVEN( "nested nodes" ) {
+		writer.Write(AsDataNode("ship \"Star Barge\"\n\tattributes\n\t\tmass 70\n\t# ignored\n\tname Lucky"));
+		writer.BeginChild();
+		writer.WriteComment("a comment");
+		writer.EndChild();
+		THEN( "each child is indented one more level than its parent" ) {
+			CHECK( writer.SaveToString() ==
+				"ship \"Star Barge\"\n\tattributes\n\t\tmass 70\n\tname Lucky\n\t# a comment\n" );
+		}
+	}
+	GIVEN( "an in-memory writer that is no longer needed" ) {
+		writer.Write("moved", "out");
+		THEN( "its contents can be taken out of it" ) {
+			CHECK( std::move(writer).SaveToString() == "moved out\n" );
+		}
+	}
+}
+
+SCENARIO( "Writing a file with a DataWriter", "[DataWriter]" ) {
+	TestFiles files;
+	DataWriter expected;
+	WriteLines(expected);
+	REQUIRE( expected.SaveToString().size() > 3 * BLOCK_SIZE );
+
+	GIVEN( "a file that already exists" ) {
+		{
+			std::ofstream out(FILE_PATH, std::ios::binary);
+			out << "old contents\n";
+		}
+		WHEN( "more than a block has been written but the writer is not done" ) {
+			{
+				DataWriter writer(FILE_PATH);
+				WriteLines(writer);
+				THEN( "the existing file is left alone" ) {
+					CHECK( ReadFile(FILE_PATH) == "old contents\n" );
+					CHECK( Exists(FILE_PATH + ".tmp") );
+				}
+			}
+		}
+		WHEN( "the writer is done" ) {
+			{
+				DataWriter writer(FILE_PATH);
+				WriteLines(writer);
+			}
+			THEN( "the file is replaced by everything that was written" ) {
+				CHECK( ReadFile(FILE_PATH) == expected.SaveToString() );
+				CHECK_FALSE( Exists(FILE_PATH + ".tmp") );
+			}
+		}
+	}
+	GIVEN( "a file that does not exist yet" ) {
+		{
+			DataWriter writer(FILE_PATH);
+			WriteLines(writer);
+		}
+		THEN( "it is created with everything that was written" ) {
+			CHECK( ReadFile(FILE_PATH) == expected.SaveToString() );
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
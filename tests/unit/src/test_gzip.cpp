@@ -0,0 +1,91 @@
+/* test_gzip.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../source/Gzip.h"
+
+// ... and any system includes needed for the test file.
+#include <cstdio>
+#include <string>
+
+namespace { // test namespace
+
+// #region mock data
+
+// Compress the given text through a temporary file, and return the file's contents.
+std::string Compress(const std::string &text)
+{
+	FILE *file = std::tmpfile();
+	REQUIRE( file );
+	REQUIRE( Gzip::Write(file, text) );
+	std::rewind(file);
+	std::string result;
+	char buffer[4096];
+	size_t count;
+	while((count = std::fread(buffer, 1, sizeof(buffer), file)))
+		result.append(buffer, count);
+	std::fclose(file);
+	return result;
+}
+
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Compressing and decompressing saved game data", "[Gzip]" ) {
+	GIVEN( "plain text" ) {
+		const std::string text = "pilot Test Pilot\ndate 16 11 3013\n";
+		THEN( "it is not considered compressed" ) {
+			CHECK_FALSE( Gzip::IsCompressed(text) );
+			CHECK_FALSE( Gzip::IsCompressed("") );
+		}
+		THEN( "decompressing it returns it unchanged" ) {
+			CHECK( Gzip::Decompress(text) == text );
+		}
+	}
+	GIVEN( "a large amount of compressed text" ) {
+		std::string text;
+		for(int i = 0; i < 20000; ++i)
+			text += "ship \"Star Barge\" " + std::to_string(i) + "\n";
+		const std::string data = Compress(text);
+		THEN( "the compressed data is smaller and recognizable" ) {
+			CHECK( data.size() < text.size() / 2 );
+			CHECK( Gzip::IsCompressed(data) );
+		}
+		THEN( "decompressing it restores the original text" ) {
+			CHECK( Gzip::Decompress(data) == text );
+		}
+		THEN( "the start of it can be decompressed alone" ) {
+			const std::string start = Gzip::Decompress(data, 100);
+			REQUIRE( start.size() >= 100 );
+			CHECK( start.size() < text.size() );
+			CHECK( text.compare(0, start.size(), start) == 0 );
+		}
+		THEN( "truncated data gives as much of the text as it can" ) {
+			const std::string start = Gzip::Decompress(data.substr(0, data.size() / 2));
+			CHECK( start.size() < text.size() );
+			CHECK( text.compare(0, start.size(), start) == 0 );
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
@@ -0,0 +1,131 @@
+/* test_imageBuffer.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../source/ImageBuffer.h"
+
+// ... and any system includes needed for the test file.
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace { // test namespace
+
+// #region mock data
+
+// The straightforward, one pixel at a time versions of the image conversions,
+// which the optimized versions must match exactly.
+uint32_t ReferencePremultiply(uint32_t pixel, int additive)
+{
+	uint32_t alpha = pixel >> 24;
+	uint32_t result = 0;
+	for(int shift = 0; shift < 24; shift += 8)
+		result |= ((((pixel >> shift) & 0xFF) * alpha) / 255) << shift;
+	if(additive == 1)
+		alpha >>= 2;
+	if(additive != 2)
+		result |= alpha << 24;
+	return result;
+}
+
+uint32_t ReferenceAverage(uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+{
+	uint32_t result = 0;
+	for(int shift = 0; shift < 32; shift += 8)
+		result |= ((((a >> shift) & 0xFF) + ((b >> shift) & 0xFF) + ((c >> shift) & 0xFF)
+			+ ((d >> shift) & 0xFF) + 2) / 4) << shift;
+	return result;
+}
+
+// Fill the buffer with arbitrary but repeatable pixel values.
+void FillRandom(ImageBuffer &buffer)
+{
+	uint32_t state = 12345;
+	uint32_t *end = buffer.Pixels() + buffer.Width() * buffer.Height() * buffer.Frames();
+	for(uint32_t *it = buffer.Pixels(); it != end; ++it)
+	{
+		state = state * 1664525 + 1013904223;
+		*it = state;
+	}
+}
+
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Converting an image to premultiplied alpha", "[ImageBuffer]" ) {
+	GIVEN( "an image containing every combination of color and alpha" ) {
+		// The odd width makes sure pixels left over after each block of pixels
+		// are converted correctly too.
+		ImageBuffer buffer;
+		buffer.Allocate(259, 256);
+		for(int y = 0; y < buffer.Height(); ++y)
+			for(int x = 0; x < buffer.Width(); ++x)
+			{
+				uint32_t color = x & 0xFF;
+				buffer.Begin(y)[x] = color | ((255 - color) << 8) | ((color ^ 0x5A) << 16) | (y << 24);
+			}
+		std::vector<uint32_t> original(buffer.Pixels(), buffer.Pixels() + buffer.Width() * buffer.Height());
+
+		for(int additive = 0; additive < 3; ++additive)
+		{
+			WHEN( "it is converted with additive mode " + std::to_string(additive) ) {
+				buffer.Premultiply(0, additive);
+				THEN( "every pixel matches the per-pixel conversion" ) {
+					int mismatches = 0;
+					for(size_t i = 0; i < original.size(); ++i)
+						mismatches += (buffer.Pixels()[i] != ReferencePremultiply(original[i], additive));
+					CHECK( mismatches == 0 );
+				}
+			}
+		}
+	}
+}
+
+SCENARIO( "Shrinking an image to half size", "[ImageBuffer]" ) {
+	GIVEN( "an image with several frames and odd dimensions" ) {
+		ImageBuffer buffer(2);
+		buffer.Allocate(2 * 19 + 1, 2 * 5 + 1);
+		FillRandom(buffer);
+		std::vector<uint32_t> original(buffer.Pixels(),
+			buffer.Pixels() + buffer.Width() * buffer.Height() * buffer.Frames());
+		const int width = buffer.Width();
+
+		WHEN( "it is shrunk" ) {
+			buffer.ShrinkToHalfSize();
+			THEN( "each pixel is the average of a block of four" ) {
+				REQUIRE( buffer.Width() == 19 );
+				REQUIRE( buffer.Height() == 5 );
+				int mismatches = 0;
+				for(int y = 0; y < buffer.Height() * buffer.Frames(); ++y)
+					for(int x = 0; x < buffer.Width(); ++x)
+					{
+						const uint32_t *a = &original[width * (2 * y) + 2 * x];
+						const uint32_t *b = &original[width * (2 * y + 1) + 2 * x];
+						mismatches += (buffer.Pixels()[buffer.Width() * y + x] != ReferenceAverage(a[0], a[1], b[0], b[1]));
+					}
+				CHECK( mismatches == 0 );
+			}
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
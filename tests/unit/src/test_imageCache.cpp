@@ -0,0 +1,243 @@
+/* test_imageCache.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../source/ImageCache.h"
+
+// Include the classes the cache reads from and writes to.
+#include "../../../source/Files.h"
+#include "../../../source/ImageBuffer.h"
+
+// ... and any system includes needed for the test file.
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace { // test namespace
+
+// #region mock data
+
+// The tests use real files in the directory they are run from. The "images" are
+// never decoded, so they only need to exist.
+const std::string FOLDER = "test_imageCache/";
+const std::string IMAGE_A = "test_imageCache_a.png";
+const std::string IMAGE_B = "test_imageCache_b.png";
+const std::string IMAGE_C = "test_imageCache_c.png";
+
+const int WIDTH = 64;
+const int HEIGHT = 6;
+
+void WriteFile(const std::string &path, const std::string &contents)
+{
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	out << contents;
+}
+
+// Make sure no files are left behind by one test to affect the next.
+struct TestFiles {
+	TestFiles() { Remove(); for(const std::string &image : {IMAGE_A, IMAGE_B, IMAGE_C}) WriteFile(image, "image"); }
+	~TestFiles() { Remove(); ImageCache::Init("", false); }
+	void Remove()
+	{
+		for(const std::string &path : Files::List(FOLDER))
+			std::remove(path.c_str());
+		std::remove(FOLDER.substr(0, FOLDER.length() - 1).c_str());
+		for(const std::string &image : {IMAGE_A, IMAGE_B, IMAGE_C})
+			std::remove(image.c_str());
+	}
+};
+
+// Fill a frame with transparent and opaque pixels in every arrangement that
+// the cache stores differently: an empty row, gaps that are too short to start
+// a new run and ones that are long enough, and pixels at both ends of the image.
+void FillFrame(ImageBuffer &buffer, int frame)
+{
+	const int OPAQUE[HEIGHT][2] = {{0, 0}, {0, 64}, {0, 5}, {10, 13}, {20, 40}, {63, 64}};
+	for(int y = 0; y < HEIGHT; ++y)
+	{
+		uint32_t *row = buffer.Begin(y, frame);
+		for(int x = 0; x < WIDTH; ++x)
+		{
+			bool isOpaque = (x >= OPAQUE[y][0] && x < OPAQUE[y][1]) || (y == 4 && x % 7 == 0);
+			row[x] = isOpaque ? 0xFF000000u | static_cast<uint32_t>(y * 1000 + x) : 0;
+		}
+	}
+}
+
+bool SameFrame(const ImageBuffer &a, int frameA, const ImageBuffer &b, int frameB)
+{
+	for(int y = 0; y < HEIGHT; ++y)
+		for(int x = 0; x < WIDTH; ++x)
+			if(a.Begin(y, frameA)[x] != b.Begin(y, frameB)[x])
+				return false;
+	return true;
+}
+
+// Store a frame of an image in the cache, and get the cache file it went to.
+std::string Store(const std::string &image)
+{
+	std::vector<std::string> before = Files::List(FOLDER);
+	ImageBuffer buffer;
+	buffer.Allocate(WIDTH, HEIGHT);
+	FillFrame(buffer, 0);
+	ImageCache::Write(image, buffer, 0);
+	for(const std::string &path : Files::List(FOLDER))
+		if(std::find(before.begin(), before.end(), path) == before.end())
+			return path;
+	return "";
+}
+
+bool CanRead(const std::string &image)
+{
+	ImageBuffer buffer;
+	return ImageCache::Read(image, buffer, 0);
+}
+
+long FileSize(const std::string &path)
+{
+	std::ifstream in(path, std::ios::binary | std::ios::ate);
+	return static_cast<long>(in.tellg());
+}
+
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Storing decoded images in the image cache", "[ImageCache]" ) {
+	TestFiles files;
+	GIVEN( "a cache that is turned on" ) {
+		ImageCache::Init(FOLDER, true);
+		ImageBuffer original(2);
+		original.Allocate(WIDTH, HEIGHT);
+		FillFrame(original, 1);
+
+		WHEN( "a frame is stored and read back" ) {
+			ImageCache::Write(IMAGE_A, original, 1);
+			ImageBuffer copy(2);
+			REQUIRE( ImageCache::Read(IMAGE_A, copy, 1) );
+			THEN( "every pixel is the same" ) {
+				CHECK( copy.Width() == WIDTH );
+				CHECK( copy.Height() == HEIGHT );
+				CHECK( SameFrame(original, 1, copy, 1) );
+			}
+		}
+		WHEN( "a frame that is completely transparent is stored and read back" ) {
+			ImageBuffer empty;
+			empty.Allocate(WIDTH, HEIGHT);
+			for(int y = 0; y < HEIGHT; ++y)
+				std::fill(empty.Begin(y), empty.Begin(y) + WIDTH, 0u);
+			ImageCache::Write(IMAGE_A, empty, 0);
+			ImageBuffer copy;
+			REQUIRE( ImageCache::Read(IMAGE_A, copy, 0) );
+			THEN( "every pixel is the same" ) {
+				CHECK( SameFrame(empty, 0, copy, 0) );
+			}
+		}
+		WHEN( "the image has been changed since it was stored" ) {
+			ImageCache::Write(IMAGE_A, original, 1);
+			Files::SetTimestamp(IMAGE_A, Files::Timestamp(IMAGE_A) - 100);
+			THEN( "it is not read from the cache" ) {
+				CHECK_FALSE( CanRead(IMAGE_A) );
+			}
+		}
+		WHEN( "the cache file is from a different version of the cache" ) {
+			const std::string cachePath = Store(IMAGE_A);
+			REQUIRE( CanRead(IMAGE_A) );
+			{
+				// The version follows the four bytes of the file's magic number.
+				std::fstream file(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+				file.seekp(4);
+				file.put('\x7F');
+			}
+			THEN( "it is not read from the cache" ) {
+				CHECK_FALSE( CanRead(IMAGE_A) );
+			}
+		}
+		WHEN( "an image that was never stored is read" ) {
+			THEN( "it is not found" ) {
+				CHECK_FALSE( CanRead(IMAGE_B) );
+			}
+		}
+	}
+	GIVEN( "a cache that is turned off" ) {
+		ImageCache::Init(FOLDER, false);
+		WHEN( "a frame is stored" ) {
+			THEN( "nothing is written, and it cannot be read back" ) {
+				CHECK( Store(IMAGE_A).empty() );
+				CHECK_FALSE( CanRead(IMAGE_A) );
+			}
+		}
+	}
+}
+
+SCENARIO( "Pruning the image cache", "[ImageCache]" ) {
+	TestFiles files;
+	GIVEN( "a cache with three entries, each used at a different time" ) {
+		ImageCache::Init(FOLDER, true);
+		const std::string cacheA = Store(IMAGE_A);
+		const std::string cacheB = Store(IMAGE_B);
+		const std::string cacheC = Store(IMAGE_C);
+		REQUIRE( FileSize(cacheA) == FileSize(cacheB) );
+		REQUIRE( FileSize(cacheA) == FileSize(cacheC) );
+		const std::time_t now = std::time(nullptr);
+		Files::SetTimestamp(cacheA, now - 300);
+		Files::SetTimestamp(cacheB, now - 200);
+		Files::SetTimestamp(cacheC, now - 100);
+
+		WHEN( "the oldest entry is read, and the cache only has room for two entries" ) {
+			REQUIRE( CanRead(IMAGE_A) );
+			ImageCache::Init(FOLDER, true, 2 * FileSize(cacheA));
+			ImageCache::Prune();
+			THEN( "the least recently used entry is removed" ) {
+				CHECK( CanRead(IMAGE_A) );
+				CHECK_FALSE( CanRead(IMAGE_B) );
+				CHECK( CanRead(IMAGE_C) );
+			}
+		}
+		WHEN( "the cache has room for every entry" ) {
+			ImageCache::Prune();
+			THEN( "they are all kept" ) {
+				CHECK( Files::List(FOLDER).size() == 3 );
+			}
+		}
+		WHEN( "one of the images is removed" ) {
+			std::remove(IMAGE_B.c_str());
+			ImageCache::Prune();
+			THEN( "only its entry is removed" ) {
+				CHECK( Files::List(FOLDER).size() == 2 );
+				CHECK_FALSE( Files::Exists(cacheB) );
+			}
+		}
+		WHEN( "the cache is turned off" ) {
+			ImageCache::Init(FOLDER, false);
+			ImageCache::Prune();
+			THEN( "every entry is removed" ) {
+				CHECK( Files::List(FOLDER).empty() );
+			}
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
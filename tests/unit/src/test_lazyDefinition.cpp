@@ -0,0 +1,110 @@
+/* test_lazyDefinition.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../source/LazyDefinition.h"
+
+// Include a helper for creating well-formed DataNodes.
+#include "datanode-factory.h"
+
+// ... and any system includes needed for the test file.
+#include <string>
+#include <vector>
+
+namespace { // test namespace
+
+// #region mock data
+
+// Record the first token of every node that gets parsed.
+struct Recorder {
+	std::vector<std::string> tokens;
+	void operator()(const DataNode &node) { tokens.push_back(node.Token(0)); }
+};
+
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Deferring the parsing of a definition", "[LazyDefinition]" ) {
+	GIVEN( "an empty definition" ) {
+		LazyDefinition definition;
+		THEN( "nothing is pending" ) {
+			CHECK_FALSE( definition.IsPending() );
+		}
+		THEN( "resolving it does nothing" ) {
+			Recorder recorder;
+			definition.Resolve([&recorder](const DataNode &node) { recorder(node); });
+			CHECK( recorder.tokens.empty() );
+		}
+	}
+	GIVEN( "a definition with several nodes" ) {
+		LazyDefinition definition;
+		definition.Add(AsDataNode("first"));
+		definition.Add(AsDataNode("second"));
+		REQUIRE( definition.IsPending() );
+
+		WHEN( "it is resolved" ) {
+			Recorder recorder;
+			definition.Resolve([&recorder](const DataNode &node) { recorder(node); });
+			THEN( "every node is parsed in order" ) {
+				CHECK( recorder.tokens == std::vector<std::string>{"first", "second"} );
+				CHECK_FALSE( definition.IsPending() );
+			}
+			AND_WHEN( "it is resolved again" ) {
+				definition.Resolve([&recorder](const DataNode &node) { recorder(node); });
+				THEN( "no node is parsed twice" ) {
+					CHECK( recorder.tokens.size() == 2 );
+				}
+			}
+		}
+		WHEN( "it is cleared" ) {
+			definition.Clear();
+			THEN( "nothing is pending" ) {
+				CHECK_FALSE( definition.IsPending() );
+			}
+		}
+		WHEN( "it is copied" ) {
+			LazyDefinition copy = definition;
+			Recorder recorder;
+			definition.Resolve([&recorder](const DataNode &node) { recorder(node); });
+			THEN( "the copy can be resolved separately" ) {
+				REQUIRE( copy.IsPending() );
+				copy.Resolve([&recorder](const DataNode &node) { recorder(node); });
+				CHECK( recorder.tokens.size() == 4 );
+			}
+		}
+		WHEN( "it is cleared while being resolved" ) {
+			Recorder recorder;
+			definition.Resolve([&recorder, &definition](const DataNode &node)
+				{
+					recorder(node);
+					definition.Clear();
+					CHECK( definition.IsPending() );
+				});
+			THEN( "all the nodes are still parsed" ) {
+				CHECK( recorder.tokens.size() == 2 );
+				CHECK_FALSE( definition.IsPending() );
+			}
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
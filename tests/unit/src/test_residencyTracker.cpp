@@ -0,0 +1,145 @@
+/* test_residencyTracker.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../source/ResidencyTracker.h"
+
+// ... and any system includes needed for the test file.
+#include <cstddef>
+#include <vector>
+
+namespace { // test namespace
+
+// #region mock data
+
+const long long MIN_IDLE = 10000;
+const size_t KB = 1024;
+
+// A tracker with the given sprite sizes, all loaded at time zero.
+ResidencyTracker Loaded(const std::vector<size_t> &sizes)
+{
+	ResidencyTracker tracker(MIN_IDLE);
+	for(size_t size : sizes)
+		tracker.Load(tracker.Add(), size, 0);
+	return tracker;
+}
+
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Choosing which sprites to unload", "[ResidencyTracker]" ) {
+	GIVEN( "four sprites that were loaded at the same time" ) {
+		ResidencyTracker tracker = Loaded({100 * KB, 200 * KB, 300 * KB, 400 * KB});
+		REQUIRE( tracker.Memory() == 1000 * KB );
+
+		WHEN( "they are within the budget" ) {
+			THEN( "nothing is unloaded" ) {
+				CHECK( tracker.Evict(1000 * KB, 60000).empty() );
+				CHECK( tracker.Memory() == 1000 * KB );
+			}
+		}
+		WHEN( "there is no budget" ) {
+			THEN( "nothing is unloaded" ) {
+				CHECK( tracker.Evict(0, 60000).empty() );
+				CHECK( tracker.Memory() == 1000 * KB );
+			}
+		}
+		WHEN( "they were used at different times and the budget is exceeded" ) {
+			tracker.Use(0, 40000);
+			tracker.Use(1, 20000);
+			tracker.Use(2, 30000);
+			tracker.Use(3, 10000);
+			std::vector<size_t> evicted = tracker.Evict(450 * KB, 60000);
+			THEN( "the least recently used are unloaded first, until the rest fit" ) {
+				CHECK( evicted == std::vector<size_t>{3, 1} );
+				CHECK( tracker.Memory() == 400 * KB );
+				CHECK_FALSE( tracker.IsLoaded(3) );
+				CHECK_FALSE( tracker.IsLoaded(1) );
+				CHECK( tracker.IsLoaded(0) );
+				CHECK( tracker.IsLoaded(2) );
+			}
+			AND_WHEN( "an unloaded sprite is loaded again" ) {
+				tracker.Load(1, 200 * KB, 61000);
+				THEN( "it is the last to be unloaded" ) {
+					CHECK( tracker.Evict(500 * KB, 80000) == std::vector<size_t>{2} );
+					CHECK( tracker.Memory() == 300 * KB );
+				}
+			}
+		}
+		WHEN( "they were all last used at the same time" ) {
+			THEN( "they are unloaded in the order they were added" ) {
+				CHECK( tracker.Evict(700 * KB, 60000) == std::vector<size_t>{0, 1} );
+			}
+		}
+	}
+	GIVEN( "sprites that were used recently" ) {
+		ResidencyTracker tracker = Loaded({100 * KB, 200 * KB, 300 * KB});
+		tracker.Use(0, 50000);
+		tracker.Use(1, 55000);
+		tracker.Use(2, 52000);
+
+		WHEN( "none has been idle long enough" ) {
+			THEN( "none is unloaded, even though the budget is exceeded" ) {
+				CHECK( tracker.Evict(100 * KB, 50000 + MIN_IDLE - 1).empty() );
+				CHECK( tracker.Memory() == 600 * KB );
+			}
+		}
+		WHEN( "only some have been idle long enough" ) {
+			THEN( "only those are unloaded" ) {
+				CHECK( tracker.Evict(100 * KB, 52000 + MIN_IDLE) == std::vector<size_t>{0, 2} );
+				CHECK( tracker.Memory() == 200 * KB );
+				CHECK( tracker.IsLoaded(1) );
+			}
+		}
+		WHEN( "an earlier time is reported after a later one" ) {
+			tracker.Use(1, 0);
+			THEN( "the later time is kept" ) {
+				CHECK( tracker.Evict(100 * KB, 55000 + MIN_IDLE - 1) == std::vector<size_t>{0, 2} );
+				CHECK( tracker.IsLoaded(1) );
+			}
+		}
+	}
+	GIVEN( "sprites that take up no memory of their own" ) {
+		ResidencyTracker tracker = Loaded({0, 500 * KB, 0});
+
+		WHEN( "the budget is exceeded" ) {
+			THEN( "only sprites that free up memory are unloaded" ) {
+				CHECK( tracker.Evict(100 * KB, 60000) == std::vector<size_t>{1} );
+				CHECK( tracker.IsLoaded(0) );
+				CHECK( tracker.IsLoaded(2) );
+				CHECK( tracker.Memory() == 0 );
+			}
+		}
+	}
+	GIVEN( "a sprite that has not finished loading" ) {
+		ResidencyTracker tracker(MIN_IDLE);
+		size_t index = tracker.Add();
+
+		THEN( "it is not loaded and uses no memory" ) {
+			CHECK_FALSE( tracker.IsLoaded(index) );
+			CHECK( tracker.Memory() == 0 );
+			CHECK( tracker.Evict(1, 60000).empty() );
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
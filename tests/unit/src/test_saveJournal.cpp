@@ -0,0 +1,165 @@
+/* test_saveJournal.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../source/SaveJournal.h"
+
+// ... and any system includes needed for the test file.
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace { // test namespace
+
+// #region mock data
+
+// The journal is kept next to the saved game, so the tests use real files in
+// the directory they are run from.
+const std::string SAVE_PATH = "test_saveJournal.txt";
+
+std::string ReadFile(const std::string &path)
+{
+	std::ifstream in(path, std::ios::binary);
+	std::ostringstream out;
+	out << in.rdbuf();
+	return out.str();
+}
+
+void WriteFile(const std::string &path, const std::string &contents)
+{
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	out << contents;
+}
+
+// Generate a saved game with many lines that stay the same from one save to
+// the next, and a few that change.
+std::string MakeSave(int day, int credits)
+{
+	std::ostringstream out;
+	out << "pilot Test Pilot\n";
+	out << "date " << day << " 1 3014\n";
+	out << "account\n\tcredits " << credits << "\n";
+	for(int i = 0; i < 200; ++i)
+		out << "ship \"Ship number " << i << "\"\n\tattributes\n\t\tmass 100\n";
+	return out.str();
+}
+
+// Make sure no files are left behind by one test to affect the next.
+struct SaveFiles {
+	SaveFiles() { SaveJournal::Delete(SAVE_PATH); }
+	~SaveFiles() { SaveJournal::Delete(SAVE_PATH); }
+};
+
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Recording a saved game as changes to a base", "[SaveJournal]" ) {
+	SaveFiles files;
+	const std::string base = MakeSave(1, 1000);
+	WriteFile(SAVE_PATH, base);
+	SaveJournal journal(SAVE_PATH);
+
+	GIVEN( "a journal with no base" ) {
+		THEN( "nothing can be appended to it" ) {
+			CHECK_FALSE( journal.Append(MakeSave(2, 2000)) );
+			CHECK_FALSE( journal.HasChanges() );
+		}
+	}
+	GIVEN( "a journal that has been restarted with the base" ) {
+		journal.Restart(base);
+		REQUIRE_FALSE( journal.HasChanges() );
+		THEN( "the saved game is just the base" ) {
+			CHECK( SaveJournal::Read(SAVE_PATH) == base );
+		}
+		WHEN( "several saves are appended" ) {
+			REQUIRE( journal.Append(MakeSave(2, 2000)) );
+			REQUIRE( journal.Append(MakeSave(3, 1500)) );
+			const std::string latest = MakeSave(4, 3000);
+			REQUIRE( journal.Append(latest) );
+			THEN( "reading the saved game replays them all" ) {
+				CHECK( journal.HasChanges() );
+				CHECK( journal.Contents() == latest );
+				CHECK( SaveJournal::Read(SAVE_PATH) == latest );
+			}
+			THEN( "the journal is much smaller than the base" ) {
+				CHECK( ReadFile(SaveJournal::JournalPath(SAVE_PATH)).size() * 10 < base.size() );
+			}
+		}
+		WHEN( "a save with lines removed, reordered and repeated is appended" ) {
+			std::string edited = MakeSave(2, 2000);
+			size_t first = edited.find("ship \"Ship number 10\"");
+			edited.erase(first, edited.find("ship \"Ship number 20\"") - first);
+			first = edited.find("ship \"Ship number 150\"");
+			edited += "pilot Test Pilot\n" + edited.substr(first, edited.find("ship \"Ship number 160\"") - first);
+			REQUIRE( journal.Append(edited) );
+			THEN( "reading the saved game gives exactly that save" ) {
+				CHECK( SaveJournal::Read(SAVE_PATH) == edited );
+			}
+		}
+		WHEN( "a save that differs too much from the base is appended" ) {
+			THEN( "the journal refuses it, so that a new base is written instead" ) {
+				CHECK_FALSE( journal.Append(std::string(base.size(), 'x')) );
+				CHECK( SaveJournal::Read(SAVE_PATH) == base );
+			}
+		}
+	}
+}
+
+SCENARIO( "Reading a journal that does not match its saved game", "[SaveJournal]" ) {
+	SaveFiles files;
+	const std::string base = MakeSave(1, 1000);
+	const std::string first = MakeSave(2, 2000);
+	WriteFile(SAVE_PATH, base);
+	SaveJournal journal(SAVE_PATH);
+	journal.Restart(base);
+	REQUIRE( journal.Append(first) );
+	const std::string journalPath = SaveJournal::JournalPath(SAVE_PATH);
+
+	GIVEN( "a base that was replaced without restarting the journal" ) {
+		const std::string newBase = MakeSave(5, 5000);
+		WriteFile(SAVE_PATH, newBase);
+		THEN( "the journal for the old base is ignored" ) {
+			CHECK( SaveJournal::Read(SAVE_PATH) == newBase );
+		}
+	}
+	GIVEN( "a final entry that was only partly written" ) {
+		REQUIRE( journal.Append(MakeSave(3, 3000)) );
+		const std::string complete = ReadFile(journalPath);
+		THEN( "only the entries before it are applied" ) {
+			for(size_t cut : {1, 2, 20})
+			{
+				WriteFile(journalPath, complete.substr(0, complete.size() - cut));
+				CHECK( SaveJournal::Read(SAVE_PATH) == first );
+			}
+		}
+	}
+	GIVEN( "a journal whose only entry was cut off" ) {
+		const std::string complete = ReadFile(journalPath);
+		WriteFile(journalPath, complete.substr(0, complete.size() / 2));
+		THEN( "the base is read unchanged" ) {
+			CHECK( SaveJournal::Read(SAVE_PATH) == base );
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
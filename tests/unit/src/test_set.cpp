@@ -20,6 +20,7 @@ this program. If not, see <https://www.gnu.org/licenses/>.
 
 // ... and any system includes needed for the test file.
 #include <string>
+#include <utility>
 
 namespace { // test namespace
 // #region mock data
@@ -27,6 +28,20 @@ class T {
 public:
 	int a = 1;
 };
+
+// Stand-ins for a planet and the wormhole that is generated from it when it is
+// placed in more than one system.
+class Gate;
+class Place {
+public:
+	int systems = 1;
+	Gate *gate = nullptr;
+};
+class Gate {
+public:
+	const Place *place = nullptr;
+	int links = 0;
+};
 // #endregion mock data
 
 
@@ -118,6 +133,48 @@ SCENARIO( "a Set can be interacted with by consuming classes even when const", "
 }
 
 
+SCENARIO( "A Set keeps its contents sorted and separate from its copies", "[Set]" ) {
+	GIVEN( "a Set<T> whose keys were added out of order" ) {
+		auto original = Set<T>{};
+		original.Get("C")->a = 3;
+		original.Get("A")->a = 1;
+		original.Get("B")->a = 2;
+
+		THEN( "iterating it visits the keys in sorted order" ) {
+			std::string keys;
+			for(const auto &it : original)
+				keys += it.first;
+			CHECK( keys == "ABC" );
+		}
+
+		WHEN( "it is copied" ) {
+			auto copy = original;
+			THEN( "lookups in the copy return the copy's own data" ) {
+				REQUIRE( copy.Find("B") );
+				CHECK( copy.Find("B") != original.Find("B") );
+				CHECK( copy.Find("B") == &copy.find("B")->second );
+				CHECK( copy.Find("B")->a == 2 );
+			}
+			THEN( "adding to the copy does not modify the original" ) {
+				copy.Get("D")->a = 4;
+				CHECK( copy.Has("D") );
+				CHECK_FALSE( original.Has("D") );
+				CHECK( original.size() == 3 );
+			}
+		}
+
+		WHEN( "it is moved" ) {
+			const T *before = original.Find("A");
+			auto moved = std::move(original);
+			THEN( "lookups still return the same objects" ) {
+				CHECK( moved.Find("A") == before );
+				CHECK( moved.Get("A") == before );
+			}
+		}
+	}
+}
+
+
 SCENARIO( "A Set can be reverted to an earlier state", "[Set]" ) {
 	auto init = [](Set<T> &container, int val) {
 		container.Get("A")->a = val;
@@ -169,6 +226,132 @@ SCENARIO( "A Set can be reverted to an earlier state", "[Set]" ) {
 		}
 	}
 }
+
+SCENARIO( "A Set can restore a snapshot of its contents", "[Set]" ) {
+	GIVEN( "a Set<T> with a snapshot of its data" ) {
+		auto s = Set<T>{};
+		s.Get("A")->a = 1;
+		s.Get("B")->a = 2;
+		s.Snapshot();
+		const T *a = s.Find("A");
+		REQUIRE_FALSE( s.IsModified() );
+
+		WHEN( "objects are only looked up" ) {
+			s.Get("A");
+			s.Find("B");
+			THEN( "the Set is not modified" ) {
+				CHECK_FALSE( s.IsModified() );
+			}
+		}
+
+		WHEN( "an object is modified" ) {
+			s.Modify("A")->a = 5;
+			THEN( "the change is visible in place" ) {
+				CHECK( s.IsModified() );
+				CHECK( s.Find("A") == a );
+				CHECK( a->a == 5 );
+			}
+			AND_WHEN( "it is modified again and the snapshot is restored" ) {
+				s.Modify("A")->a = 6;
+				s.RestoreSnapshot();
+				THEN( "the object has its original contents at the same address" ) {
+					CHECK( s.Find("A") == a );
+					CHECK( a->a == 1 );
+					CHECK_FALSE( s.IsModified() );
+				}
+			}
+		}
+
+		WHEN( "a new object is only looked up" ) {
+			const T *d = s.Get("D");
+			THEN( "the Set is not modified, and restoring it keeps the object" ) {
+				CHECK_FALSE( s.IsModified() );
+				s.RestoreSnapshot();
+				CHECK( s.Find("D") == d );
+			}
+		}
+
+		WHEN( "an object is added and the snapshot is restored" ) {
+			const T *c = s.Modify("C");
+			s.Modify("C")->a = 3;
+			REQUIRE( s.IsModified() );
+			s.RestoreSnapshot();
+			THEN( "it is kept at the same address, with its contents reset" ) {
+				CHECK( s.Find("C") == c );
+				CHECK( c->a == T{}.a );
+				CHECK( s.Find("B")->a == 2 );
+				CHECK_FALSE( s.IsModified() );
+			}
+			AND_WHEN( "it is added again and the snapshot is restored again" ) {
+				s.Modify("C")->a = 4;
+				s.RestoreSnapshot();
+				THEN( "it is reset again" ) {
+					CHECK( s.Find("C") == c );
+					CHECK( c->a == T{}.a );
+				}
+			}
+		}
+
+		WHEN( "an added object is looked up through a const Set" ) {
+			s.Modify("C")->a = 3;
+			const Set<T> &constSet = s;
+			const T *c = constSet.Find("C");
+			constSet.Get("C");
+			THEN( "only the change made by Modify() is undone" ) {
+				CHECK( c->a == 3 );
+				s.RestoreSnapshot();
+				CHECK( constSet.Find("C") == c );
+				CHECK( c->a == T{}.a );
+				CHECK_FALSE( s.IsModified() );
+			}
+		}
+	}
+}
+
+SCENARIO( "Restoring Sets after an event turned a planet into a wormhole", "[Set]" ) {
+	GIVEN( "a planet that is in one system, with a snapshot taken" ) {
+		const std::string name = "Gate Planet";
+		auto planets = Set<Place>{};
+		auto wormholes = Set<Gate>{};
+		const Place *planet = planets.Get(name);
+		planets.Snapshot();
+		wormholes.Snapshot();
+
+		WHEN( "an event adds it to a second system, which generates a wormhole" ) {
+			planets.Modify(name)->systems = 2;
+			// This is what updating the systems does for a planet in more than one system.
+			Place *changed = planets.Modify(name);
+			changed->gate = wormholes.Modify(name);
+			changed->gate->place = changed;
+			changed->gate->links = 2;
+			// Something else, like a mission, may hold on to the wormhole.
+			const Set<Gate> &constWormholes = wormholes;
+			const Gate *wormhole = constWormholes.Find(name);
+			REQUIRE( planet->gate == wormhole );
+			REQUIRE( planets.IsModified() );
+			REQUIRE( wormholes.IsModified() );
+
+			AND_WHEN( "the snapshots are restored" ) {
+				planets.RestoreSnapshot();
+				wormholes.RestoreSnapshot();
+				THEN( "the planet is no longer a wormhole" ) {
+					CHECK( planets.Find(name) == planet );
+					CHECK( planet->systems == 1 );
+					CHECK( planet->gate == nullptr );
+				}
+				THEN( "the wormhole is kept where it was, but reset" ) {
+					CHECK( constWormholes.Find(name) == wormhole );
+					CHECK( wormhole->place == nullptr );
+					CHECK( wormhole->links == 0 );
+				}
+				THEN( "neither Set is modified any more" ) {
+					CHECK_FALSE( planets.IsModified() );
+					CHECK_FALSE( wormholes.IsModified() );
+				}
+			}
+		}
+	}
+}
 // #endregion unit tests
 
 
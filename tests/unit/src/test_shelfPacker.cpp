@@ -0,0 +1,123 @@
+/* test_shelfPacker.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../source/ShelfPacker.h"
+
+// ... and any system includes needed for the test file.
+#include <vector>
+
+namespace { // test namespace
+
+// #region mock data
+
+const int SIZE = 256;
+const int LAYERS = 2;
+
+// A rectangle that has been placed by the packer.
+struct Placed {
+	ShelfPacker::Slot slot;
+	int width;
+	int height;
+};
+
+bool Overlap(const Placed &a, const Placed &b)
+{
+	return a.slot.layer == b.slot.layer
+		&& a.slot.x < b.slot.x + b.width && b.slot.x < a.slot.x + a.width
+		&& a.slot.y < b.slot.y + b.height && b.slot.y < a.slot.y + a.height;
+}
+
+// Place the given number of rectangles of the given size, and remember where
+// they went if they fit.
+bool Place(ShelfPacker &packer, int width, int height, int count, std::vector<Placed> &placed)
+{
+	std::vector<ShelfPacker::Slot> slots(count);
+	if(!packer.Place(width, height, slots))
+		return false;
+	for(const ShelfPacker::Slot &slot : slots)
+		placed.push_back({slot, width, height});
+	return true;
+}
+
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Packing sprite frames into the layers of a texture", "[ShelfPacker]" ) {
+	GIVEN( "an empty packer" ) {
+		ShelfPacker packer(SIZE, LAYERS);
+		std::vector<Placed> placed;
+
+		WHEN( "frames of many different sizes are packed until it is full" ) {
+			const int SIZES[][2] = {{30, 20}, {12, 12}, {60, 40}, {7, 31}, {100, 9}, {45, 45}, {3, 80}};
+			int rejected = 0;
+			for(int i = 0; rejected < 20; ++i)
+			{
+				const int *size = SIZES[i % 7];
+				if(!Place(packer, size[0], size[1], 1 + i % 5, placed))
+					++rejected;
+			}
+			REQUIRE( placed.size() > 20 );
+
+			THEN( "every frame is inside a layer" ) {
+				for(const Placed &it : placed)
+				{
+					CHECK( it.slot.layer >= 0 );
+					CHECK( it.slot.layer < LAYERS );
+					CHECK( it.slot.x >= 0 );
+					CHECK( it.slot.y >= 0 );
+					CHECK( it.slot.x + it.width <= SIZE );
+					CHECK( it.slot.y + it.height <= SIZE );
+				}
+			}
+			THEN( "no two frames overlap" ) {
+				for(size_t i = 0; i < placed.size(); ++i)
+					for(size_t j = i + 1; j < placed.size(); ++j)
+						CHECK_FALSE( Overlap(placed[i], placed[j]) );
+			}
+		}
+		WHEN( "a frame larger than a layer is packed" ) {
+			THEN( "it is rejected" ) {
+				CHECK_FALSE( Place(packer, SIZE + 1, 10, 1, placed) );
+				CHECK_FALSE( Place(packer, 10, SIZE + 1, 1, placed) );
+				CHECK( placed.empty() );
+			}
+		}
+		WHEN( "more frames are packed than can fit" ) {
+			// Each layer has room for exactly four of these.
+			REQUIRE_FALSE( Place(packer, SIZE / 2, SIZE / 2, 4 * LAYERS + 1, placed) );
+			THEN( "none of them are placed" ) {
+				CHECK( placed.empty() );
+				CHECK( Place(packer, SIZE / 2, SIZE / 2, 4 * LAYERS, placed) );
+			}
+		}
+		WHEN( "a layer is filled exactly" ) {
+			REQUIRE( Place(packer, SIZE / 2, SIZE / 2, 4 * LAYERS, placed) );
+			THEN( "a frame that does not fit in the space left is rejected" ) {
+				CHECK_FALSE( Place(packer, 1, 1, 1, placed) );
+				CHECK( placed.size() == 4 * LAYERS );
+			}
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
@@ -0,0 +1,107 @@
+/* test_systemGrid.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../source/SystemGrid.h"
+
+// ... and any system includes needed for the test file.
+#include <algorithm>
+#include <vector>
+
+namespace { // test namespace
+
+// #region mock data
+
+// The grid never dereferences the systems it stores, so any distinct
+// addresses can stand in for them.
+int storage[3];
+const System *const nearby = reinterpret_cast<const System *>(&storage[0]);
+const System *const faraway = reinterpret_cast<const System *>(&storage[1]);
+const System *const distant = reinterpret_cast<const System *>(&storage[2]);
+
+// Check if the given list of systems contains the given system.
+bool Contains(const std::vector<const System *> &systems, const System *system)
+{
+	return std::find(systems.begin(), systems.end(), system) != systems.end();
+}
+
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Finding the systems near a point", "[SystemGrid]" ) {
+	SystemGrid grid(100.);
+
+	GIVEN( "an empty grid" ) {
+		THEN( "no systems are found" ) {
+			CHECK( grid.size() == 0 );
+			CHECK( grid.Find(Point(), 1000.).empty() );
+		}
+	}
+	GIVEN( "a grid with systems in several cells" ) {
+		grid.Add(nearby, Point(10., 10.));
+		grid.Add(faraway, Point(-150., 60.));
+		grid.Add(distant, Point(5000., -5000.));
+		REQUIRE( grid.size() == 3 );
+
+		THEN( "only systems within the given distance are found" ) {
+			auto found = grid.Find(Point(), 200.);
+			CHECK( found.size() == 2 );
+			CHECK( Contains(found, nearby) );
+			CHECK( Contains(found, faraway) );
+			CHECK_FALSE( Contains(found, distant) );
+		}
+		THEN( "systems exactly at the given distance are included" ) {
+			auto found = grid.Find(Point(10., 0.), 10.);
+			CHECK( found.size() == 1 );
+			CHECK( Contains(found, nearby) );
+		}
+		THEN( "a search larger than the grid finds every system" ) {
+			CHECK( grid.Find(Point(), 1e9).size() == 3 );
+		}
+
+		WHEN( "a system is moved into another cell" ) {
+			grid.Add(distant, Point(-20., -20.));
+			THEN( "it is found at its new position" ) {
+				CHECK( grid.size() == 3 );
+				CHECK( Contains(grid.Find(Point(), 50.), distant) );
+				CHECK( grid.Find(Point(5000., -5000.), 50.).empty() );
+			}
+		}
+		WHEN( "a system is moved within its cell" ) {
+			grid.Add(nearby, Point(90., 90.));
+			THEN( "its new position is used" ) {
+				CHECK_FALSE( Contains(grid.Find(Point(), 20.), nearby) );
+				CHECK( Contains(grid.Find(Point(90., 90.), 1.), nearby) );
+			}
+		}
+		WHEN( "a system is removed" ) {
+			grid.Remove(faraway);
+			grid.Remove(faraway);
+			THEN( "it is no longer found" ) {
+				CHECK( grid.size() == 2 );
+				CHECK_FALSE( Contains(grid.Find(Point(), 1e9), faraway) );
+			}
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
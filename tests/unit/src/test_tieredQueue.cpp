@@ -0,0 +1,120 @@
+/* test_tieredQueue.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../source/TieredQueue.h"
+
+// ... and any system includes needed for the test file.
+#include <string>
+#include <vector>
+
+namespace { // test namespace
+
+// #region mock data
+
+// The same tiers that the sprite queue uses.
+const int DEFERRED = 0;
+const int IMMEDIATE = 2;
+
+using Queue = TieredQueue<std::string, 3>;
+
+// Take everything out of the queue, in order.
+std::vector<std::string> Drain(Queue &queue, std::vector<int> *tiers = nullptr)
+{
+	std::vector<std::string> items;
+	while(!queue.Empty())
+	{
+		int tier = -1;
+		items.push_back(queue.Pop(tier));
+		if(tiers)
+			tiers->push_back(tier);
+	}
+	return items;
+}
+
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Taking items from a tiered queue", "[TieredQueue]" ) {
+	GIVEN( "an empty queue" ) {
+		Queue queue;
+		REQUIRE( queue.Empty() );
+
+		WHEN( "items are added to a single tier" ) {
+			queue.Push("a", 1);
+			queue.Push("b", 1);
+			queue.Push("c", 1);
+			THEN( "they come out in the order they were added" ) {
+				CHECK( Drain(queue) == std::vector<std::string>{"a", "b", "c"} );
+			}
+		}
+		WHEN( "items are added to different tiers" ) {
+			queue.Push("deferred", DEFERRED);
+			queue.Push("background", 1);
+			queue.Push("immediate", IMMEDIATE);
+			queue.Push("later deferred", DEFERRED);
+			THEN( "higher tiers come out first, and the tier of each item is reported" ) {
+				std::vector<int> tiers;
+				CHECK( Drain(queue, &tiers) == std::vector<std::string>{
+					"immediate", "background", "deferred", "later deferred"} );
+				CHECK( tiers == std::vector<int>{IMMEDIATE, 1, DEFERRED, DEFERRED} );
+			}
+		}
+	}
+}
+
+SCENARIO( "Promoting items in a tiered queue", "[TieredQueue]" ) {
+	GIVEN( "a queue with items waiting in each tier" ) {
+		Queue queue;
+		queue.Push("d1", DEFERRED);
+		queue.Push("d2", DEFERRED);
+		queue.Push("b1", 1);
+		queue.Push("i1", IMMEDIATE);
+
+		WHEN( "a deferred item is promoted to the highest tier" ) {
+			CHECK( queue.Promote("d2", IMMEDIATE) == DEFERRED );
+			THEN( "it comes out after the items that were already in that tier" ) {
+				CHECK( Drain(queue) == std::vector<std::string>{"i1", "d2", "b1", "d1"} );
+			}
+		}
+		WHEN( "an item is promoted to the tier it is already in" ) {
+			CHECK( queue.Promote("b1", 1) == -1 );
+			THEN( "nothing changes" ) {
+				CHECK( Drain(queue) == std::vector<std::string>{"i1", "b1", "d1", "d2"} );
+			}
+		}
+		WHEN( "an item is \"promoted\" to a lower tier than it is in" ) {
+			CHECK( queue.Promote("i1", DEFERRED) == -1 );
+			THEN( "nothing changes" ) {
+				CHECK( Drain(queue) == std::vector<std::string>{"i1", "b1", "d1", "d2"} );
+			}
+		}
+		WHEN( "an item that is not waiting is promoted" ) {
+			CHECK( queue.Promote("missing", IMMEDIATE) == -1 );
+			THEN( "nothing changes" ) {
+				CHECK( Drain(queue) == std::vector<std::string>{"i1", "b1", "d1", "d2"} );
+			}
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace
@@ -0,0 +1,67 @@
+/* test_textTemplate.cpp
+Copyright (c) 2026 by Endless Sky contributors
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "es-test.hpp"
+
+// Include only the tested class's header.
+#include "../../../../source/text/TextTemplate.h"
+
+// ... and any system includes needed for the test file.
+#include <map>
+#include <string>
+#include <vector>
+
+namespace { // test namespace
+
+// #region mock data
+// #endregion mock data
+
+
+
+// #region unit tests
+SCENARIO( "Filling in the keys of a text template", "[TextTemplate]" ) {
+	GIVEN( "text with repeated and unknown keys" ) {
+		TextTemplate text("Bring <cargo> to <planet>. <planet> needs <cargo> <soon.");
+		THEN( "each distinct key is listed once, in order" ) {
+			CHECK( text.Keys() == std::vector<std::string>{"<cargo>", "<planet>"} );
+		}
+		WHEN( "the keys are replaced from a map" ) {
+			std::map<std::string, std::string> subs = {{"<planet>", "Earth"}, {"<soon>", "now"}};
+			THEN( "only keys in the map are replaced" ) {
+				CHECK( text.Replace(subs) == "Bring <cargo> to Earth. Earth needs <cargo> <soon." );
+			}
+		}
+	}
+	GIVEN( "text where a key is nested inside unmatched brackets" ) {
+		TextTemplate text("a <b <c>> d");
+		THEN( "only the innermost brackets form a key" ) {
+			CHECK( text.Keys() == std::vector<std::string>{"<c>"} );
+			CHECK( text.Replace({{"<c>", "x"}}) == "a <b x> d" );
+		}
+	}
+	GIVEN( "text with no keys" ) {
+		TextTemplate text("Nothing to see here.");
+		THEN( "it is returned unchanged" ) {
+			CHECK( text.Keys().empty() );
+			CHECK( text.Replace({{"<key>", "value"}}) == text.Text() );
+		}
+	}
+}
+// #endregion unit tests
+
+
+
+} // test namespace